@@ -1,5 +1,7 @@
 #include "rel_common.h"
 #include "model_inference.h"
+#include "mem_arena.h"
+#include "mem_placement.h"
 #include "freertos/event_groups.h"
 
 #include "esp_system.h"
@@ -9,13 +11,90 @@
 
 #include "audio_processing.h"
 #include "sd_card.h"
-// #include "nimble_handler.h"
+#include "data_paths.h"
+#include "record_store.h"
+#include "request_scheduler.h"
+#include "continuous_mode.h"
+#include "stage_executor.h"
+#include "nimble_handler.h"
+#include "boot_init.h"
 #include "uart_handler.h"
+#include "power_mgmt.h"
 
 static const char* TAG = "MAIN";
 
 void loop(void);
 
+#define BOOT_TIMEOUT_MS 10000
+#define BLE_READY_TIMEOUT_MS 3000
+#define POWER_REPORT_INTERVAL_MS (10 * 60 * 1000)
+
+enum {
+    STEP_ARENAS,
+    STEP_SD,
+    STEP_STORE,
+    STEP_MODELS,
+    STEP_AUDIO,
+    STEP_MODEL_INIT,
+    STEP_SCHEDULER,
+    STEP_CONTINUOUS,
+    STEP_SPECULATION,
+    STEP_BLE,
+    STEP_UART,
+    STEP_COUNT
+};
+
+static esp_err_t open_store() {
+#if RECORD_STORE_ENABLED
+    // 녹음/결과 저장소 열기 (실패해도 분류는 계속)
+    char store_path[DATA_PATH_MAX];
+    return record_store_open(data_path(store_path, sizeof(store_path), STORE_DIR_NAME));
+#else
+    return ESP_OK;
+#endif
+}
+
+static esp_err_t start_scheduler() {
+    // 녹음 / 특징 추출 / 추론 파이프라인 태스크 (실패해도 단일 요청 경로는 동작)
+    return init_scheduler(DEFAULT_SCHED_POLICY);
+}
+
+static esp_err_t start_ble() {
+#if BLE_ENABLED
+    if (!init_nimble()) {
+        return ESP_FAIL;
+    }
+    return nimble_wait_ready(BLE_READY_TIMEOUT_MS) ? ESP_OK : ESP_ERR_TIMEOUT;
+#else
+    return ESP_OK;
+#endif
+}
+
+static esp_err_t start_uart() {
+    init_uart();
+    return ESP_OK;
+}
+
+// 명령을 받는 단계(BLE, UART)는 필수 단계가 모두 성공한 뒤에만 시작 (하나라도 실패하면 시작하지 않는다)
+// 선택 단계인 모델 preload / 저장소 / 스케줄러 등과는 겹친다, BLE 는 역시 필수인 UART 뒤에
+#define PIPELINE_DEPS (BOOT_STEP_BIT(STEP_ARENAS) | BOOT_STEP_BIT(STEP_AUDIO) | BOOT_STEP_BIT(STEP_MODEL_INIT))
+#define REQUIRED_DEPS (PIPELINE_DEPS | BOOT_STEP_BIT(STEP_SD))
+#define COMMAND_DEPS (REQUIRED_DEPS | BOOT_STEP_BIT(STEP_UART))
+
+static const boot_step_t boot_steps[STEP_COUNT] = {
+    {"arenas", init_request_arenas, 0, true, 0},
+    {"sd", init_sd_card, 0, true, 0},
+    {"store", open_store, BOOT_STEP_BIT(STEP_SD) | BOOT_STEP_BIT(STEP_ARENAS), false, 0},
+    {"models", preload_models, BOOT_STEP_BIT(STEP_SD), false, 0},
+    {"audio", init_audio_processing, 0, true, 0},
+    {"model_init", init_model_inference, 0, true, 0},
+    {"scheduler", start_scheduler, PIPELINE_DEPS, false, 0},
+    {"continuous", init_continuous, PIPELINE_DEPS, false, 0},
+    {"speculation", init_stage_executor, 0, false, 0},
+    {"ble", start_ble, COMMAND_DEPS, false, 6144},
+    {"uart", start_uart, REQUIRED_DEPS, true, 0},
+};
+
 extern "C" void app_main(void)
 {
     esp_err_t ret;
@@ -36,51 +115,46 @@ extern "C" void app_main(void)
     };
     ESP_ERROR_CHECK(esp_task_wdt_reconfigure(&wdt_config));
 
-    // SD 카드 초기화
-    ret = init_sd_card();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to initialize SD card");
-        return;
+    // 부팅은 최대 클럭으로, 이후 유휴 시간에는 클럭을 낮추고 light sleep
+    if (init_power_mgmt() != ESP_OK) {
+        ESP_LOGW(TAG, "running without power management");
     }
+    power_busy_begin();
 
-    // Audio processing 초기화
-    ret = init_audio_processing();
+    // 서로 의존하지 않는 초기화는 동시에 진행 (SD/모델 preload, ADC/DSP 테이블, BLE)
+    ret = boot_run(boot_steps, STEP_COUNT, BOOT_TIMEOUT_MS);
+    power_busy_end();
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to initialize audio processing");
+        ESP_LOGE(TAG, "Boot failed");
         return;
     }
-
-    // Model 추론 초기화
-    ret = init_model_inference();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to initialize model inference");
-        return;
+    mem_place_report();
+#if FEATURE_PLACEMENT_BENCH
+    placement_bench_t bench;
+    if (benchmark_frame_placement(200, &bench) == ESP_OK) {
+        ESP_LOGI(TAG, "logmel frame: before %lld ns, cold %lld ns, after %lld ns", (long long)bench.before_ns,
+                 (long long)bench.cold_ns, (long long)bench.after_ns);
     }
-
-    // ble 초기화
-    // while (!init_nimble()) {
-    //     ESP_LOGE(TAG, "Failed to initialize nimble");
-    //     vTaskDelay(pdMS_TO_TICKS(10));
-    // };
-
-    init_uart();
+#endif
 
     ESP_LOGI(TAG, "System ready. please bluetooth connection");
 
     loop();
 
+    record_store_close();
     cleanup_sd_card();
     cleanup_audio_processing();
     cleanup_model_inference();
+    cleanup_request_arenas();
 
     ESP_LOGI(TAG, "Application ended");
 }
 
 void loop() {
     while (1) {
-        // nimble_port_run();
-        uart_read();
-
-        vTaskDelay(pdMS_TO_TICKS(10));
+        // BLE 는 nimble 호스트 태스크, UART 명령은 uart_event 태스크가 처리
+        // 주기적으로 깨어나면 tickless idle 의 light sleep 이 끊기므로 전력 통계 로그 때만 깬다
+        vTaskDelay(pdMS_TO_TICKS(POWER_REPORT_INTERVAL_MS));
+        power_report();
     }
 }
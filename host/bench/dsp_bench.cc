@@ -0,0 +1,326 @@
+#include "audio_config.h"
+#include "feature_extraction.h"
+#include "mem_arena.h"
+#include "processing_utils.h"
+#include "adpcm.h"
+#include "wav_io.h"
+#include "resampler.h"
+#include "delta_features.h"
+#include "esp_heap_caps.h"
+
+#include <benchmark/benchmark.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+// 6초 녹음 한 개 분량의 합성 신호 (톤 + 의사 난수 잡음)
+static std::vector<int16_t> make_recording() {
+    std::vector<int16_t> samples(MAX_AUDIO_SIZE);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < samples.size(); i++) {
+        seed = seed * 1664525u + 1013904223u;
+        float noise = ((int32_t)(seed >> 16) - 32768) / 32768.0f;
+        float tone = sinf(2.0f * (float)M_PI * 440.0f * i / SAMPLE_RATE) +
+                     0.5f * sinf(2.0f * (float)M_PI * 1800.0f * i / SAMPLE_RATE);
+        samples[i] = (int16_t)(8000.0f * tone + 2000.0f * noise);
+    }
+    return samples;
+}
+
+static const std::vector<int16_t>& recording() {
+    static const std::vector<int16_t> samples = make_recording();
+    return samples;
+}
+
+static int64_t frames_per_recording() {
+    int64_t frames = 0;
+    for (size_t i = 0; i + FRAME_LENGTH < (size_t)MAX_AUDIO_SIZE; i += FRAME_STEP) {
+        frames++;
+    }
+    return frames;
+}
+
+static void set_frame_counters(benchmark::State& state, int64_t frames_per_iteration) {
+    double frames = (double)frames_per_iteration * state.iterations();
+    state.counters["frames/s"] = benchmark::Counter(frames, benchmark::Counter::kIsRate);
+    state.counters["ns/frame"] = benchmark::Counter(frames * 1e-9,
+        benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+static void load_frame(float* real, float* imag) {
+    const int16_t* samples = recording().data();
+    for (int j = 0; j < FRAME_LENGTH; j++) {
+        real[j] = samples[j] / 32768.0f;
+        imag[j] = 0.0f;
+    }
+}
+
+static void BM_Preemphasis(benchmark::State& state) {
+    float in[FRAME_LENGTH], out[FRAME_LENGTH], imag[FRAME_LENGTH];
+    load_frame(in, imag);
+    for (auto _ : state) {
+        dsps_preemphasis(in, out, FRAME_LENGTH, 0.97f);
+        benchmark::DoNotOptimize(out);
+        benchmark::ClobberMemory();
+    }
+    set_frame_counters(state, 1);
+}
+BENCHMARK(BM_Preemphasis);
+
+static void BM_Fft(benchmark::State& state) {
+    float real[FFT_SIZE], imag[FFT_SIZE], src_real[FFT_SIZE], src_imag[FFT_SIZE];
+    load_frame(src_real, src_imag);
+    for (auto _ : state) {
+        memcpy(real, src_real, sizeof(real));
+        memcpy(imag, src_imag, sizeof(imag));
+        fft(real, imag, FFT_SIZE);
+        benchmark::DoNotOptimize(real);
+        benchmark::DoNotOptimize(imag);
+    }
+    set_frame_counters(state, 1);
+}
+BENCHMARK(BM_Fft);
+
+static void BM_MelFilterbank(benchmark::State& state) {
+    std::vector<float> fbank(NUM_MEL_FILTERS * (FFT_SIZE / 2 + 1), 0.0f);
+    create_mel_filterbank(fbank.data(), NUM_MEL_FILTERS, FFT_SIZE, SAMPLE_RATE);
+    float spectrum[FFT_SIZE / 2 + 1];
+    for (int j = 0; j < FFT_SIZE / 2 + 1; j++) {
+        spectrum[j] = 1.0f + (j % 7);
+    }
+    float mel_energies[NUM_MEL_FILTERS];
+    for (auto _ : state) {
+        apply_mel_filterbank(spectrum, mel_energies, fbank.data(), NUM_MEL_FILTERS, FFT_SIZE);
+        benchmark::DoNotOptimize(mel_energies);
+        benchmark::ClobberMemory();
+    }
+    set_frame_counters(state, 1);
+}
+BENCHMARK(BM_MelFilterbank);
+
+static void BM_Log(benchmark::State& state) {
+    float src[NUM_MEL_FILTERS], mel_energies[NUM_MEL_FILTERS];
+    for (int j = 0; j < NUM_MEL_FILTERS; j++) {
+        src[j] = 0.5f + j;
+    }
+    for (auto _ : state) {
+        memcpy(mel_energies, src, sizeof(mel_energies));
+        dsps_log(mel_energies, NUM_MEL_FILTERS);
+        benchmark::DoNotOptimize(mel_energies);
+        benchmark::ClobberMemory();
+    }
+    set_frame_counters(state, 1);
+}
+BENCHMARK(BM_Log);
+
+static void BM_Diff(benchmark::State& state) {
+    const int size = state.range(0);
+    std::vector<float> in(size), out(size, 0.0f);
+    for (int j = 0; j < size; j++) {
+        in[j] = sinf(j * 0.1f);
+    }
+    for (auto _ : state) {
+        dsps_diff(in.data(), out.data(), size, 1);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    set_frame_counters(state, 1);
+}
+BENCHMARK(BM_Diff)->Arg(40)->Arg(80);
+
+static void BM_MfccFrame(benchmark::State& state) {
+    const int n_mfcc = state.range(0);
+    float frame_real[FRAME_LENGTH], frame_imag[FRAME_LENGTH], mel_energies[2 * 80];
+    for (auto _ : state) {
+        mfcc_frame(recording().data(), frame_real, frame_imag, mel_energies, n_mfcc);
+        benchmark::DoNotOptimize(mel_energies);
+        benchmark::ClobberMemory();
+    }
+    set_frame_counters(state, 1);
+}
+BENCHMARK(BM_MfccFrame)->Arg(40)->Arg(80);
+
+// logmel 프레임의 배치 전후 (호스트는 메모리 티어가 하나라 커널 차이만 보인다)
+static void BM_FramePlacement(benchmark::State& state) {
+    const int frames = 256;
+    placement_bench_t total = {};
+    for (auto _ : state) {
+        placement_bench_t bench;
+        benchmark_frame_placement(frames, &bench);
+        total.before_ns += bench.before_ns;
+        total.cold_ns += bench.cold_ns;
+        total.after_ns += bench.after_ns;
+    }
+    double n = (double)state.iterations();
+    state.counters["before_ns"] = total.before_ns / n;
+    state.counters["cold_ns"] = total.cold_ns / n;
+    state.counters["after_ns"] = total.after_ns / n;
+}
+BENCHMARK(BM_FramePlacement)->Unit(benchmark::kMillisecond);
+
+// 녹음 한 개 전체 (메모리상 PCM)
+static void BM_ExtractMfcc(benchmark::State& state) {
+    const int n_mfcc = state.range(0);
+    std::vector<float> mfcc(n_mfcc);
+    for (auto _ : state) {
+        extract_mfcc(recording().data(), recording().size(), {mfcc.data(), 1}, n_mfcc);
+        benchmark::DoNotOptimize(mfcc.data());
+    }
+    set_frame_counters(state, frames_per_recording());
+}
+BENCHMARK(BM_ExtractMfcc)->Arg(40)->Arg(80)->Unit(benchmark::kMillisecond);
+
+// 한 번 훑어 로그 멜 평균 + 시간축 delta 통계, 이후 40 / 80 계수 블록 생성 (clip_features 의 DSP 부분)
+static void BM_ClipLogmelDeltas(benchmark::State& state) {
+    static clip_logmel_t clip;
+    std::vector<float> stage1(3 * 40);
+    std::vector<float> stage2(3 * 80);
+    feature_view_t view1 = make_feature_view(stage1.data(), 40);
+    feature_view_t view2 = make_feature_view(stage2.data(), 80);
+    for (auto _ : state) {
+        scan_clip_logmel(recording().data(), recording().size(), &clip);
+        clip_logmel_features(&clip, &view1);
+        clip_logmel_features(&clip, &view2);
+        benchmark::ClobberMemory();
+    }
+    set_frame_counters(state, frames_per_recording());
+}
+BENCHMARK(BM_ClipLogmelDeltas)->Unit(benchmark::kMillisecond);
+
+// 합성곱 모델 입력: frames x 40 로그 멜, arg1 이 1 이면 int8 양자화 출력
+static void BM_Spectrogram(benchmark::State& state) {
+    const int frames = state.range(0);
+    spectrogram_config_t config = default_spectrogram_config(frames, NUM_MEL_FILTERS, recording().size());
+    std::vector<float> f32(frames * NUM_MEL_FILTERS);
+    std::vector<int8_t> i8(frames * NUM_MEL_FILTERS);
+    tensor_sink_t sink = {NULL, NULL, 0.0f, 0};
+    if (state.range(1)) {
+        sink.i8 = i8.data();
+        sink.scale = 0.05f;
+        sink.zero_point = -20;
+    } else {
+        sink.f32 = f32.data();
+    }
+    for (auto _ : state) {
+        extract_spectrogram(recording().data(), recording().size(), &config, sink);
+        benchmark::ClobberMemory();
+    }
+    set_frame_counters(state, frames);
+}
+BENCHMARK(BM_Spectrogram)->Args({49, 0})->Args({98, 0})->Args({98, 1})->Unit(benchmark::kMillisecond);
+
+// 녹음 한 개 전체 (WAV 파일 읽기 포함)
+static void BM_FeatureExtractor(benchmark::State& state) {
+    const int n_mfcc = state.range(0);
+    FILE* audio_file = tmpfile();
+    if (!audio_file) {
+        state.SkipWithError("tmpfile failed");
+        return;
+    }
+    wav_write_pcm_header(audio_file, recording().size() * sizeof(int16_t), SAMPLE_RATE);
+    fwrite(recording().data(), sizeof(int16_t), recording().size(), audio_file);
+    fflush(audio_file);
+
+    std::vector<float> mfcc(n_mfcc);
+    for (auto _ : state) {
+        feature_extractor(audio_file, {mfcc.data(), 1}, n_mfcc);
+        benchmark::DoNotOptimize(mfcc.data());
+    }
+    fclose(audio_file);
+    set_frame_counters(state, frames_per_recording());
+}
+BENCHMARK(BM_FeatureExtractor)->Arg(40)->Arg(80)->Unit(benchmark::kMillisecond);
+
+static std::vector<uint8_t> encode_recording() {
+    std::vector<uint8_t> encoded;
+    uint8_t block[ADPCM_BLOCK_ALIGN];
+    adpcm_state_t state = {0, 0};
+    for (size_t i = 0; i < recording().size(); i += ADPCM_SAMPLES_PER_BLOCK) {
+        int n = std::min<size_t>(ADPCM_SAMPLES_PER_BLOCK, recording().size() - i);
+        size_t len = adpcm_encode_block(&state, recording().data() + i, n, block);
+        encoded.insert(encoded.end(), block, block + len);
+    }
+    return encoded;
+}
+
+static void BM_AdpcmEncode(benchmark::State& state) {
+    for (auto _ : state) {
+        std::vector<uint8_t> encoded = encode_recording();
+        benchmark::DoNotOptimize(encoded.data());
+    }
+    state.SetItemsProcessed(state.iterations() * recording().size());
+}
+BENCHMARK(BM_AdpcmEncode)->Unit(benchmark::kMillisecond);
+
+static void BM_AdpcmDecode(benchmark::State& state) {
+    std::vector<uint8_t> encoded = encode_recording();
+    std::vector<int16_t> decoded(ADPCM_SAMPLES_PER_BLOCK);
+    for (auto _ : state) {
+        for (size_t i = 0; i < encoded.size(); i += ADPCM_BLOCK_ALIGN) {
+            size_t len = std::min<size_t>(ADPCM_BLOCK_ALIGN, encoded.size() - i);
+            adpcm_decode_block(encoded.data() + i, len, decoded.data());
+        }
+        benchmark::DoNotOptimize(decoded.data());
+    }
+    state.SetItemsProcessed(state.iterations() * recording().size());
+}
+BENCHMARK(BM_AdpcmDecode)->Unit(benchmark::kMillisecond);
+
+// CAPTURE_RATE 로 녹음한 6초를 SAMPLE_RATE 로 변환, items 는 입력 샘플
+static void BM_Resample(benchmark::State& state) {
+    resampler_t rs;
+    if (resampler_init(&rs, CAPTURE_RATE, SAMPLE_RATE, state.range(0), MALLOC_CAP_INTERNAL) != ESP_OK) {
+        state.SkipWithError("resampler_init failed");
+        return;
+    }
+    const std::vector<int16_t>& in = recording();
+    std::vector<int16_t> out(resampler_max_output(&rs, in.size()));
+    for (auto _ : state) {
+        resampler_reset(&rs);
+        size_t n = resampler_process(&rs, in.data(), in.size(), out.data());
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetItemsProcessed(state.iterations() * in.size());
+    resampler_deinit(&rs);
+}
+BENCHMARK(BM_Resample)->Arg(16)->Arg(32)->Arg(RESAMPLER_TAPS)->Unit(benchmark::kMillisecond);
+
+// 녹음 루프처럼 한 샘플씩 입력
+static void BM_ResamplePush(benchmark::State& state) {
+    resampler_t rs;
+    if (resampler_init(&rs, CAPTURE_RATE, SAMPLE_RATE, RESAMPLER_TAPS, MALLOC_CAP_INTERNAL) != ESP_OK) {
+        state.SkipWithError("resampler_init failed");
+        return;
+    }
+    const std::vector<int16_t>& in = recording();
+    int16_t out[2];
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(resampler_push(&rs, in[i], out));
+        if (++i == in.size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    resampler_deinit(&rs);
+}
+BENCHMARK(BM_ResamplePush);
+
+int main(int argc, char** argv) {
+    if (init_request_arenas() != ESP_OK || init_feature_extraction() != ESP_OK) {
+        return 1;
+    }
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    cleanup_feature_extraction();
+    cleanup_request_arenas();
+    return 0;
+}
@@ -0,0 +1,11 @@
+#ifndef HOST_SHIM_ESP_DSP_H
+#define HOST_SHIM_ESP_DSP_H
+
+#include "esp_err.h"
+
+// esp-dsp 에서 사용하는 함수만 레퍼런스 구현으로 제공
+esp_err_t dsps_wind_hann_f32(float* window, int len);
+esp_err_t dsps_dct_f32(float* data, int N);
+esp_err_t dsps_dotprod_f32(const float* src1, const float* src2, float* dest, int len);
+
+#endif
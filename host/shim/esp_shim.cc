@@ -0,0 +1,128 @@
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_dsp.h"
+#include "ff.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+esp_log_level_t esp_log_host_level = ESP_LOG_INFO;
+
+void esp_log_level_set(const char* tag, esp_log_level_t level) {
+    (void)tag;
+    esp_log_host_level = level;
+}
+
+const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_INVALID_RESPONSE: return "ESP_ERR_INVALID_RESPONSE";
+        case ESP_ERR_INVALID_CRC: return "ESP_ERR_INVALID_CRC";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+void* heap_caps_malloc(size_t size, uint32_t caps) {
+    (void)caps;
+    return malloc(size);
+}
+
+void* heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+    (void)caps;
+    return calloc(n, size);
+}
+
+void* heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps) {
+    (void)caps;
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void heap_caps_free(void* ptr) {
+    free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    (void)caps;
+    return SIZE_MAX;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+    (void)caps;
+    return SIZE_MAX;
+}
+
+int64_t esp_timer_get_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// esp-dsp 와 동일하게 창 함수를 "생성"한다 (입력에 곱하지 않음)
+esp_err_t dsps_wind_hann_f32(float* window, int len) {
+    float len_mult = 1.0f / (float)(len - 1);
+    for (int i = 0; i < len; i++) {
+        window[i] = 0.5f * (1.0f - cosf(i * 2.0f * (float)M_PI * len_mult));
+    }
+    return ESP_OK;
+}
+
+// 비정규화 DCT-II (dsps_dct_f32_ref 와 같은 정의)
+esp_err_t dsps_dct_f32(float* data, int N) {
+    float temp[1024];
+    if (N <= 0 || N > 1024) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(temp, data, N * sizeof(float));
+    for (int k = 0; k < N; k++) {
+        float sum = 0.0f;
+        for (int n = 0; n < N; n++) {
+            sum += temp[n] * cosf((float)M_PI / N * (n + 0.5f) * k);
+        }
+        data[k] = sum;
+    }
+    return ESP_OK;
+}
+
+esp_err_t dsps_dotprod_f32(const float* src1, const float* src2, float* dest, int len) {
+    float acc = 0.0f;
+    for (int i = 0; i < len; i++) {
+        acc += src1[i] * src2[i];
+    }
+    *dest = acc;
+    return ESP_OK;
+}
+
+FRESULT f_open(FIL* fil, const char* path, BYTE mode) {
+    (void)mode;
+    fil->fp = fopen(path, "rb");
+    if (!fil->fp) {
+        return FR_NO_FILE;
+    }
+    fseek(fil->fp, 0, SEEK_END);
+    fil->size = ftell(fil->fp);
+    fseek(fil->fp, 0, SEEK_SET);
+    return FR_OK;
+}
+
+FRESULT f_read(FIL* fil, void* buff, UINT btr, UINT* br) {
+    *br = fread(buff, 1, btr, fil->fp);
+    return ferror(fil->fp) ? FR_DISK_ERR : FR_OK;
+}
+
+FRESULT f_close(FIL* fil) {
+    fclose(fil->fp);
+    fil->fp = NULL;
+    return FR_OK;
+}
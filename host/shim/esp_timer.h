@@ -0,0 +1,9 @@
+#ifndef HOST_SHIM_ESP_TIMER_H
+#define HOST_SHIM_ESP_TIMER_H
+
+#include <stdint.h>
+
+// CLOCK_MONOTONIC 기준 마이크로초
+int64_t esp_timer_get_time(void);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef HOST_SHIM_FF_H
+#define HOST_SHIM_FF_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// FatFs ff.h 의 호스트용 대체 헤더, 읽기 API 만 stdio 로 구현
+typedef unsigned int UINT;
+typedef unsigned char BYTE;
+typedef uint32_t FSIZE_t;
+
+typedef enum {
+    FR_OK = 0,
+    FR_DISK_ERR,
+    FR_INT_ERR,
+    FR_NOT_READY,
+    FR_NO_FILE,
+    FR_NO_PATH,
+} FRESULT;
+
+typedef struct {
+    FILE* fp;
+    FSIZE_t size;
+} FIL;
+
+#define FA_READ 0x01
+#define f_size(fil) ((fil)->size)
+
+FRESULT f_open(FIL* fil, const char* path, BYTE mode);
+FRESULT f_read(FIL* fil, void* buff, UINT btr, UINT* br);
+FRESULT f_close(FIL* fil);
+
+#endif
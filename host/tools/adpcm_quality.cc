@@ -0,0 +1,145 @@
+#include "adpcm.h"
+#include "audio_config.h"
+#include "feature_extraction.h"
+#include "mem_arena.h"
+#include "wav_io.h"
+#include "esp_log.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+// PCM 녹음을 IMA-ADPCM 으로 저장했을 때 MFCC 가 얼마나 달라지는지 측정
+//   adpcm_quality [file.wav ...]   (인자가 없으면 합성 신호 사용)
+
+static std::vector<int16_t> synthetic_recording() {
+    std::vector<int16_t> samples(MAX_AUDIO_SIZE);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < samples.size(); i++) {
+        seed = seed * 1664525u + 1013904223u;
+        float t = (float)i / SAMPLE_RATE;
+        // 울음소리와 비슷하게 기본 주파수가 흔들리는 고조파 신호 + 잡음
+        float f0 = 400.0f + 80.0f * sinf(2.0f * (float)M_PI * 3.0f * t);
+        float v = 0.0f;
+        for (int h = 1; h <= 5; h++) {
+            v += sinf(2.0f * (float)M_PI * f0 * h * t) / h;
+        }
+        float noise = ((int32_t)(seed >> 16) - 32768) / 32768.0f;
+        samples[i] = (int16_t)(9000.0f * v + 1000.0f * noise);
+    }
+    return samples;
+}
+
+static bool load_pcm(const char* path, std::vector<int16_t>* samples) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    wav_reader_t* reader = new wav_reader_t;
+    bool ok = wav_reader_open(reader, f) == ESP_OK;
+    if (ok) {
+        samples->resize(MAX_AUDIO_SIZE);
+        samples->resize(wav_reader_read(reader, f, samples->data(), samples->size()));
+    }
+    delete reader;
+    fclose(f);
+    return ok && !samples->empty();
+}
+
+static FILE* write_pcm(const std::vector<int16_t>& samples, size_t* bytes) {
+    FILE* f = tmpfile();
+    *bytes = samples.size() * sizeof(int16_t);
+    wav_write_pcm_header(f, *bytes, SAMPLE_RATE);
+    fwrite(samples.data(), sizeof(int16_t), samples.size(), f);
+    fflush(f);
+    return f;
+}
+
+static FILE* write_adpcm(const std::vector<int16_t>& samples, size_t* bytes) {
+    FILE* f = tmpfile();
+    uint8_t block[ADPCM_BLOCK_ALIGN];
+    adpcm_state_t state = {0, 0};
+    *bytes = 0;
+    wav_write_adpcm_header(f, 0, samples.size(), SAMPLE_RATE);
+    for (size_t i = 0; i < samples.size(); i += ADPCM_SAMPLES_PER_BLOCK) {
+        int n = samples.size() - i < ADPCM_SAMPLES_PER_BLOCK ? samples.size() - i : ADPCM_SAMPLES_PER_BLOCK;
+        *bytes += fwrite(block, 1, adpcm_encode_block(&state, samples.data() + i, n, block), f);
+    }
+    wav_write_adpcm_header(f, *bytes, samples.size(), SAMPLE_RATE);
+    fflush(f);
+    return f;
+}
+
+static int compare(const char* name, const std::vector<int16_t>& samples) {
+    size_t pcm_bytes, adpcm_bytes;
+    FILE* pcm = write_pcm(samples, &pcm_bytes);
+    FILE* adpcm = write_adpcm(samples, &adpcm_bytes);
+    if (!pcm || !adpcm) {
+        fprintf(stderr, "%s: tmpfile failed\n", name);
+        return 1;
+    }
+
+    // 디코딩된 파형의 SNR
+    std::vector<int16_t> decoded(samples.size());
+    wav_reader_t* reader = new wav_reader_t;
+    wav_reader_open(reader, adpcm);
+    size_t n = wav_reader_read(reader, adpcm, decoded.data(), decoded.size());
+    delete reader;
+    double signal = 0.0, noise = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double d = (double)samples[i] - decoded[i];
+        signal += (double)samples[i] * samples[i];
+        noise += d * d;
+    }
+    printf("%s: %zu samples, pcm %zu bytes, adpcm %zu bytes (%.2fx), snr %.1f dB\n", name, samples.size(),
+           pcm_bytes, adpcm_bytes, (double)pcm_bytes / adpcm_bytes, 10.0 * log10(signal / (noise + 1e-9)));
+
+    const int n_mfccs[] = {40, 80};
+    for (int n_mfcc : n_mfccs) {
+        std::vector<float> ref(n_mfcc), test(n_mfcc);
+        feature_extractor(pcm, {ref.data(), 1}, n_mfcc);
+        feature_extractor(adpcm, {test.data(), 1}, n_mfcc);
+
+        double diff2 = 0.0, ref2 = 0.0, max_abs = 0.0;
+        for (int i = 0; i < n_mfcc; i++) {
+            double d = fabs((double)ref[i] - test[i]);
+            diff2 += d * d;
+            ref2 += (double)ref[i] * ref[i];
+            if (d > max_abs) {
+                max_abs = d;
+            }
+        }
+        printf("  mfcc%d: relative L2 error %.4f%%, max abs diff %.5f\n", n_mfcc,
+               100.0 * sqrt(diff2 / (ref2 + 1e-12)), max_abs);
+    }
+
+    fclose(pcm);
+    fclose(adpcm);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    esp_log_level_set("*", ESP_LOG_WARN);
+    if (init_request_arenas() != ESP_OK || init_feature_extraction() != ESP_OK) {
+        return 1;
+    }
+
+    int ret = 0;
+    if (argc < 2) {
+        ret |= compare("synthetic", synthetic_recording());
+    }
+    for (int i = 1; i < argc; i++) {
+        std::vector<int16_t> samples;
+        if (!load_pcm(argv[i], &samples)) {
+            fprintf(stderr, "%s: cannot read\n", argv[i]);
+            ret = 1;
+            continue;
+        }
+        ret |= compare(argv[i], samples);
+    }
+
+    cleanup_feature_extraction();
+    cleanup_request_arenas();
+    return ret;
+}
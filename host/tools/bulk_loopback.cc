@@ -0,0 +1,148 @@
+#include "bulk_transfer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <deque>
+#include <vector>
+
+// BLE 대신 메모리 큐로 bulk_transfer 송수신을 돌려 보는 루프백
+//   bulk_loopback [-m mtu] [-w window] [-l loss%] [-s size] [file]
+// 손실/재전송이 있어도 받은 데이터가 원본과 같은지 확인하고 프레임 수를 출력
+
+#define ATT_NOTIFY_OVERHEAD 3
+#define MAX_ROUNDS 100000
+
+typedef std::vector<uint8_t> frame_t;
+
+typedef struct {
+    const std::vector<uint8_t>* source;
+    std::vector<uint8_t>* sink;
+    std::deque<frame_t>* air;
+    size_t air_bytes;
+} loopback_t;
+
+static size_t read_source(void* ctx, uint32_t offset, uint8_t* buf, size_t len) {
+    loopback_t* lb = (loopback_t*)ctx;
+    memcpy(buf, lb->source->data() + offset, len);
+    return len;
+}
+
+static int send_frame(void* ctx, const uint8_t* frame, size_t len) {
+    loopback_t* lb = (loopback_t*)ctx;
+    lb->air->push_back(frame_t(frame, frame + len));
+    lb->air_bytes += len + ATT_NOTIFY_OVERHEAD;
+    return 0;
+}
+
+static void write_sink(void* ctx, uint32_t offset, const uint8_t* data, size_t len) {
+    loopback_t* lb = (loopback_t*)ctx;
+    memcpy(lb->sink->data() + offset, data, len);
+}
+
+static bool dropped(int loss_pct) {
+    return loss_pct > 0 && rand() % 100 < loss_pct;
+}
+
+int main(int argc, char** argv) {
+    int mtu = 247;
+    int window = BULK_DEFAULT_WINDOW;
+    int loss_pct = 0;
+    size_t size = 270044;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:w:l:s:")) != -1) {
+        switch (opt) {
+            case 'm': mtu = atoi(optarg); break;
+            case 'w': window = atoi(optarg); break;
+            case 'l': loss_pct = atoi(optarg); break;
+            case 's': size = strtoul(optarg, NULL, 10); break;
+            default:
+                fprintf(stderr, "usage: %s [-m mtu] [-w window] [-l loss%%] [-s size] [file]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    std::vector<uint8_t> source;
+    if (optind < argc) {
+        FILE* f = fopen(argv[optind], "rb");
+        if (!f) {
+            fprintf(stderr, "%s: cannot open\n", argv[optind]);
+            return 1;
+        }
+        uint8_t buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+            source.insert(source.end(), buf, buf + n);
+        }
+        fclose(f);
+    } else {
+        source.resize(size);
+        for (size_t i = 0; i < size; i++) {
+            source[i] = (uint8_t)(i * 131 + (i >> 8));
+        }
+    }
+
+    std::vector<uint8_t> sink(source.size());
+    std::deque<frame_t> air;
+    loopback_t lb = {&source, &sink, &air, 0};
+
+    uint8_t request[BULK_REQUEST_SIZE];
+    uint8_t kind;
+    uint32_t arg;
+    bulk_encode_request(request, BULK_KIND_AUDIO, 0);
+    if (bulk_decode_request(request, sizeof(request), &kind, &arg) != ESP_OK) {
+        fprintf(stderr, "request encode/decode mismatch\n");
+        return 1;
+    }
+
+    bulk_sender_t sender;
+    bulk_receiver_t receiver;
+    uint16_t chunk = bulk_chunk_size(mtu);
+    if (bulk_sender_init(&sender, 1, kind, source.size(), chunk, window, read_source, send_frame, &lb) != ESP_OK) {
+        // 16비트 seq 로 셀 수 없는 크기는 전송을 시작하지 않고 거절해야 한다
+        printf("mtu %d, chunk %u: %zu bytes exceeds %u chunks, rejected\n", mtu, chunk, source.size(),
+               BULK_MAX_CHUNKS);
+        return 3;
+    }
+    bulk_receiver_init(&receiver, write_sink, &lb);
+
+    int rounds = 0, timeouts = 0;
+    size_t ack_frames = 0;
+    while (!sender.done && rounds++ < MAX_ROUNDS) {
+        bulk_sender_pump(&sender);
+        if (air.empty()) {
+            // 보낼 것도 받은 ACK 도 없으면 ACK 시간 초과로 처리
+            timeouts++;
+            bulk_sender_on_timeout(&sender);
+            continue;
+        }
+
+        // 한 연결 이벤트에 실린 프레임을 전달하고 ACK 는 역방향으로 바로 돌려준다
+        while (!air.empty()) {
+            frame_t frame = air.front();
+            air.pop_front();
+            if (dropped(loss_pct)) {
+                continue;
+            }
+            uint8_t ack[BULK_ACK_SIZE];
+            size_t ack_len = bulk_receiver_on_frame(&receiver, frame.data(), frame.size(), ack);
+            if (ack_len > 0) {
+                ack_frames++;
+                if (!dropped(loss_pct)) {
+                    bulk_sender_on_frame(&sender, ack, ack_len);
+                }
+            }
+        }
+    }
+
+    bool same = sender.done && receiver.complete && sink == source;
+    printf("mtu %d, chunk %u, window %d, loss %d%%: %zu bytes in %u chunks\n", mtu, chunk, window, loss_pct,
+           source.size(), sender.total_chunks);
+    printf("  frames sent %u, retransmitted chunks %u, acks %zu, timeouts %d, crc errors %u\n", sender.frames_sent,
+           sender.retransmits, ack_frames, timeouts, receiver.crc_errors);
+    printf("  payload efficiency %.1f%% (%zu bytes on air), %s\n", 100.0 * source.size() / lb.air_bytes,
+           lb.air_bytes, same ? "identical" : "MISMATCH");
+    return same ? 0 : 1;
+}
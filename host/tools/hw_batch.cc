@@ -0,0 +1,285 @@
+#include "data_paths.h"
+#include "feature_extraction.h"
+#include "model_inference.h"
+#include "mem_arena.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// WAV 데이터셋 전체를 여러 스레드로 분류해 파일당 한 줄의 TSV 로 기록
+//   스레드마다 자기 요청 아레나 쌍을 bind_request_arenas() 로 묶고 classify_file() 을 호출하므로
+//   인터프리터 / tensor arena / 특징 scratch 가 스레드 사이에 공유되지 않는다
+
+typedef struct {
+    std::string path;
+    pipeline_result_t result;
+    esp_err_t status;
+    int64_t wall_us;
+} batch_item_t;
+
+static const char* label_name(int code) {
+    static const char* names[] = {"pain", "awake", "diaper", "hug", "hungry", "sleepy", "wrong prediction",
+                                  "no pain (stage 1 only)"};
+    if (code < 0 || code > 7) {
+        return "error";
+    }
+    return names[code];
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [-d data_root] [-j threads] [-o out.tsv] [-f] [-p] [-q] <dir | manifest>\n", prog);
+    fprintf(stderr, "  dir: every *.wav directly under it, manifest: one path per line ('#' comments)\n");
+}
+
+static bool has_wav_suffix(const char* name) {
+    size_t len = strlen(name);
+    return len > 4 && strcasecmp(name + len - 4, ".wav") == 0;
+}
+
+static bool collect_inputs(const char* source, std::vector<batch_item_t>* items) {
+    struct stat st;
+    if (stat(source, &st) != 0) {
+        fprintf(stderr, "cannot stat %s\n", source);
+        return false;
+    }
+
+    std::vector<std::string> paths;
+    if (S_ISDIR(st.st_mode)) {
+        DIR* dir = opendir(source);
+        if (!dir) {
+            return false;
+        }
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (has_wav_suffix(entry->d_name)) {
+                paths.push_back(std::string(source) + "/" + entry->d_name);
+            }
+        }
+        closedir(dir);
+        std::sort(paths.begin(), paths.end());
+    } else {
+        FILE* f = fopen(source, "r");
+        if (!f) {
+            return false;
+        }
+        char line[1024];
+        while (fgets(line, sizeof(line), f)) {
+            line[strcspn(line, "\r\n")] = '\0';
+            if (line[0] != '\0' && line[0] != '#') {
+                paths.push_back(line);
+            }
+        }
+        fclose(f);
+    }
+
+    items->resize(paths.size());
+    for (size_t i = 0; i < paths.size(); i++) {
+        (*items)[i].path = paths[i];
+        (*items)[i].status = ESP_FAIL;
+    }
+    return true;
+}
+
+static void worker(std::vector<batch_item_t>* items, std::atomic<size_t>* next, esp_err_t* status) {
+    mem_arena_t internal = {};
+    mem_arena_t psram = {};
+    *status = mem_arena_init(&internal, "internal", INTERNAL_ARENA_SIZE, MALLOC_CAP_INTERNAL);
+    if (*status == ESP_OK) {
+        *status = mem_arena_init(&psram, "psram", PSRAM_ARENA_SIZE, MALLOC_CAP_SPIRAM);
+    }
+    if (*status != ESP_OK) {
+        mem_arena_deinit(&internal);
+        return;
+    }
+    bind_request_arenas(&internal, &psram);
+
+    size_t index;
+    while ((index = next->fetch_add(1)) < items->size()) {
+        batch_item_t* item = &(*items)[index];
+        int64_t begin = esp_timer_get_time();
+        FILE* f = fopen(item->path.c_str(), "rb");
+        if (f) {
+            item->status = classify_file(f, &item->result);
+            fclose(f);
+        } else {
+            memset(&item->result, 0, sizeof(item->result));
+        }
+        mem_arena_reset(&internal);
+        mem_arena_reset(&psram);
+        item->wall_us = esp_timer_get_time() - begin;
+    }
+
+    bind_request_arenas(NULL, NULL);
+    mem_arena_deinit(&internal);
+    mem_arena_deinit(&psram);
+}
+
+// 열 순서: 파일, 결과, 단계별 점수, 단계별 시간, (-f) 모델 입력 특징
+static void write_header(FILE* out, bool features) {
+    fprintf(out, "path\tlabel\tlabel_name\tstages");
+    for (int s = 0; s < 2; s++) {
+        for (int i = 0; i < PIPELINE_MAX_SCORES; i++) {
+            fprintf(out, "\ts%d_score%d", s + 1, i);
+        }
+    }
+    for (int s = 0; s < 2; s++) {
+        fprintf(out, "\ts%d_load_us\ts%d_feature_us\ts%d_invoke_us", s + 1, s + 1, s + 1);
+    }
+    fprintf(out, "\ttotal_us\twall_us");
+    if (features) {
+        for (int i = 0; i < STAGE1_FEATURES + STAGE2_FEATURES; i++) {
+            fprintf(out, "\tf%d", i);
+        }
+    }
+    fputc('\n', out);
+}
+
+// 실행되지 않은 단계 / 값은 빈 칸
+static void write_row(FILE* out, const batch_item_t* item, bool features) {
+    const pipeline_result_t* r = &item->result;
+    int label = item->status == ESP_OK && r->answer ? atoi(r->answer) : -1;
+    fprintf(out, "%s\t%d\t%s\t%d", item->path.c_str(), label, label_name(label), r->timing.stages_run);
+    for (int s = 0; s < 2; s++) {
+        for (int i = 0; i < PIPELINE_MAX_SCORES; i++) {
+            if (i < r->score_count[s]) {
+                fprintf(out, "\t%.6g", r->scores[s][i]);
+            } else {
+                fputc('\t', out);
+            }
+        }
+    }
+    for (int s = 0; s < 2; s++) {
+        if (s < r->timing.stages_run) {
+            const stage_timing_t* t = &r->timing.stage[s];
+            fprintf(out, "\t%lld\t%lld\t%lld", (long long)t->model_load_us, (long long)t->feature_us,
+                    (long long)t->invoke_us);
+        } else {
+            fputs("\t\t\t", out);
+        }
+    }
+    fprintf(out, "\t%lld\t%lld", (long long)r->timing.total_us, (long long)item->wall_us);
+    if (features) {
+        for (int i = 0; i < STAGE1_FEATURES + STAGE2_FEATURES; i++) {
+            if (i < r->feature_count) {
+                fprintf(out, "\t%.6g", r->features[i]);
+            } else {
+                fputc('\t', out);
+            }
+        }
+    }
+    fputc('\n', out);
+}
+
+int main(int argc, char** argv) {
+    int threads = (int)std::thread::hardware_concurrency();
+    const char* out_path = NULL;
+    bool features = false;
+    bool preload = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "d:j:o:fpq")) != -1) {
+        switch (opt) {
+            case 'd':
+                set_data_root(optarg);
+                break;
+            case 'j':
+                threads = atoi(optarg);
+                break;
+            case 'o':
+                out_path = optarg;
+                break;
+            case 'f':
+                features = true;
+                break;
+            case 'p':
+                preload = true;
+                break;
+            case 'q':
+                esp_log_level_set("*", ESP_LOG_WARN);
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if (optind != argc - 1 || threads < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<batch_item_t> items;
+    if (!collect_inputs(argv[optind], &items)) {
+        return 1;
+    }
+    if (items.empty()) {
+        fprintf(stderr, "no input files\n");
+        return 1;
+    }
+    threads = std::min<int>(threads, (int)items.size());
+
+    // 필터뱅크 / 윈도우 / 모델 캐시는 시작 전에 한 번만 만들고 이후 읽기 전용
+    if (init_feature_extraction() != ESP_OK || init_model_inference() != ESP_OK) {
+        return 1;
+    }
+    if (preload && preload_models() != ESP_OK) {
+        return 1;
+    }
+
+    FILE* out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "cannot open %s\n", out_path);
+        return 1;
+    }
+
+    std::atomic<size_t> next(0);
+    std::vector<esp_err_t> worker_status(threads, ESP_OK);
+    std::vector<std::thread> pool;
+    int64_t begin = esp_timer_get_time();
+    for (int i = 0; i < threads; i++) {
+        pool.emplace_back(worker, &items, &next, &worker_status[i]);
+    }
+    for (std::thread& t : pool) {
+        t.join();
+    }
+    int64_t elapsed = esp_timer_get_time() - begin;
+
+    write_header(out, features);
+    size_t failed = 0;
+    int64_t busy_us = 0;
+    for (const batch_item_t& item : items) {
+        write_row(out, &item, features);
+        busy_us += item.wall_us;
+        if (item.status != ESP_OK) {
+            failed++;
+        }
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+
+    for (int i = 0; i < threads; i++) {
+        if (worker_status[i] != ESP_OK) {
+            fprintf(stderr, "worker %d failed to allocate arenas\n", i);
+        }
+    }
+    // busy / wall 은 실효 병렬도, threads 에 가까울수록 선형 확장
+    fprintf(stderr, "%zu files (%zu failed) on %d threads in %.3f s: %.1f files/s, parallelism %.2f\n", items.size(),
+            failed, threads, elapsed / 1e6, items.size() * 1e6 / std::max<int64_t>(elapsed, 1),
+            (double)busy_us / std::max<int64_t>(elapsed, 1));
+
+    cleanup_model_inference();
+    cleanup_feature_extraction();
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,318 @@
+#include "data_paths.h"
+#include "feature_extraction.h"
+#include "model_inference.h"
+#include "mem_arena.h"
+#include "record_store.h"
+#include "audio_config.h"
+#include "wav_io.h"
+#include "rolling_features.h"
+#include "continuous_mode.h"
+#include "metrics.h"
+#include "request_budget.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+static const char* result_name(const char* result) {
+    static const char* names[] = {"pain", "awake", "diaper", "hug", "hungry", "sleepy", "wrong prediction",
+                                  "no pain (stage 1 only)"};
+    int code = atoi(result);
+    if (code < 0 || code > 7) {
+        return "error";
+    }
+    return names[code];
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [-d data_root] [-n repeat] [-q] [-s] [-m] [-p] [-P] [-S | -C] [-c interval_ms] [-B budget_ms] file.wav\n", prog);
+}
+
+static size_t read_clip(const char* audio_path, int16_t* samples, size_t max_samples) {
+    FILE* f = fopen(audio_path, "rb");
+    if (!f) {
+        return 0;
+    }
+    wav_reader_t* reader = new wav_reader_t;
+    size_t count = 0;
+    if (wav_reader_open(reader, f) == ESP_OK) {
+        count = wav_reader_read(reader, f, samples, max_samples);
+    }
+    delete reader;
+    fclose(f);
+    return count;
+}
+
+// -m: 스케줄러와 같은 경로 (메모리 클립 -> clip_features -> pipeline_clip)
+static const char* classify_clip(const char* audio_path, mem_arena_t* scratch) {
+    static std::vector<int16_t> samples(MAX_AUDIO_SIZE);
+    static clip_features_t features;
+    size_t count = read_clip(audio_path, samples.data(), samples.size());
+
+    if (count == 0 || clip_features(samples.data(), count, &features, scratch) != ESP_OK) {
+        return "-1";
+    }
+    return pipeline_clip(&features, samples.data(), count, NULL);
+}
+
+// -c: 연속 모드와 같은 경로, 파일을 repeat 번 이어 붙인 스트림을 청크 단위로 흘려 interval 마다 분류하고
+//     마지막 창을 clip_features() 로 다시 계산한 값과 비교
+static int classify_continuous(const char* audio_path, int repeat, int interval_ms, mem_arena_t* scratch) {
+    std::vector<int16_t> clip(MAX_AUDIO_SIZE);
+    size_t clip_count = read_clip(audio_path, clip.data(), clip.size());
+    if (clip_count == 0) {
+        return 1;
+    }
+    std::vector<int16_t> stream;
+    for (int i = 0; i < repeat; i++) {
+        stream.insert(stream.end(), clip.begin(), clip.begin() + clip_count);
+    }
+
+    rolling_features_t rolling;
+    if (rolling_init(&rolling, CLIP_FRAMES(CONTINUOUS_WINDOW_MS * SAMPLE_RATE / 1000), MALLOC_CAP_SPIRAM) != ESP_OK) {
+        return 1;
+    }
+    int interval_frames = std::max(1, interval_ms * SAMPLE_RATE / 1000 / FRAME_STEP);
+    static clip_features_t features;
+    int since_result = 0;
+    int results = 0;
+    int64_t dsp_us = 0;
+    int64_t classify_us = 0;
+
+    for (size_t pos = 0; pos < stream.size(); pos += CONTINUOUS_CHUNK_SAMPLES) {
+        size_t n = std::min<size_t>(CONTINUOUS_CHUNK_SAMPLES, stream.size() - pos);
+        int64_t begin = esp_timer_get_time();
+        since_result += rolling_push(&rolling, stream.data() + pos, n, scratch);
+        dsp_us += esp_timer_get_time() - begin;
+
+        if (rolling_full(&rolling) && since_result >= interval_frames) {
+            since_result = 0;
+            begin = esp_timer_get_time();
+            const char* result = "-1";
+            if (rolling_clip_features(&rolling, &features) == ESP_OK) {
+                result = pipeline_clip(&features, NULL, 0, NULL);
+            }
+            int64_t elapsed = esp_timer_get_time() - begin;
+            classify_us += elapsed;
+            results++;
+            printf("window end %lld ms: result %s (%s), classify %lld us\n",
+                   (long long)((pos + n) * 1000 / SAMPLE_RATE), result, result_name(result), (long long)elapsed);
+        }
+    }
+
+    // 마지막 창과 같은 샘플 구간을 한 번에 계산해 비교 (마지막 프레임 뒤 한 샘플은 프레임에 쓰이지 않는다)
+    size_t first = (size_t)(rolling.total_frames - rolling.count) * FRAME_STEP;
+    size_t len = (size_t)(rolling.count - 1) * FRAME_STEP + FRAME_LENGTH + 1;
+    std::vector<int16_t> window(len, 0);
+    std::copy(stream.begin() + first, stream.begin() + std::min(first + len, stream.size()), window.begin());
+    static clip_features_t reference;
+    int64_t begin = esp_timer_get_time();
+    clip_features(window.data(), len, &reference, scratch);
+    int64_t full_us = esp_timer_get_time() - begin;
+    rolling_clip_features(&rolling, &features);
+    float max_diff = 0.0f;
+    for (int i = 0; i < STAGE1_FEATURES; i++) {
+        max_diff = fmaxf(max_diff, fabsf(features.stage1[i] - reference.stage1[i]));
+    }
+    for (int i = 0; i < STAGE2_FEATURES; i++) {
+        max_diff = fmaxf(max_diff, fabsf(features.stage2[i] - reference.stage2[i]));
+    }
+
+    printf("frames %u, %d classifications: %lld us DSP per frame, %lld us per classification\n",
+           (unsigned)rolling.total_frames, results, (long long)(dsp_us / std::max<uint32_t>(rolling.total_frames, 1)),
+           (long long)(classify_us / std::max(results, 1)));
+    printf("full-window recompute %lld us, max |rolling - full| = %g\n", (long long)full_us, max_diff);
+    rolling_deinit(&rolling);
+    return results > 0 ? 0 : 1;
+}
+
+// -P: 디바이스 stage_executor 대신 스레드 하나로 2단계 추측 실행
+static std::thread speculative_thread;
+
+static esp_err_t thread_start(void (*job)(void*), void* ctx) {
+    speculative_thread = std::thread(job, ctx);
+    return ESP_OK;
+}
+
+static void thread_wait() {
+    speculative_thread.join();
+}
+
+static const stage_executor_t thread_executor = {thread_start, thread_wait};
+
+// -C: 같은 파일을 캐스케이드와 스펙트로그램 모드로 repeat 번씩 분류해 단계별 지연 비교
+static int compare_modes(const char* audio_path, int repeat) {
+    static const pipeline_mode_t modes[] = {PIPELINE_CASCADE, PIPELINE_SPECTROGRAM};
+    static const char* const mode_names[] = {"cascade", "spectrogram"};
+    static const metric_hist_t hists[] = {METRIC_HIST_MODEL_LOAD, METRIC_HIST_FEATURES, METRIC_HIST_INVOKE1,
+                                          METRIC_HIST_INVOKE2, METRIC_HIST_PIPELINE};
+    static const char* const hist_names[] = {"load", "features", "invoke1", "invoke2", "total"};
+
+    printf("%-12s %-8s %6s %10s %10s %10s\n", "mode", "stage", "count", "p50_us", "p99_us", "max_us");
+    for (int m = 0; m < 2; m++) {
+        set_pipeline_mode(modes[m]);
+        metrics_reset();
+        const char* result = "-1";
+        for (int i = 0; i < repeat; i++) {
+            result = pipeline_file(audio_path);
+        }
+        for (size_t h = 0; h < sizeof(hists) / sizeof(hists[0]); h++) {
+            metric_hist_summary_t summary;
+            metrics_hist_summary(hists[h], &summary);
+            if (summary.count > 0) {
+                printf("%-12s %-8s %6u %10u %10u %10u\n", mode_names[m], hist_names[h], (unsigned)summary.count,
+                       (unsigned)summary.p50_us, (unsigned)summary.p99_us, (unsigned)summary.max_us);
+            }
+        }
+        printf("%-12s result %s (%s)\n", mode_names[m], result, result_name(result));
+        if (strcmp(result, "-1") == 0 || strcmp(result, "6") == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int repeat = 1;
+    bool store = false;
+    bool clip = false;
+    bool preload = false;
+    bool compare = false;
+    bool speculate = false;
+    int interval_ms = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "d:n:qsmpPSCc:B:")) != -1) {
+        switch (opt) {
+            case 'd':
+                set_data_root(optarg);
+                break;
+            case 'n':
+                repeat = atoi(optarg);
+                break;
+            case 'q':
+                esp_log_level_set("*", ESP_LOG_WARN);
+                break;
+            case 's':
+                store = true;
+                break;
+            case 'm':
+                clip = true;
+                break;
+            case 'p':
+                preload = true;
+                break;
+            case 'P':
+                speculate = true;
+                break;
+            case 'S':
+                set_pipeline_mode(PIPELINE_SPECTROGRAM);
+                break;
+            case 'C':
+                compare = true;
+                break;
+            case 'c':
+                interval_ms = atoi(optarg);
+                break;
+            case 'B':
+                set_request_budget(atoi(optarg));
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if (optind != argc - 1 || repeat < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+    const char* audio_path = argv[optind];
+
+    if (init_request_arenas() != ESP_OK || init_feature_extraction() != ESP_OK || init_model_inference() != ESP_OK) {
+        return 1;
+    }
+
+    // -s: 결과를 <data_root>/store 에 기록
+    char store_path[DATA_PATH_MAX];
+    if (store && record_store_open(data_path(store_path, sizeof(store_path), STORE_DIR_NAME)) != ESP_OK) {
+        return 1;
+    }
+
+    // -p: 디바이스 부팅과 같이 모델을 미리 읽어 둔다
+    if (preload && preload_models() != ESP_OK) {
+        return 1;
+    }
+
+    if (speculate && enable_speculation(&thread_executor) != ESP_OK) {
+        return 1;
+    }
+
+    if (compare) {
+        int ret = compare_modes(audio_path, repeat);
+        enable_speculation(NULL);
+        cleanup_model_inference();
+        cleanup_feature_extraction();
+        cleanup_request_arenas();
+        return ret;
+    }
+
+    mem_arena_t scratch = {};
+    if ((clip || interval_ms > 0) && mem_arena_init(&scratch, "scratch", INTERNAL_ARENA_SIZE, MALLOC_CAP_INTERNAL) != ESP_OK) {
+        return 1;
+    }
+
+    if (interval_ms > 0) {
+        int ret = classify_continuous(audio_path, repeat, interval_ms, &scratch);
+        mem_arena_deinit(&scratch);
+        cleanup_model_inference();
+        cleanup_feature_extraction();
+        cleanup_request_arenas();
+        return ret;
+    }
+
+    const char* result = "-1";
+    for (int i = 0; i < repeat; i++) {
+        result = clip ? classify_clip(audio_path, &scratch) : pipeline_file(audio_path);
+        const pipeline_timing_t* timing = pipeline_last_timing();
+        for (int s = 0; s < timing->stages_run; s++) {
+            printf("run %d stage %d: load %lld us, features %lld us, invoke %lld us\n", i + 1, s + 1,
+                   (long long)timing->stage[s].model_load_us, (long long)timing->stage[s].feature_us,
+                   (long long)timing->stage[s].invoke_us);
+        }
+        printf("run %d total: %lld us\n", i + 1, (long long)timing->total_us);
+        uint32_t degraded = pipeline_last_result()->degraded;
+        if (degraded) {
+            printf("run %d degraded:%s%s%s\n", i + 1, degraded & DEGRADE_SKIP_STORE ? " skip-store" : "",
+                   degraded & DEGRADE_SHORT_AUDIO ? " short-audio" : "",
+                   degraded & DEGRADE_STAGE1_ONLY ? " stage1-only" : "");
+        }
+    }
+    printf("result: %s (%s)\n", result, result_name(result));
+    if (repeat > 1) {
+        // 디바이스 메트릭과 같은 로그 스케일 히스토그램 기준
+        metric_hist_summary_t total;
+        metrics_hist_summary(METRIC_HIST_PIPELINE, &total);
+        printf("pipeline p50 %u us, p99 %u us, max %u us over %u runs\n", (unsigned)total.p50_us,
+               (unsigned)total.p99_us, (unsigned)total.max_us, (unsigned)total.count);
+    }
+    printf("arena high-water (all runs): internal %zu bytes, psram %zu bytes\n", internal_arena()->peak,
+           psram_arena()->peak);
+
+    if (store) {
+        printf("store: records %u..%u\n", (unsigned)record_store_oldest_seq(), (unsigned)record_store_next_seq());
+        record_store_close();
+    }
+    mem_arena_deinit(&scratch);
+    enable_speculation(NULL);
+    cleanup_model_inference();
+    cleanup_feature_extraction();
+    cleanup_request_arenas();
+    return strcmp(result, "-1") == 0 ? 1 : 0;
+}
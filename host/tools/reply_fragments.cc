@@ -0,0 +1,121 @@
+#include "command_protocol.h"
+#include "metrics.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// BLE 알림 경로처럼 응답 프레임을 ATT MTU 단위 조각으로 나눠 보내고, 받는 쪽에서 이어 붙여 다시 해석
+//   reply_fragments
+// MTU 보다 긴 GET_METRICS 응답(스냅샷 / 히스토그램)이 모든 MTU 에서 CRC 까지 온전히 복원되는지 확인
+// 합류 / 구독 연결에 함께 가는 1단계만의 분류 결과가 프레임과 텍스트 'r' 형식으로 어떻게 전달되는지도 확인
+
+#define ATT_NOTIFY_OVERHEAD 3
+
+typedef struct {
+    size_t chunk;
+    std::vector<std::vector<uint8_t>> notifications;
+} air_t;
+
+static int notify(void* ctx, const uint8_t* data, size_t len) {
+    air_t* air = (air_t*)ctx;
+    if (len > air->chunk) {
+        return -1;
+    }
+    air->notifications.push_back(std::vector<uint8_t>(data, data + len));
+    return 0;
+}
+
+// frames 를 차례로 조각내 보내고, 조각을 순서대로 파서에 넣어 같은 프레임이 나오는지
+static bool roundtrip(uint16_t mtu, const std::vector<std::vector<uint8_t>>& frames) {
+    air_t air = {(size_t)mtu - ATT_NOTIFY_OVERHEAD, {}};
+    for (const std::vector<uint8_t>& frame : frames) {
+        if (cmd_send_fragmented(frame.data(), frame.size(), air.chunk, notify, &air) != 0) {
+            printf("mtu %d: send failed\n", mtu);
+            return false;
+        }
+    }
+
+    cmd_parser_t parser = {};
+    cmd_parser_reset(&parser);
+    size_t next = 0;
+    bool ok = true;
+    for (const std::vector<uint8_t>& n : air.notifications) {
+        for (uint8_t byte : n) {
+            cmd_frame_t frame;
+            if (!cmd_parser_push(&parser, byte, &frame)) {
+                continue;
+            }
+            do {
+                if (next >= frames.size()) {
+                    printf("mtu %d: unexpected frame 0x%02x\n", mtu, frame.cmd);
+                    ok = false;
+                    continue;
+                }
+                const std::vector<uint8_t>& sent = frames[next++];
+                ok &= frame.cmd == sent[1] && (size_t)frame.len + CMD_FRAME_OVERHEAD == sent.size() &&
+                      memcmp(frame.payload, sent.data() + CMD_HEADER_SIZE, frame.len) == 0;
+            } while (cmd_parser_poll(&parser, &frame));
+        }
+    }
+    ok &= next == frames.size() && parser.crc_errors == 0 && cmd_parser_idle(&parser);
+    printf("mtu %3d: %zu frames in %zu notifications, %s\n", mtu, frames.size(), air.notifications.size(),
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static std::vector<uint8_t> reply(uint8_t cmd, uint8_t status, const void* data, size_t len) {
+    std::vector<uint8_t> frame(CMD_MAX_PAYLOAD + CMD_FRAME_OVERHEAD);
+    frame.resize(cmd_encode_reply(frame.data(), frame.size(), cmd, status, data, len));
+    return frame;
+}
+
+// gatt_svc 의 fan_out_result() 처럼: 최종 결과면 구독자에게도, 텍스트 'r' 연결은 아는 코드로
+static bool coalesced_stage1_only() {
+    const uint8_t payload[] = {7, 0x2a, 0, 0, 0};   // [result i8][seq u32]
+    std::vector<uint8_t> frame = reply(CMD_CLASSIFY, CMD_STATUS_STAGE1_ONLY, payload, sizeof(payload));
+    bool ok = cmd_status_is_result(CMD_STATUS_STAGE1_ONLY) && !cmd_status_is_result(CMD_STATUS_PENDING) &&
+              !cmd_status_is_result(CMD_STATUS_BAD_ARG);
+    ok &= cmd_legacy_result(CMD_STATUS_STAGE1_ONLY, frame.data(), frame.size()) == CMD_LEGACY_NO_CLASS;
+    ok &= frame[CMD_HEADER_SIZE] == CMD_STATUS_STAGE1_ONLY && (int8_t)frame[CMD_HEADER_SIZE + 1] == 7;
+
+    const uint8_t answer[] = {4, 0x2a, 0, 0, 0};
+    std::vector<uint8_t> normal = reply(CMD_CLASSIFY, CMD_STATUS_OK, answer, sizeof(answer));
+    ok &= cmd_legacy_result(CMD_STATUS_OK, normal.data(), normal.size()) == 4;
+    printf("coalesced stage-1-only reply: %s\n", ok ? "ok" : "FAILED");
+    return ok && roundtrip(23, {frame, normal});
+}
+
+int main() {
+    // command_dispatch 의 GET_METRICS 응답과 같은 내용
+    for (int i = 0; i < 1000; i++) {
+        metrics_add(METRIC_COMMANDS);
+        metrics_observe(METRIC_HIST_PIPELINE, i * 37);
+    }
+    uint8_t snapshot[METRICS_ENCODED_SIZE];
+    size_t snapshot_len = metrics_encode(snapshot, sizeof(snapshot), 123456);
+
+    uint32_t buckets[METRICS_HIST_BUCKETS];
+    uint8_t hist[1 + sizeof(buckets)];
+    metrics_hist_buckets(METRIC_HIST_PIPELINE, buckets);
+    hist[0] = METRIC_HIST_PIPELINE;
+    memcpy(hist + 1, buckets, sizeof(buckets));
+
+    std::vector<std::vector<uint8_t>> frames = {
+        reply(CMD_GET_METRICS, CMD_STATUS_OK, snapshot, snapshot_len),
+        reply(CMD_GET_METRICS, CMD_STATUS_OK, hist, sizeof(hist)),
+        reply(CMD_CLASSIFY, CMD_STATUS_PENDING, NULL, 0),
+    };
+    if (frames[0].size() <= 64 || frames[1].size() <= 64) {
+        printf("metrics replies are expected to exceed 64 bytes\n");
+        return 1;
+    }
+
+    bool ok = true;
+    const uint16_t mtus[] = {23, 64, 67, 185, 247, 517};
+    for (uint16_t mtu : mtus) {
+        ok &= roundtrip(mtu, frames);
+    }
+    ok &= coalesced_stage1_only();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+#include "resampler.h"
+#include "audio_config.h"
+#include "esp_heap_caps.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+// 사인파를 주파수별로 흘려 resampler 의 진폭 응답을 측정
+//   통과대역 (낮은 쪽 나이퀴스트의 pass% 까지) 리플과
+//   출력 나이퀴스트 이상 입력(접혀 들어오는 에일리어싱)의 최대 이득을 기준과 비교
+#define TONE_AMPLITUDE 16000.0
+#define TONE_SECONDS 1.0
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [-i in_rate] [-o out_rate] [-t taps] [-p pass%%] [-r max_ripple_db] [-s min_stop_db] [-v]\n",
+            prog);
+}
+
+// 출력 전체 RMS 로 측정 (에일리어싱은 다른 주파수로 나타나므로 진폭 맞춤 대신 RMS)
+static double measure_gain_db(resampler_t* rs, uint32_t in_rate, double freq) {
+    size_t count = (size_t)(in_rate * TONE_SECONDS);
+    std::vector<int16_t> in(count);
+    for (size_t i = 0; i < count; i++) {
+        in[i] = (int16_t)lrint(TONE_AMPLITUDE * sin(2.0 * M_PI * freq * i / in_rate));
+    }
+    std::vector<int16_t> out(resampler_max_output(rs, count));
+    resampler_reset(rs);
+    size_t produced = resampler_process(rs, in.data(), count, out.data());
+
+    // 필터가 채워지기 전 출력은 제외
+    size_t skip = (size_t)rs->taps * rs->up / rs->down + 1;
+    double energy = 0.0;
+    for (size_t i = skip; i < produced; i++) {
+        energy += (double)out[i] * out[i];
+    }
+    double rms = sqrt(energy / (produced - skip));
+    return 20.0 * log10(std::max(rms * sqrt(2.0), 1e-3) / TONE_AMPLITUDE);
+}
+
+int main(int argc, char** argv) {
+    uint32_t in_rate = CAPTURE_RATE;
+    uint32_t out_rate = SAMPLE_RATE;
+    int taps = RESAMPLER_TAPS;
+    double pass = 0.75;
+    double max_ripple_db = 0.1;
+    double min_stop_db = 60.0;
+    bool verbose = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "i:o:t:p:r:s:v")) != -1) {
+        switch (opt) {
+            case 'i':
+                in_rate = atoi(optarg);
+                break;
+            case 'o':
+                out_rate = atoi(optarg);
+                break;
+            case 't':
+                taps = atoi(optarg);
+                break;
+            case 'p':
+                pass = atof(optarg) / 100.0;
+                break;
+            case 'r':
+                max_ripple_db = atof(optarg);
+                break;
+            case 's':
+                min_stop_db = atof(optarg);
+                break;
+            case 'v':
+                verbose = true;
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    resampler_t rs;
+    if (resampler_init(&rs, in_rate, out_rate, taps, MALLOC_CAP_INTERNAL) != ESP_OK) {
+        return 1;
+    }
+
+    double low_nyquist = std::min(in_rate, out_rate) / 2.0;
+    double pass_edge = pass * low_nyquist;
+    double in_nyquist = in_rate / 2.0;
+    double ripple = 0.0;
+    double stop = -200.0;
+    double stop_at = 0.0;
+    double step = in_nyquist / 200.0;
+
+    for (double freq = step; freq < in_nyquist; freq += step) {
+        double gain = measure_gain_db(&rs, in_rate, freq);
+        const char* band = "transition";
+        if (freq <= pass_edge) {
+            band = "pass";
+            ripple = std::max(ripple, fabs(gain));
+        } else if (freq >= out_rate / 2.0 && out_rate < in_rate) {
+            band = "alias";
+            if (gain > stop) {
+                stop = gain;
+                stop_at = freq;
+            }
+        }
+        if (verbose) {
+            printf("%8.1f Hz %8.2f dB  %s\n", freq, gain, band);
+        }
+    }
+
+    printf("%u -> %u Hz, up %u / down %u, %d taps/phase (%d MAC per output)\n", (unsigned)in_rate,
+           (unsigned)out_rate, (unsigned)rs.up, (unsigned)rs.down, taps, taps);
+    printf("passband 0..%.0f Hz ripple %.3f dB (limit %.3f)\n", pass_edge, ripple, max_ripple_db);
+    bool ok = ripple <= max_ripple_db;
+    if (out_rate < in_rate) {
+        printf("aliasing band %.0f..%.0f Hz worst %.1f dB at %.0f Hz (limit -%.0f)\n", out_rate / 2.0, in_nyquist,
+               stop, stop_at, min_stop_db);
+        ok = ok && stop <= -min_stop_db;
+    }
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    resampler_deinit(&rs);
+    return ok ? 0 : 1;
+}
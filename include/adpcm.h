@@ -0,0 +1,24 @@
+#ifndef ADPCM_H
+#define ADPCM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// IMA-ADPCM (WAV format 0x11, mono)
+#define ADPCM_BLOCK_ALIGN 512
+#define ADPCM_SAMPLES_PER_BLOCK ((ADPCM_BLOCK_ALIGN - 4) * 2 + 1)
+
+typedef struct {
+    int32_t predictor;
+    int32_t step_index;
+} adpcm_state_t;
+
+uint8_t adpcm_encode_sample(adpcm_state_t* state, int16_t sample);
+int16_t adpcm_decode_sample(adpcm_state_t* state, uint8_t nibble);
+
+// n 개 샘플(<= samples_per_block)을 한 블록으로 인코딩, 기록한 바이트 수 반환
+size_t adpcm_encode_block(adpcm_state_t* state, const int16_t* samples, int n, uint8_t* out);
+// 한 블록을 디코딩, 디코딩한 샘플 수 반환
+int adpcm_decode_block(const uint8_t* block, size_t len, int16_t* out);
+
+#endif
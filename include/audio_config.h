@@ -0,0 +1,18 @@
+#ifndef AUDIO_CONFIG_H
+#define AUDIO_CONFIG_H
+
+// 특징 추출 / 모델 / 저장 WAV 의 샘플레이트
+#define SAMPLE_RATE 22500
+// ADC 샘플링 레이트, SAMPLE_RATE 와 다르면 녹음 중 다상 FIR (resampler.h) 로 SAMPLE_RATE 로 변환
+//   esp_timer 는 us 단위라 22500 Hz (44.4 us) 는 정확히 맞출 수 없다, 25000 Hz 는 40 us
+#ifndef CAPTURE_RATE
+#define CAPTURE_RATE 25000
+#endif
+#define RECORD_TIME 6000
+#define FRAME_LENGTH 512
+#define FRAME_STEP 256
+#define NUM_MEL_FILTERS 40
+#define FFT_SIZE 512
+#define MAX_AUDIO_SIZE (SAMPLE_RATE * RECORD_TIME / 1000)
+
+#endif
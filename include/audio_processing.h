@@ -2,13 +2,26 @@
 #define AUDIO_PROCESSING_H
 
 #include "esp_err.h"
+#include "feature_extraction.h"
 
-esp_err_t feature_extractor(FILE* audio_file, float* mfcc, int n_mfcc);
-void scaler(float* features, int size, const char* scaler_path);
-void differential_mfcc(float* mfcc_features, float* delta_mfccs, float* delta2_mfccs, int size);
+typedef enum {
+    RECORD_FORMAT_PCM16,
+    RECORD_FORMAT_IMA_ADPCM,
+} record_format_t;
+
+#ifndef DEFAULT_RECORD_FORMAT
+#define DEFAULT_RECORD_FORMAT RECORD_FORMAT_PCM16
+#endif
+
+void set_record_format(record_format_t format);
+record_format_t get_record_format();
 void recordAudio();
+// RECORD_TIME 동안 메모리로 녹음, 녹음한 샘플 수 반환
+size_t record_clip(int16_t* samples, size_t max_samples);
+// 샘플 count 개를 녹음, next_sample_us 로 다음 호출과 샘플 간격을 이어 간다 (0 이면 지금부터 시작)
+size_t record_samples(int16_t* samples, size_t count, int64_t* next_sample_us);
 esp_err_t init_audio_processing();
 void cleanup_audio_processing();
 void writeWaveHeader(FILE* file, uint32_t dataSize);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,28 @@
+#ifndef BOOT_INIT_H
+#define BOOT_INIT_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// 부팅 초기화 그래프: 의존성이 끝난 단계부터 각자 태스크에서 동시에 실행
+//   deps 는 먼저 끝나야 하는 단계들의 BOOT_STEP_BIT() 조합
+#define BOOT_MAX_STEPS 12
+#define BOOT_STEP_BIT(index) (1u << (index))
+
+typedef esp_err_t (*boot_step_fn)(void);
+
+typedef struct {
+    const char* name;
+    boot_step_fn fn;
+    uint32_t deps;
+    bool required;      // 실패하면 boot_run() 이 실패를 반환
+    uint32_t stack;     // 0 이면 기본 크기
+} boot_step_t;
+
+// 모든 단계가 끝날 때까지 기다리고 단계별 시작/대기/실행 시간을 로그로 남긴다
+// 실패(필수 단계 실패 또는 시간 초과)를 반환한 뒤에는 아직 시작하지 않은 단계를 실행하지 않는다
+esp_err_t boot_run(const boot_step_t* steps, int count, uint32_t timeout_ms);
+// 전원 인가 후 boot_run() 이 끝난 시점 (us)
+int64_t boot_ready_us();
+
+#endif
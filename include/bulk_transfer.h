@@ -0,0 +1,109 @@
+#ifndef BULK_TRANSFER_H
+#define BULK_TRANSFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// 전송 계층과 무관한 대용량 전송 프레이밍 (BLE 알림, 루프백 등에서 공용)
+//
+//   START  [0x01][stream][kind][window][total_size u32][chunk_size u16]
+//   DATA   [0x02][stream][seq u16][payload ...]
+//   END    [0x03][stream][chunks u16][crc32 u32]
+//   ACK    [0x10][stream][next_seq u16]     수신측 -> 송신측, next_seq 이전까지 모두 수신
+//   NACK   [0x11][stream][next_seq u16]     next_seq 부터 재전송 요청
+//   DONE   [0x12][stream][chunks u16]       END 의 CRC 까지 확인, 전송 완료
+//   REQ    [0x20][kind][reserved u16][arg u32]  수신측 -> 송신측, 전송 요청
+//
+// 송신측은 window 개까지 ACK 없이 보내고 (go-back-N), 수신측은 window/2 마다 ACK 한다.
+#define BULK_FRAME_START 0x01
+#define BULK_FRAME_DATA 0x02
+#define BULK_FRAME_END 0x03
+#define BULK_FRAME_ACK 0x10
+#define BULK_FRAME_NACK 0x11
+#define BULK_FRAME_DONE 0x12
+#define BULK_FRAME_REQUEST 0x20
+
+#define BULK_DATA_HEADER_SIZE 4
+#define BULK_START_SIZE 10
+#define BULK_END_SIZE 8
+#define BULK_ACK_SIZE 4
+#define BULK_REQUEST_SIZE 8
+#define BULK_MAX_FRAME 512
+#define BULK_DEFAULT_WINDOW 16
+
+typedef enum {
+    BULK_KIND_AUDIO = 1,      // 현재 audio.wav
+    BULK_KIND_FEATURES = 2,   // 저장소 레코드의 특징 벡터 (arg: seq, 0xffffffff = 최신)
+    BULK_KIND_TRACE = 3,      // 마지막 파이프라인 타이밍/메모리 통계
+    BULK_KIND_RECORD = 4,     // 저장소 레코드의 WAV (arg: seq)
+} bulk_kind_t;
+
+// offset 부터 최대 len 바이트를 buf 에 채우고 읽은 바이트 수 반환
+typedef size_t (*bulk_read_fn)(void* ctx, uint32_t offset, uint8_t* buf, size_t len);
+// 프레임 전송, 0: 성공 / 그 외: 지금은 보낼 수 없음 (나중에 다시 pump)
+typedef int (*bulk_send_fn)(void* ctx, const uint8_t* frame, size_t len);
+// 수신한 payload 를 offset 위치에 기록
+typedef void (*bulk_write_fn)(void* ctx, uint32_t offset, const uint8_t* data, size_t len);
+
+typedef struct {
+    uint8_t stream;
+    uint8_t kind;
+    uint8_t window;
+    uint16_t chunk_size;
+    uint32_t total_size;
+    uint16_t total_chunks;
+    uint16_t next_seq;      // 다음에 보낼 DATA
+    uint16_t acked_seq;     // 수신 확인된 DATA 개수
+    bool start_sent;
+    bool end_sent;
+    bool done;
+    uint32_t crc;
+    uint16_t crc_seq;       // crc 에 반영된 DATA 개수
+    uint32_t frames_sent;
+    uint32_t retransmits;
+    bulk_read_fn read;
+    bulk_send_fn send;
+    void* ctx;
+} bulk_sender_t;
+
+typedef struct {
+    uint8_t stream;
+    uint8_t kind;
+    uint8_t window;
+    uint16_t chunk_size;
+    uint32_t total_size;
+    uint16_t next_seq;
+    uint16_t since_ack;
+    uint32_t crc;
+    bool started;
+    bool complete;
+    bool failed;
+    uint32_t crc_errors;
+    bulk_write_fn write;
+    void* ctx;
+} bulk_receiver_t;
+
+// 협상된 ATT MTU 에서 알림 한 개에 실을 수 있는 payload 크기
+uint16_t bulk_chunk_size(uint16_t mtu);
+uint32_t bulk_crc32(uint32_t crc, const uint8_t* data, size_t len);
+
+// seq 가 u16 이라 청크가 BULK_MAX_CHUNKS 개를 넘는 원본은 ESP_ERR_INVALID_SIZE (MTU 23 에서 약 1 MB)
+#define BULK_MAX_CHUNKS UINT16_MAX
+esp_err_t bulk_sender_init(bulk_sender_t* sender, uint8_t stream, uint8_t kind, uint32_t total_size,
+                           uint16_t chunk_size, uint8_t window, bulk_read_fn read, bulk_send_fn send, void* ctx);
+// 윈도우가 허용하는 만큼 프레임 전송, 보낸 프레임 수 반환
+int bulk_sender_pump(bulk_sender_t* sender);
+// ACK/NACK/DONE 프레임 처리
+esp_err_t bulk_sender_on_frame(bulk_sender_t* sender, const uint8_t* frame, size_t len);
+// ACK 시간 초과: 마지막 확인 지점부터 다시 전송
+void bulk_sender_on_timeout(bulk_sender_t* sender);
+
+void bulk_receiver_init(bulk_receiver_t* receiver, bulk_write_fn write, void* ctx);
+// 프레임 처리, 보낼 ACK/NACK/DONE 이 있으면 ack 에 기록하고 길이 반환 (없으면 0)
+size_t bulk_receiver_on_frame(bulk_receiver_t* receiver, const uint8_t* frame, size_t len, uint8_t* ack);
+
+size_t bulk_encode_request(uint8_t* frame, uint8_t kind, uint32_t arg);
+esp_err_t bulk_decode_request(const uint8_t* frame, size_t len, uint8_t* kind, uint32_t* arg);
+
+#endif
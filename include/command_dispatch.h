@@ -0,0 +1,16 @@
+#ifndef COMMAND_DISPATCH_H
+#define COMMAND_DISPATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "command_protocol.h"
+
+// 인코딩된 응답 프레임을 전송 계층으로 내보내는 콜백 (한 요청에 여러 번 호출될 수 있음)
+typedef void (*cmd_reply_fn)(void* ctx, uint8_t cmd, uint8_t status, const uint8_t* frame, size_t len);
+
+esp_err_t init_command_dispatch();
+// UART, BLE 가 공유하는 요청 처리 경로, 파이프라인 실행은 한 번에 하나씩 직렬화
+void command_dispatch(const cmd_frame_t* request, cmd_reply_fn reply, void* ctx);
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef COMMAND_PROTOCOL_H
+#define COMMAND_PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// UART / BLE 공용 바이너리 명령 프레임
+//   [0xA5][cmd][len u16][payload ...][crc16 u16]    crc16-CCITT(cmd, len, payload), 모두 little endian
+// 응답은 cmd | CMD_REPLY_FLAG, payload 첫 바이트가 상태 코드
+#define CMD_SYNC 0xA5
+#define CMD_HEADER_SIZE 4
+#define CMD_CRC_SIZE 2
+#define CMD_FRAME_OVERHEAD (CMD_HEADER_SIZE + CMD_CRC_SIZE)
+#define CMD_MAX_PAYLOAD 256
+#define CMD_REPLY_FLAG 0x80
+// 프레임 도중 바이트 간격이 이보다 길면 잘린 프레임으로 보고 버린다 (스트림 전송 계층이 적용)
+#define CMD_FRAME_TIMEOUT_MS 100
+
+typedef enum {
+    CMD_RECORD = 0x01,          // 녹음 후 분류              -> [status][result i8][seq u32]
+    CMD_CLASSIFY = 0x02,        // payload: 파일 이름 (없으면 audio.wav) -> [status][result i8][seq u32]
+                                //   status CMD_STATUS_STAGE1_ONLY 이면 result 는 7 (통증 아님, 2단계 생략)
+    CMD_GET_STATS = 0x03,       //                            -> [status][cmd_stats_t]
+    CMD_STREAM_RESULTS = 0x04,  // payload: [from_seq u32][max_count u16]
+                                //   레코드마다 [CMD_STATUS_MORE][seq u32][result i8][timestamp_us i64]
+                                //   마지막에  [CMD_STATUS_OK][count u16]
+    CMD_RECORD_STREAM = 0x05,   // payload: [clips u16], 녹음과 처리를 겹쳐 연속 분류
+                                //   클립마다 [CMD_STATUS_MORE][clip u32][result i8][seq u32][latency_ms u32]
+                                //   마지막에  [CMD_STATUS_OK][sched_stats_t]
+    CMD_GET_SCHED_STATS = 0x06, //                            -> [status][sched_stats_t]
+    CMD_CONTINUOUS = 0x07,      // payload: [interval_ms u16][count u16], 이동 창으로 count 번 연속 분류
+                                //   결과마다 [CMD_STATUS_MORE][index u32][result i8][window_end_ms u32]
+                                //             [dsp_us u32][classify_us u32]
+                                //   마지막에  [CMD_STATUS_OK][continuous_stats_t]
+    CMD_GET_METRICS = 0x08,     //                            -> [status][metrics_encode() 스냅샷]
+                                // payload: [hist u8]         -> [status][hist u8][bucket u32 x METRICS_HIST_BUCKETS]
+} cmd_id_t;
+
+typedef enum {
+    CMD_STATUS_OK = 0x00,
+    CMD_STATUS_PENDING = 0x01,  // 처리 시작, 최종 응답이 뒤따름
+    CMD_STATUS_MORE = 0x02,     // 여러 응답 중 하나
+    CMD_STATUS_STAGE1_ONLY = 0x03,  // 요청 예산이 모자라 1단계 결과만으로 응답
+    CMD_STATUS_UNKNOWN = 0x80,
+    CMD_STATUS_BAD_ARG = 0x81,
+    CMD_STATUS_FAILED = 0x82,
+} cmd_status_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t runs;
+    uint32_t last_total_us;
+    uint32_t feature_us[2];
+    uint32_t invoke_us[2];
+    uint32_t internal_peak;     // 마지막 요청의 아레나 high-water
+    uint32_t psram_peak;
+    uint32_t store_oldest_seq;
+    uint32_t store_next_seq;
+} cmd_stats_t;
+
+typedef struct {
+    uint8_t cmd;
+    uint16_t len;
+    const uint8_t* payload;
+} cmd_frame_t;
+
+// 동기 바이트부터 받은 바이트를 그대로 모아 두고, 길이나 CRC 가 틀리면 그 안에서 다음 0xA5 부터 다시 해석한다
+// (잘린 프레임 뒤에 이어진 프레임을 본문으로 삼켜도 잃지 않는다)
+typedef struct {
+    uint8_t raw[CMD_MAX_PAYLOAD + CMD_FRAME_OVERHEAD];
+    uint16_t count;
+    uint16_t consumed;      // 마지막으로 돌려준 프레임 길이, 다음 호출 때 버린다
+    uint32_t crc_errors;
+} cmd_parser_t;
+
+uint16_t cmd_crc16(uint16_t crc, const uint8_t* data, size_t len);
+
+// 프레임을 out 에 기록하고 길이 반환 (cap 부족 시 0)
+size_t cmd_encode(uint8_t* out, size_t cap, uint8_t cmd, const uint8_t* payload, size_t len);
+size_t cmd_encode_reply(uint8_t* out, size_t cap, uint8_t cmd, uint8_t status, const void* data, size_t len);
+
+// 한 번에 chunk 바이트까지만 보낼 수 있는 채널(BLE 알림 = ATT MTU - 3)에서 프레임을 순서대로 나눠 보낸다
+//   수신측은 조각을 이어 cmd_parser_push() 에 넣으면 되고 길이 필드가 프레임 경계를 알려 준다
+// send 는 0: 성공, 그 외 값은 그대로 반환하고 중단
+typedef int (*cmd_send_fn)(void* ctx, const uint8_t* data, size_t len);
+int cmd_send_fragmented(const uint8_t* frame, size_t len, size_t chunk, cmd_send_fn send, void* ctx);
+
+// RECORD / CLASSIFY 의 최종 결과 응답인지 (합류한 연결과 결과 구독자에게도 전달한다)
+bool cmd_status_is_result(uint8_t status);
+// 텍스트 'r' 응답으로 보낼 결과 코드, 기존 클라이언트가 모르는 1단계만의 결과는 CMD_LEGACY_NO_CLASS 로 거절
+#define CMD_LEGACY_NO_CLASS 6
+int cmd_legacy_result(uint8_t status, const uint8_t* frame, size_t len);
+
+void cmd_parser_reset(cmd_parser_t* parser);
+// 프레임 경계 밖(동기 바이트 대기 중)인지
+bool cmd_parser_idle(const cmd_parser_t* parser);
+// 한 바이트 입력, 완전한 프레임이 모이면 true (frame->payload 는 다음 push / poll 전까지 유효)
+bool cmd_parser_push(cmd_parser_t* parser, uint8_t byte, cmd_frame_t* frame);
+// 다시 해석하다 남은 바이트에 이미 완전한 프레임이 있으면 꺼낸다, push 가 true 를 돌려준 뒤 false 까지 반복
+bool cmd_parser_poll(cmd_parser_t* parser, cmd_frame_t* frame);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef CONTINUOUS_MODE_H
+#define CONTINUOUS_MODE_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "audio_config.h"
+
+// 연속 분류: 녹음을 멈추지 않고 hop 단위로 프레임 특징을 누적해
+// 최근 CONTINUOUS_WINDOW_MS 창에 대해 interval 마다 두 단계 모델을 실행한다
+//   capture --(청크 큐)--> rolling_push() --(interval 마다)--> rolling_clip_features() -> 추론
+#ifndef CONTINUOUS_WINDOW_MS
+#define CONTINUOUS_WINDOW_MS RECORD_TIME
+#endif
+#ifndef CONTINUOUS_CHUNKS
+#define CONTINUOUS_CHUNKS 16
+#endif
+#define CONTINUOUS_CHUNK_SAMPLES (8 * FRAME_STEP)
+#define CONTINUOUS_DEFAULT_INTERVAL_MS 1000
+
+typedef struct {
+    uint32_t index;
+    int8_t result;          // 응답 코드, -1: 실패
+    uint32_t window_end_ms; // 시작 후 창 끝 시점 (녹음 시간 기준)
+    uint32_t dsp_us;        // 직전 결과 이후 새 프레임 DSP 시간 합
+    uint32_t classify_us;   // 창 특징 + 추론
+} continuous_result_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t classifications;
+    uint32_t frames;
+    uint32_t overruns;          // 처리가 밀려 버린 청크 (창을 다시 채운다)
+    uint32_t frame_dsp_us;      // 프레임당 평균 DSP
+    uint32_t classify_us;       // 분류당 평균 (특징 + 추론)
+} continuous_stats_t;
+
+typedef void (*continuous_result_fn)(void* ctx, const continuous_result_t* result);
+
+esp_err_t init_continuous();
+bool continuous_ready();
+// count 번 분류할 때까지 연속 녹음, 결과마다 on_result 호출 후 녹음을 멈추고 반환 (호출자가 직렬화)
+esp_err_t continuous_run(uint16_t interval_ms, uint16_t count, continuous_result_fn on_result, void* ctx);
+void continuous_get_stats(continuous_stats_t* stats);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef DATA_PATHS_H
+#define DATA_PATHS_H
+
+#include <stddef.h>
+
+#define DEFAULT_DATA_ROOT "/sdcard"
+#define DATA_PATH_MAX 128
+
+#define AUDIO_FILE_NAME "audio.wav"
+#define FIRST_MODEL_FILE_NAME "converted_first_model.tflite"
+#define SECOND_MODEL_FILE_NAME "converted_second_model.tflite"
+#define FIRST_SCALER_FILE_NAME "first_model_scaler.pkl"
+#define SECOND_SCALER_FILE_NAME "second_model_scaler.pkl"
+#define SPECTROGRAM_MODEL_FILE_NAME "spectrogram_model.tflite"
+#define SPECTROGRAM_SCALER_FILE_NAME "spectrogram_model_scaler.pkl"
+
+// 모델/스케일러/녹음 파일이 위치한 루트 디렉터리 (기본값: SD 카드 마운트 지점)
+void set_data_root(const char* root);
+const char* get_data_root();
+// root + "/" + name 을 buf 에 기록하고 buf 를 반환
+const char* data_path(char* buf, size_t len, const char* name);
+
+#endif
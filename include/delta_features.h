@@ -0,0 +1,65 @@
+#ifndef DELTA_FEATURES_H
+#define DELTA_FEATURES_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "audio_config.h"
+#include "feature_extraction.h"
+#include "mem_arena.h"
+
+// 시간축 delta / delta2: 프레임마다 로그 멜의 회귀 미분 (librosa.feature.delta 와 같은 Savitzky-Golay 계수)
+//   delta  d1[t] = sum_n n * x[t + n] / sum_n n^2                        (n = -half..half)
+//   delta2 d2[t] = 2 * sum_n (n^2 - c) * x[t + n] / sum_n (n^2 - c)^2,   c = sum_n n^2 / width
+// librosa 의 기본 mode='interp' 대신 클립 가장자리는 끝 프레임 복제 (스트리밍에서 미래 프레임 없이 확정 가능)
+// 클립 통계는 DCT(n_mfcc) 를 적용한 MFCC 영역 delta / delta2 의 프레임 간 표준편차
+//   DCT 가 선형이므로 로그 멜 영역의 합과 곱의 합만 누적하면 40 / 80 계수 모두 같은 누적에서 얻는다
+// 0: 예전 계수축 차분 (differential_mfcc), 지금 배포된 모델 / 스케일러가 학습된 특징
+// 1: 시간축 delta, 그 특징으로 다시 학습한 모델과 스케일러를 함께 배포할 때만 켠다
+#ifndef TEMPORAL_DELTAS
+#define TEMPORAL_DELTAS 0
+#endif
+#ifndef DELTA_WIDTH
+#define DELTA_WIDTH 9
+#endif
+#define DELTA_MAX_WIDTH 15
+// 위 삼각 (i <= j) 원소 수
+#define DELTA_CROSS_SIZE (NUM_MEL_FILTERS * (NUM_MEL_FILTERS + 1) / 2)
+
+typedef struct {
+    int width;                  // 홀수, 3..DELTA_MAX_WIDTH
+    int half;
+    float w1[DELTA_MAX_WIDTH];  // 오프셋 n 의 계수는 [n + half]
+    float w2[DELTA_MAX_WIDTH];
+} delta_kernel_t;
+
+// 프레임별 delta 의 합과 곱의 합 (로그 멜 영역), 부호를 바꿔 더하면 창에서 뺄 수 있다
+typedef struct {
+    float sum[2][NUM_MEL_FILTERS];
+    float cross[2][DELTA_CROSS_SIZE];
+    int32_t count;
+} delta_stats_t;
+
+// 한 번 훑은 클립의 요약: 프레임 평균 로그 멜 + delta 통계
+typedef struct {
+    float mean[NUM_MEL_FILTERS];
+    delta_stats_t deltas;
+} clip_logmel_t;
+
+esp_err_t delta_kernel_init(delta_kernel_t* kernel, int width);
+// frames[i] 는 중심 프레임 기준 오프셋 i - half 의 로그 멜 (가장자리 복제는 호출자가 같은 포인터로)
+void delta_frame(const delta_kernel_t* kernel, const float* const* frames, float* d1, float* d2);
+
+void delta_stats_reset(delta_stats_t* stats);
+// sign: +1 추가, -1 제거
+void delta_stats_update(delta_stats_t* stats, const float* d1, const float* d2, float sign);
+// n_mfcc 계수의 delta / delta2 표준편차 (n_mfcc 는 NUM_MEL_FILTERS..MAX_MFCC)
+esp_err_t delta_stats_std(const delta_stats_t* stats, int n_mfcc, feature_slice_t delta, feature_slice_t delta2);
+
+// 클립을 한 번 훑어 요약 (extract_mfcc() 와 같은 프레임 구간), scratch: 프레임 버퍼와 width 프레임 링
+// cancel: extract_mfcc() 와 같다
+esp_err_t scan_clip_logmel(const int16_t* audio_data, size_t audio_size, clip_logmel_t* out,
+                           mem_arena_t* scratch = NULL, const bool* cancel = NULL);
+// 클립 요약에서 [mfcc 평균 | delta 표준편차 | delta2 표준편차] 를 view 에 기록
+esp_err_t clip_logmel_features(const clip_logmel_t* clip, const feature_view_t* view);
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef FEATURE_EXTRACTION_H
+#define FEATURE_EXTRACTION_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "mem_arena.h"
+
+// 모델 입력 텐서 위의 특징 블록 (stride: 연속 원소 사이 간격, float 단위)
+typedef struct {
+    float* data;
+    int stride;
+} feature_slice_t;
+
+// mfcc / delta / delta2 블록이 각각 쓰일 위치
+typedef struct {
+    feature_slice_t mfcc;
+    feature_slice_t delta;
+    feature_slice_t delta2;
+    int n_mfcc;
+} feature_view_t;
+
+// [mfcc | delta | delta2] 순서로 연속 배치된 뷰
+feature_view_t make_feature_view(float* base, int n_mfcc);
+
+esp_err_t init_feature_extraction();
+void cleanup_feature_extraction();
+
+// WAV 파일(16-bit PCM)에서 프레임 평균 MFCC 추출
+esp_err_t feature_extractor(FILE* audio_file, feature_slice_t mfcc, int n_mfcc);
+// 메모리상의 PCM 샘플에서 프레임 평균 MFCC 추출 (scratch: 프레임 버퍼용 아레나, 기본은 내부 RAM 요청 아레나)
+// cancel: 다른 태스크가 true 로 바꾸면 다음 프레임 전에 ESP_ERR_INVALID_STATE 로 중단
+esp_err_t extract_mfcc(const int16_t* audio_data, size_t audio_size, feature_slice_t mfcc, int n_mfcc,
+                       mem_arena_t* scratch = NULL, const bool* cancel = NULL);
+// mel_energies 는 DCT 작업 공간까지 MFCC_BUFFER_SIZE 개
+#define MAX_MFCC 80
+#define MFCC_BUFFER_SIZE (2 * MAX_MFCC)
+
+// 한 프레임(FRAME_LENGTH 샘플)의 MFCC 계산, 결과는 mel_energies[0..n_mfcc)
+void mfcc_frame(const int16_t* samples, float* frame_real, float* frame_imag, float* mel_energies, int n_mfcc);
+// mfcc_frame 의 앞부분: 로그 멜 에너지 NUM_MEL_FILTERS 개
+void logmel_frame(const int16_t* samples, float* frame_real, float* frame_imag, float* mel_energies);
+// 로그 멜 에너지 -> MFCC (DCT 는 선형이므로 프레임 평균 로그 멜에 적용해도 MFCC 평균과 같다)
+void mfcc_from_logmel(float* mel_energies, int n_mfcc);
+
+// 프레임 하나(logmel_frame)의 평균 처리 시간, 배치 정책 전후 비교용
+typedef struct {
+    int64_t before_ns;  // 이전 구현 (밀집 필터뱅크), 표와 버퍼 모두 PSRAM
+    int64_t cold_ns;    // 현재 커널, 표와 버퍼 모두 PSRAM
+    int64_t after_ns;   // 현재 커널, mem_placement 배치 (표 MEM_DSP_TABLES, 버퍼 MEM_FRAME_SCRATCH)
+} placement_bench_t;
+
+esp_err_t benchmark_frame_placement(int frames, placement_bench_t* out);
+
+// 2D 로그 멜 스펙트로그램 (합성곱 모델 입력), 텐서는 [frames][bins] 행 우선 (NHWC, C = 1)
+//   프레임 i 는 샘플 i * hop 에서 시작, 오디오가 모자라 못 만든 뒤쪽 프레임은 pad 방식으로 채운다
+typedef enum {
+    SPEC_PAD_ZERO,      // 정규화 후 0 (= 평균값)
+    SPEC_PAD_EDGE,      // 마지막 유효 프레임 반복
+} spec_pad_t;
+
+typedef struct {
+    int frames;
+    int bins;           // NUM_MEL_FILTERS 만 지원
+    int hop;
+    spec_pad_t pad;
+    float mean;         // (v - mean) / std 로 정규화
+    float std;
+} spectrogram_config_t;
+
+// 출력 위치: f32 가 있으면 float, 아니면 i8 에 q = round(v / scale) + zero_point 로 양자화
+typedef struct {
+    float* f32;
+    int8_t* i8;
+    float scale;
+    int32_t zero_point;
+} tensor_sink_t;
+
+// 클립 전체를 덮도록 hop 을 정한 기본 설정
+spectrogram_config_t default_spectrogram_config(int frames, int bins, size_t audio_size);
+esp_err_t extract_spectrogram(const int16_t* audio_data, size_t audio_size, const spectrogram_config_t* config,
+                              tensor_sink_t sink, mem_arena_t* scratch = NULL);
+// WAV 파일 전체(최대 max 샘플)를 16-bit 로 읽는다
+esp_err_t read_wav_clip(FILE* audio_file, int16_t* audio_data, size_t max, size_t* count);
+
+void apply_mel_filterbank(float* spectrum, float* mel_energies, float* fbank, int n_filters, int n_fft);
+esp_err_t load_scaler(const char* scaler_path, float* mean, float* std);
+void apply_scaler(feature_slice_t features, int size, float mean, float std);
+void scaler(float* features, int size, const char* scaler_path);
+// 계수 축 1차/2차 차분, 첫 원소는 0 (TEMPORAL_DELTAS=0 의 예전 특징, 시간축 delta 는 delta_features.h)
+void differential_mfcc(feature_slice_t mfcc_features, feature_slice_t delta_mfccs, feature_slice_t delta2_mfccs, int size);
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef FEATURE_PIPELINE_H
+#define FEATURE_PIPELINE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "audio_config.h"
+#include "data_paths.h"
+#include "feature_extraction.h"
+#include "delta_features.h"
+#include "rolling_features.h"
+#include "mem_arena.h"
+
+// 캐스케이드 모델 한 단계의 입력 [mfcc | delta | delta2] 을 만드는 파이프라인
+// 계수 수, 스케일링 순서, 스케일러 파일은 Spec 으로 컴파일 시간에 고정하고 모델마다 한 번 인스턴스화한다
+//   struct Spec {
+//       static constexpr int n_mfcc;               // NUM_MEL_FILTERS..MAX_MFCC
+//       static constexpr scale_order_t order;
+//       static constexpr const char* scaler;       // data_path() 기준 파일 이름
+//   };
+// 버퍼는 출력(보통 모델 입력 텐서)과 요청 아레나만 사용하고, 스케일러는 Spec 마다 한 번만 읽는다
+#define FEATURE_BLOCKS 3
+
+typedef enum {
+    // MFCC 만 스케일, delta 는 std 로만 나눈다 (예전 특징은 스케일된 MFCC 에서 차분)
+    SCALE_BEFORE_DELTAS,
+    // (예전 특징은 차분 후) 세 블록 모두 같은 mean / std 로 스케일
+    SCALE_AFTER_DELTAS,
+} scale_order_t;
+
+template <typename Spec>
+class FeaturePipeline {
+public:
+    static constexpr int kMfcc = Spec::n_mfcc;
+    static constexpr int kFeatures = FEATURE_BLOCKS * kMfcc;
+    static_assert(kMfcc >= NUM_MEL_FILTERS && kMfcc <= MAX_MFCC, "n_mfcc out of range");
+
+    // 스케일러를 SD 에서 읽어 둔다 (preload_models() 에서, 부르지 않으면 첫 요청이 읽는다)
+    static void load_scaler_once() { (void)scaler(); }
+
+    // 스케일링 전 블록이 채워진 out 을 모델 입력으로 마무리
+    static void finish(float* out) {
+        const scaler_t& s = scaler();
+
+        if constexpr (Spec::order == SCALE_BEFORE_DELTAS) {
+            if (s.scaled) {
+                scale<kMfcc>(out, s.mean, s.std);
+            }
+#if TEMPORAL_DELTAS
+            // 스케일된 MFCC 의 시간 미분에 해당하도록 delta 는 std 로만 나눈다
+            if (s.scaled) {
+                scale<2 * kMfcc>(out + kMfcc, 0.0f, s.std);
+            }
+#else
+            derive_deltas(out);
+#endif
+        } else {
+#if !TEMPORAL_DELTAS
+            derive_deltas(out);
+#endif
+            if (s.scaled) {
+                scale<kFeatures>(out, s.mean, s.std);
+            }
+        }
+    }
+
+    // 한 번 훑은 클립 요약에서 (여러 단계가 같은 요약을 공유)
+    static esp_err_t from_clip(const clip_logmel_t* clip, float* out) {
+        feature_view_t view = make_feature_view(out, kMfcc);
+        esp_err_t ret = clip_logmel_features(clip, &view);
+        if (ret == ESP_OK) {
+            finish(out);
+        }
+        return ret;
+    }
+
+    // 메모리상의 PCM 클립에서, scratch: 프레임 버퍼와 클립 요약
+    // cancel: true 가 되면 프레임 사이에서 ESP_ERR_INVALID_STATE 로 중단 (추측 실행 취소)
+    static esp_err_t from_samples(const int16_t* samples, size_t count, float* out, mem_arena_t* scratch,
+                                  const bool* cancel = NULL) {
+#if TEMPORAL_DELTAS
+        ArenaBuffer<clip_logmel_t> clip(scratch, 1);
+        if (!clip) {
+            return ESP_ERR_NO_MEM;
+        }
+        esp_err_t ret = scan_clip_logmel(samples, count, clip.get(), scratch, cancel);
+        return ret == ESP_OK ? from_clip(clip.get(), out) : ret;
+#else
+        esp_err_t ret = extract_mfcc(samples, count, {out, 1}, kMfcc, scratch, cancel);
+        if (ret == ESP_OK) {
+            finish(out);
+        }
+        return ret;
+#endif
+    }
+
+    // WAV 파일 앞쪽 max_samples 에서 (클립은 PSRAM 요청 아레나에 읽는다)
+    static esp_err_t from_file(FILE* audio_file, float* out, size_t max_samples = MAX_AUDIO_SIZE) {
+        ArenaBuffer<int16_t> audio_data(psram_arena(), max_samples);
+        if (!audio_data) {
+            return ESP_ERR_NO_MEM;
+        }
+        size_t count;
+        esp_err_t ret = read_wav_clip(audio_file, audio_data.get(), max_samples, &count);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+#if TEMPORAL_DELTAS
+        ArenaBuffer<clip_logmel_t> clip(psram_arena(), 1);
+        if (!clip) {
+            return ESP_ERR_NO_MEM;
+        }
+        ret = scan_clip_logmel(audio_data.get(), count, clip.get());
+        return ret == ESP_OK ? from_clip(clip.get(), out) : ret;
+#else
+        ret = extract_mfcc(audio_data.get(), count, {out, 1}, kMfcc);
+        if (ret == ESP_OK) {
+            finish(out);
+        }
+        return ret;
+#endif
+    }
+
+    // 연속 모드 이동 창에서
+    static esp_err_t from_rolling(rolling_features_t* rolling, float* out) {
+        esp_err_t ret = rolling_mfcc(rolling, {out, 1}, kMfcc);
+#if TEMPORAL_DELTAS
+        if (ret == ESP_OK) {
+            ret = rolling_deltas(rolling, kMfcc, {out + kMfcc, 1}, {out + 2 * kMfcc, 1});
+        }
+#endif
+        if (ret == ESP_OK) {
+            finish(out);
+        }
+        return ret;
+    }
+
+private:
+    typedef struct {
+        bool scaled;
+        float mean;
+        float std;
+    } scaler_t;
+
+    // 처음 부른 태스크가 읽고 나머지는 초기화가 끝날 때까지 기다린다 (함수 지역 static)
+    static const scaler_t& scaler() {
+        static const scaler_t cached = [] {
+            scaler_t s = {false, 0.0f, 1.0f};
+            char scaler_path[DATA_PATH_MAX];
+            s.scaled = load_scaler(data_path(scaler_path, sizeof(scaler_path), Spec::scaler), &s.mean, &s.std) ==
+                       ESP_OK;
+            return s;
+        }();
+        return cached;
+    }
+
+#if !TEMPORAL_DELTAS
+    // 예전 특징: MFCC 블록에서 delta / delta2 블록을 계수 축 차분으로
+    static void derive_deltas(float* out) {
+        float* mfcc = out;
+        float* delta = out + kMfcc;
+        float* delta2 = out + 2 * kMfcc;
+        differential_mfcc({mfcc, 1}, {delta, 1}, {delta2, 1}, kMfcc);
+    }
+#endif
+
+    // apply_scaler() 와 같은 식, 길이가 상수라 펼칠 수 있다
+    template <int N>
+    static void scale(float* values, float mean, float std) {
+        for (int i = 0; i < N; i++) {
+            values[i] = (values[i] - mean) / std;
+        }
+    }
+};
+
+#endif
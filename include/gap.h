@@ -8,7 +8,31 @@
 #define BLE_GAP_URI_PREFIX_HTTPS 0x17
 #define BLE_GAP_LE_ROLE_PERIPHERAL 0x00
 
+// 최근 분류 결과를 광고의 제조사 데이터로 방송 (연결 없이 여러 수신기가 읽는다)
+//   결과가 생기면 광고 = flags + 제조사 데이터 + 이름, 서비스 UUID 는 스캔 응답으로 옮긴다
+//   갱신 직후 ADV_BURST_MS 동안은 ADV_BURST_ITVL_MS 간격, 이후 평소 간격(500 ms)
+//   기본은 꺼져 있고, 켜려면 할당받은 ID 도 지정 (-DADV_RESULT_BROADCAST=1 -DADV_COMPANY_ID=0x....)
+#ifndef ADV_RESULT_BROADCAST
+#define ADV_RESULT_BROADCAST 0
+#endif
+#ifndef ADV_COMPANY_ID
+#define ADV_COMPANY_ID 0xFFFF       // Bluetooth SIG 테스트용 ID, 방송이 꺼져 있을 때만 허용
+#define ADV_COMPANY_ID_UNSET 1
+#endif
+#define ADV_BURST_MS 3000
+#define ADV_BURST_ITVL_MS 100
+
+// 제조사 데이터 (little endian, 11 바이트: flags 3 + 제조사 13 + 이름 15 = 31)
+typedef struct __attribute__((packed)) {
+    uint16_t company_id;
+    int8_t result;
+    uint32_t seq;           // 저장소 레코드 번호, 저장하지 않았으면 0xffffffff
+    uint32_t timestamp_ms;  // 분류 완료 시각 (부팅 후 ms), 수신기의 중복 판단용
+} adv_result_t;
+
 void adv_init(void);
 int gap_init(void);
+// 결과 광고 갱신 후 빠른 간격으로 잠시 광고 (어느 태스크에서나 호출 가능, 광고 재시작은 NimBLE 호스트 태스크에서)
+void adv_publish_result(int8_t result, uint32_t seq, int64_t done_us);
 
 #endif
\ No newline at end of file
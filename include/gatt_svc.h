@@ -7,6 +7,8 @@
 
 void gatt_svr_register_cb(struct ble_gatt_register_ctxt *ctxt, void *arg);
 void gatt_svr_subscribe_cb(struct ble_gap_event *event);
+void gatt_svr_disconnect_cb(uint16_t conn_handle);
+void gatt_svr_notify_tx_cb(struct ble_gap_event *event);
 int gatt_svc_init(void);
 
 #endif
\ No newline at end of file
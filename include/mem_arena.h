@@ -0,0 +1,78 @@
+#ifndef MEM_ARENA_H
+#define MEM_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// 요청 하나가 사용하는 버퍼를 위한 bump allocator
+#ifndef INTERNAL_ARENA_SIZE
+#define INTERNAL_ARENA_SIZE (16 * 1024)
+#endif
+#ifndef PSRAM_ARENA_SIZE
+#define PSRAM_ARENA_SIZE (1536 * 1024)
+#endif
+#define MEM_ARENA_ALIGN 16
+
+typedef struct {
+    const char* name;
+    uint8_t* base;
+    size_t size;
+    size_t used;
+    size_t peak;                // 생성 후 최대 사용량
+    size_t request_peak;        // 마지막 reset 이후 최대 사용량
+    size_t last_request_peak;   // 직전 reset 까지의 request_peak (끝난 요청 하나의 high-water)
+    uint32_t caps;
+} mem_arena_t;
+
+esp_err_t mem_arena_init(mem_arena_t* arena, const char* name, size_t size, uint32_t caps);
+void mem_arena_deinit(mem_arena_t* arena);
+void* mem_arena_alloc(mem_arena_t* arena, size_t size, size_t align = MEM_ARENA_ALIGN);
+void mem_arena_rewind(mem_arena_t* arena, size_t mark);
+void mem_arena_reset(mem_arena_t* arena);
+
+// 내부 RAM / PSRAM 요청 아레나, pipeline() 이 끝날 때 reset
+esp_err_t init_request_arenas();
+void cleanup_request_arenas();
+// 현재 스레드(태스크)가 쓸 요청 아레나를 지정, NULL 이면 전역 아레나로 되돌린다
+void bind_request_arenas(mem_arena_t* internal, mem_arena_t* psram);
+mem_arena_t* internal_arena();
+mem_arena_t* psram_arena();
+void reset_request_arenas();
+
+// 아레나에서 count 개의 T 를 할당, 가장 마지막 할당이면 소멸 시 반환
+template <typename T>
+class ArenaBuffer {
+public:
+    ArenaBuffer(mem_arena_t* arena, size_t count, bool zero = false) : arena_(arena) {
+        mark_ = arena->used;
+        ptr_ = (T*)mem_arena_alloc(arena, count * sizeof(T));
+        end_ = arena->used;
+        if (ptr_ && zero) {
+            for (size_t i = 0; i < count; i++) {
+                ptr_[i] = T();
+            }
+        }
+    }
+
+    ~ArenaBuffer() {
+        if (ptr_ && arena_->used == end_) {
+            mem_arena_rewind(arena_, mark_);
+        }
+    }
+
+    ArenaBuffer(const ArenaBuffer&) = delete;
+    ArenaBuffer& operator=(const ArenaBuffer&) = delete;
+
+    T* get() const { return ptr_; }
+    T& operator[](size_t i) const { return ptr_[i]; }
+    explicit operator bool() const { return ptr_ != nullptr; }
+
+private:
+    mem_arena_t* arena_;
+    T* ptr_;
+    size_t mark_;
+    size_t end_;
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef MEM_PLACEMENT_H
+#define MEM_PLACEMENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+
+// 버퍼 종류별 메모리 배치: 프레임마다 반복해서 읽는 작은 작업 집합은 내부 DRAM (HOT),
+// 한 번 훑고 지나가는 큰 데이터(오디오, 모델 가중치)는 PSRAM (COLD)
+// HOT 이라도 내부 RAM 이 MEM_INTERNAL_RESERVE 아래로 떨어질 만큼이면 PSRAM 으로 폴백
+typedef enum {
+    MEM_HOT,
+    MEM_COLD,
+} mem_tier_t;
+
+typedef enum {
+    MEM_DSP_TABLES,     // 창, 희소 멜 필터뱅크
+    MEM_FRAME_SCRATCH,  // 요청 / 특징 / 연속 모드 scratch 아레나 (프레임 버퍼, delta 링)
+    MEM_RESAMPLER,      // 다상 계수와 이력
+    MEM_REQUEST_BULK,   // PSRAM 요청 아레나 (클립 샘플, tensor arena, 캐시 안 된 모델)
+    MEM_MODEL,          // 미리 읽은 모델 flatbuffer
+    MEM_AUDIO,          // 녹음 / 스케줄러 / 연속 모드 클립 버퍼, 로그 멜 링
+    MEM_REGION_COUNT
+} mem_region_t;
+
+// 빌드 시 기본 배치, -DMEM_PLACE_DSP_TABLES=MEM_COLD 처럼 바꿀 수 있다
+#ifndef MEM_PLACE_DSP_TABLES
+#define MEM_PLACE_DSP_TABLES MEM_HOT
+#endif
+#ifndef MEM_PLACE_FRAME_SCRATCH
+#define MEM_PLACE_FRAME_SCRATCH MEM_HOT
+#endif
+#ifndef MEM_PLACE_RESAMPLER
+#define MEM_PLACE_RESAMPLER MEM_HOT
+#endif
+#ifndef MEM_PLACE_REQUEST_BULK
+#define MEM_PLACE_REQUEST_BULK MEM_COLD
+#endif
+#ifndef MEM_PLACE_MODEL
+#define MEM_PLACE_MODEL MEM_COLD
+#endif
+#ifndef MEM_PLACE_AUDIO
+#define MEM_PLACE_AUDIO MEM_COLD
+#endif
+// BLE 스택 / 태스크 생성용으로 남겨 둘 내부 RAM
+#ifndef MEM_INTERNAL_RESERVE
+#define MEM_INTERNAL_RESERVE (48 * 1024)
+#endif
+
+// 부팅 후 logmel 프레임 처리 시간을 배치 전후로 측정해 로그 (benchmark_frame_placement)
+#ifndef FEATURE_PLACEMENT_BENCH
+#define FEATURE_PLACEMENT_BENCH 0
+#endif
+
+#define MEM_CAPS_HOT (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#define MEM_CAPS_COLD MALLOC_CAP_SPIRAM
+
+// 이후 할당부터 적용 (이미 잡힌 버퍼는 옮기지 않는다)
+void mem_place_set(mem_region_t region, mem_tier_t tier);
+mem_tier_t mem_place_tier(mem_region_t region);
+// size 바이트를 놓을 caps 를 정하고 기록 (caps 를 받는 mem_arena_init / resampler_init 등에 넘긴다)
+uint32_t mem_place_caps(mem_region_t region, size_t size);
+// 배치 정책대로 할당, HOT 할당이 실패하면 PSRAM 으로 한 번 더 시도
+void* mem_place_alloc(mem_region_t region, size_t size, size_t align = 16, bool zero = false);
+// 영역별 요청 배치 / 실제 내부 RAM, PSRAM 바이트 / 폴백 횟수 로그
+void mem_place_report();
+
+#endif
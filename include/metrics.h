@@ -0,0 +1,85 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// 현장 장치 상태용 메트릭 레지스트리: 카운터, 게이지, 단계별 지연 히스토그램
+// 갱신은 모두 원자적 연산만 사용하므로 어느 태스크 / 콜백에서나 락 없이 호출할 수 있다
+//
+// 히스토그램 버킷 i 는 [2^i, 2^(i+1)) us (버킷 0 은 0..1 us), 마지막 버킷은 그 이상 전부
+#define METRICS_VERSION 1
+#define METRICS_HIST_BUCKETS 24
+#define METRICS_MAX_TASKS 11
+
+typedef enum {
+    METRIC_CLASSIFICATIONS,
+    METRIC_FAILURES,            // 결과 -1 / 6
+    METRIC_COMMANDS,
+    METRIC_CMD_CRC_ERRORS,
+    METRIC_NOTIFY_FAILURES,
+    METRIC_CLIPS_DROPPED,       // 스케줄러 drop-oldest + 연속 모드 overrun
+    METRIC_COALESCED,           // 진행 중인 분류에 합류한 BLE 요청
+    METRIC_DEGRADE_SKIP_STORE,  // 예산 부족으로 낮춘 품질 (request_budget.h 의 순서)
+    METRIC_DEGRADE_SHORT_AUDIO,
+    METRIC_DEGRADE_STAGE1_ONLY,
+    METRIC_DEADLINE_MISSED,     // 품질을 낮추고도 마감을 넘긴 요청
+    METRIC_COUNTER_COUNT
+} metric_counter_t;
+
+typedef enum {
+    METRIC_FREE_INTERNAL,
+    METRIC_FREE_PSRAM,
+    METRIC_LARGEST_INTERNAL,
+    METRIC_MIN_FREE_INTERNAL,
+    METRIC_INTERNAL_ARENA_PEAK,
+    METRIC_PSRAM_ARENA_PEAK,
+    METRIC_PM_MAX_FREQ_MS,      // 부팅 후 최대 클럭으로 보낸 시간 (power_mgmt.h)
+    METRIC_PM_LOW_MS,           // 그 밖의 시간 (낮은 클럭 + light sleep)
+    METRIC_STACK_FIRST,         // 이후 metrics_refresh_system() 이 감시하는 태스크 순서대로 남은 스택 (bytes)
+    METRIC_GAUGE_COUNT = METRIC_STACK_FIRST + METRICS_MAX_TASKS
+} metric_gauge_t;
+
+typedef enum {
+    METRIC_HIST_RECORD,
+    METRIC_HIST_FEATURES,
+    METRIC_HIST_MODEL_LOAD,
+    METRIC_HIST_INVOKE1,
+    METRIC_HIST_INVOKE2,
+    METRIC_HIST_PIPELINE,
+    METRIC_HIST_FRAME_DSP,      // 연속 모드 청크당 DSP
+    METRIC_HIST_COUNT
+} metric_hist_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t count;
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} metric_hist_summary_t;
+
+// metrics_encode() 의 형식 (little endian)
+//   [version u8][counters u8][gauges u8][hists u8][uptime_ms u32]
+//   [counter u32 x counters][gauge u32 x gauges][metric_hist_summary_t x hists]
+#define METRICS_HEADER_SIZE 8
+#define METRICS_ENCODED_SIZE (METRICS_HEADER_SIZE + 4 * METRIC_COUNTER_COUNT + 4 * METRIC_GAUGE_COUNT + \
+                              sizeof(metric_hist_summary_t) * METRIC_HIST_COUNT)
+
+void metrics_add(metric_counter_t counter, uint32_t n = 1);
+void metrics_set(metric_gauge_t gauge, uint32_t value);
+void metrics_observe(metric_hist_t hist, int64_t us);
+
+uint32_t metrics_counter(metric_counter_t counter);
+void metrics_hist_summary(metric_hist_t hist, metric_hist_summary_t* out);
+// 버킷 카운트 복사 (METRICS_HIST_BUCKETS 개)
+void metrics_hist_buckets(metric_hist_t hist, uint32_t* out);
+void metrics_reset();
+
+// 스냅샷을 out 에 기록하고 길이 반환 (cap 부족 시 0)
+size_t metrics_encode(uint8_t* out, size_t cap, uint32_t uptime_ms);
+
+// 힙 / 아레나 / 태스크 스택 게이지 갱신 (디바이스 전용, metrics_system.cc)
+void metrics_refresh_system();
+
+#endif
@@ -1,13 +1,112 @@
 #ifndef MODEL_INFERENCE_H
 #define MODEL_INFERENCE_H
 
+#include <stdio.h>
+#include <stdint.h>
 #include "esp_err.h"
+#include "feature_extraction.h"
+#include "rolling_features.h"
+
+typedef struct {
+    int64_t model_load_us;
+    int64_t feature_us;
+    int64_t invoke_us;
+} stage_timing_t;
+
+#define STAGE1_FEATURES 120
+#define STAGE2_FEATURES 240
+
+// 메모리 클립에서 미리 계산한 두 단계 모델 입력
+typedef struct {
+    float stage1[STAGE1_FEATURES];
+    float stage2[STAGE2_FEATURES];
+    int64_t feature_us[2];
+} clip_features_t;
+
+typedef struct {
+    stage_timing_t stage[2];
+    int stages_run;
+    int64_t total_us;
+} pipeline_timing_t;
+
+#define PIPELINE_MAX_SCORES 8
+
+// 한 파일에 대한 전체 결과: 두 단계 모델 입력, 출력 점수, 단계별 시간
+//   스펙트로그램 모드는 stage[0] / scores[0] 만 쓰고 features 는 기록하지 않는다
+typedef struct {
+    pipeline_timing_t timing;
+    float features[STAGE1_FEATURES + STAGE2_FEATURES];
+    int feature_count;          // 120 (1단계만) 또는 360
+    float scores[2][PIPELINE_MAX_SCORES];
+    int score_count[2];
+    const char* answer;
+    uint32_t degraded;          // 요청 예산 때문에 적용한 degrade_t 비트 (request_budget.h)
+} pipeline_result_t;
+
+// 캐스케이드: 1차원 MFCC 통계 특징의 두 단계 모델
+// 스펙트로그램: 2D 로그 멜 (프레임 x 멜 빈) 을 입력으로 받는 6클래스 합성곱 모델 하나,
+//   프레임/빈 수는 모델 입력 텐서 모양에서, float / int8 입력 모두 지원
+typedef enum {
+    PIPELINE_CASCADE,
+    PIPELINE_SPECTROGRAM,
+} pipeline_mode_t;
+
+#ifndef DEFAULT_PIPELINE_MODE
+#define DEFAULT_PIPELINE_MODE PIPELINE_CASCADE
+#endif
+// 스펙트로그램 뒤쪽 프레임 패딩 (spec_pad_t)
+#ifndef SPECTROGRAM_PAD
+#define SPECTROGRAM_PAD SPEC_PAD_ZERO
+#endif
+
+// 2단계 추측 실행: pipeline_file() 의 1단계 특징 / 추론과 동시에 다른 코어에서 2단계 특징 추출과 모델 실행을
+// 시작하고, 1단계가 통증이면 결과를 버린다 (디바이스 실행기는 stage_executor.h)
+//   start(job, ctx): job(ctx) 를 다른 실행 흐름에서 시작, wait(): 그 job 이 끝날 때까지 대기
+typedef struct {
+    esp_err_t (*start)(void (*job)(void*), void* ctx);
+    void (*wait)();
+} stage_executor_t;
+
+// pipeline_file() / pipeline_clip() 가 끝날 때마다 그 태스크에서 호출
+//   seq: 저장소 레코드 번호 (저장하지 않았으면 0xffffffff), done_us: 완료 시각 (esp_timer)
+typedef void (*result_listener_fn)(int8_t result, uint32_t seq, int64_t done_us);
+
+#ifndef SPECULATIVE_PSRAM_ARENA_SIZE
+#define SPECULATIVE_PSRAM_ARENA_SIZE (512 * 1024)
+#endif
 
 esp_err_t init_model_inference();
+// 미리 읽은 모델도 해제하므로 진행 중인 요청이 없을 때만
 void cleanup_model_inference();
-esp_err_t model_predict(FILE* audio_file, const char* model_path, int feature_num);
-esp_err_t process1(FILE* audio_file, float* features);
-esp_err_t process2(FILE* audio_file, float* features);
+// 두 모델을 PSRAM 에 미리 읽어 첫 요청부터 SD 읽기를 생략
+//   요청과 동시에 실행해도 되며, 다 읽은 모델만 공개하고 이미 공개한 모델은 바꾸지 않는다
+esp_err_t preload_models();
+// 다음 분류부터 적용, 스펙트로그램 모델을 미리 읽으려면 이후 preload_models() 호출
+void set_pipeline_mode(pipeline_mode_t mode);
+pipeline_mode_t get_pipeline_mode();
+// 추측 작업 전용 요청 아레나를 할당하고 실행기를 등록 (NULL 이면 끄고 아레나 해제)
+esp_err_t enable_speculation(const stage_executor_t* executor);
+esp_err_t model_predict(FILE* audio_file, const char* model_path, int feature_num, stage_timing_t* timing = nullptr);
+esp_err_t model_predict_features(const float* features, const char* model_path, int feature_num,
+                                 stage_timing_t* timing = nullptr);
+// 전역 상태 없이 분류 (저장소 기록/아레나 reset 없음), 스레드마다 bind_request_arenas() 후 병렬 호출 가능
+esp_err_t classify_file(FILE* audio_file, pipeline_result_t* out);
 const char* pipeline();
+const char* pipeline_file(const char* audio_path);
+// 두 단계 특징을 한 번에 추출 (2단계가 필요 없어도 계산), 모델 로드 없이 scratch 아레나만 사용
+esp_err_t clip_features(const int16_t* samples, size_t count, clip_features_t* out, mem_arena_t* scratch);
+// 이동 창의 누적 로그 멜로 두 단계 특징을 만든다 (새 프레임 DSP 는 rolling_push() 에서 이미 끝남)
+esp_err_t rolling_clip_features(rolling_features_t* rolling, clip_features_t* out);
+// 미리 추출한 특징으로 분류하고 저장소가 열려 있으면 클립을 함께 기록 (samples == NULL 이면 기록하지 않음)
+const char* pipeline_clip(const clip_features_t* features, const int16_t* samples, size_t count,
+                          uint32_t* seq_out);
+const pipeline_timing_t* pipeline_last_timing();
+const pipeline_result_t* pipeline_last_result();
+// pipeline_file() / pipeline_clip() 요청당 지연 예산 (ms, 0 이면 무제한), 기본 REQUEST_BUDGET_MS
+//   예산이 모자라 1단계만 실행했고 통증이 아니면 응답은 RESULT_STAGE1_ONLY
+#define RESULT_STAGE1_ONLY 7
+void set_request_budget(uint32_t budget_ms);
+// NULL 이면 해제
+void set_result_listener(result_listener_fn listener);
 
-#endif
\ No newline at end of file
+#endif
@@ -3,6 +3,17 @@
 
 #define DEVICE_NAME "bigAivleAudio"
 
+#ifndef BLE_ENABLED
+#define BLE_ENABLED 1
+#endif
+// 동시에 연결할 클라이언트 수 (sdkconfig 의 CONFIG_BT_NIMBLE_MAX_CONNECTIONS 이하)
+#ifndef BLE_MAX_CLIENTS
+#define BLE_MAX_CLIENTS 2
+#endif
+
+// 스택 초기화 후 호스트 태스크까지 시작
 bool init_nimble();
+// on_stack_sync (GATT 시작 + 광고) 가 끝날 때까지 대기
+bool nimble_wait_ready(uint32_t timeout_ms);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef POWER_MGMT_H
+#define POWER_MGMT_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// esp_pm 동적 주파수 + 자동 light sleep
+//   녹음 / 특징 추출 / 추론 동안은 CPU 최대 클럭 잠금 (light sleep 도 막힌다),
+//   그 밖에는 PM_MIN_FREQ_MHZ 로 내려가고 모든 태스크가 대기 중이면 light sleep
+//   깨우는 원인: BLE 컨트롤러 (modem sleep), UART0 수신 엣지
+// sdkconfig: CONFIG_PM_ENABLE, CONFIG_FREERTOS_USE_TICKLESS_IDLE,
+//   BLE 는 CONFIG_BT_CTRL_MODEM_SLEEP + 저전력 클럭 (CONFIG_BT_CTRL_LPCLK_SEL_*)
+//   모드별 누적 시간 로그는 CONFIG_PM_PROFILING
+#ifndef POWER_MGMT_ENABLED
+#define POWER_MGMT_ENABLED 1
+#endif
+#ifndef PM_MAX_FREQ_MHZ
+#define PM_MAX_FREQ_MHZ 240
+#endif
+#ifndef PM_MIN_FREQ_MHZ
+#define PM_MIN_FREQ_MHZ 40      // XTAL
+#endif
+#ifndef PM_LIGHT_SLEEP
+#define PM_LIGHT_SLEEP 1
+#endif
+// light sleep 에서 UART 로 깨울 때 필요한 RX 엣지 수 (깨우는 바이트는 잃는다)
+#define PM_UART_WAKE_THRESHOLD 3
+// UART 수신 후 이 시간 동안은 light sleep 하지 않아 이어지는 프레임을 온전히 받는다
+#define PM_UART_AWAKE_MS 3000
+
+esp_err_t init_power_mgmt();
+// 중첩 가능, 마지막 power_busy_end() 에서 최대 클럭 잠금 해제
+void power_busy_begin();
+void power_busy_end();
+// ms 동안 light sleep 금지 (다시 호출하면 연장)
+void power_stay_awake(uint32_t ms);
+// 부팅 후 최대 클럭으로 보낸 시간과 그 밖의 시간 (낮은 클럭 + light sleep)
+void power_times(uint32_t* max_freq_ms, uint32_t* low_ms);
+// 위 시간과 (CONFIG_PM_PROFILING 이면) esp_pm 모드별 시간을 로그로
+void power_report();
+
+#endif
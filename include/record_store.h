@@ -0,0 +1,62 @@
+#ifndef RECORD_STORE_H
+#define RECORD_STORE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// 녹음 + 특징 + 예측 결과를 미리 할당한 세그먼트 파일에 순차 기록하는 저장소
+//   <dir>/seg000.dat ... : 레코드가 STORE_ALIGN 단위로 이어 붙는 세그먼트 (링 형태로 재사용)
+//   <dir>/index.bin       : 헤더 + seq % STORE_INDEX_CAPACITY 위치의 고정 크기 엔트리
+#ifndef RECORD_STORE_ENABLED
+#define RECORD_STORE_ENABLED 1
+#endif
+#define STORE_DIR_NAME "store"
+#ifndef STORE_SEGMENT_COUNT
+#define STORE_SEGMENT_COUNT 8
+#endif
+#ifndef STORE_SEGMENT_SIZE
+#define STORE_SEGMENT_SIZE (4 * 1024 * 1024)
+#endif
+#define STORE_INDEX_CAPACITY 1024
+#define STORE_ALIGN 512
+
+typedef struct {
+    uint32_t seq;
+    uint16_t segment;
+    int8_t result;
+    uint8_t reserved;
+    uint32_t offset;
+    uint32_t length;
+    uint32_t wav_size;
+    uint16_t feature_count;
+    uint16_t reserved2;
+    int64_t timestamp_us;
+} store_entry_t;
+
+esp_err_t record_store_open(const char* dir);
+void record_store_close();
+bool record_store_is_open();
+
+// 레코드 추가, 공간이 없으면 가장 오래된 세그먼트를 재사용
+esp_err_t record_store_append(FILE* wav_file, const float* features, int feature_count, int8_t result,
+                              int64_t timestamp_us, uint32_t* seq_out);
+// 메모리에 있는 16-bit PCM 클립을 WAV 로 저장
+esp_err_t record_store_append_pcm(const int16_t* samples, uint32_t sample_count, uint32_t sample_rate,
+                                  const float* features, int feature_count, int8_t result, int64_t timestamp_us,
+                                  uint32_t* seq_out);
+// 모든 함수는 저장소 잠금으로 직렬화되어 어느 태스크에서나 호출할 수 있다
+esp_err_t record_store_lookup(uint32_t seq, store_entry_t* entry);
+// seq 가 아직 남아 있는지 (세그먼트 재사용으로 덮어쓰기 시작하면 false)
+//   record_store_open_wav() 로 잠금 밖에서 읽은 데이터는 읽은 뒤 이것으로 확인한다
+bool record_store_contains(uint32_t seq);
+// 저장된 WAV 를 out 으로 복사
+esp_err_t record_store_read_wav(uint32_t seq, FILE* out);
+// 저장된 WAV 시작 위치에 맞춘 파일 핸들 (호출자가 fclose), 순차 전송용
+FILE* record_store_open_wav(uint32_t seq, long* offset, uint32_t* size);
+int record_store_read_features(uint32_t seq, float* features, int max_count);
+
+uint32_t record_store_oldest_seq();
+uint32_t record_store_next_seq();
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef REQUEST_BUDGET_H
+#define REQUEST_BUDGET_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// 요청당 지연 예산: 단계마다 남은 예산과 최근 관측한 단계 비용을 비교해
+// 모자라면 아래 순서로 품질을 낮춰 늦은 정확한 답 대신 빠른 근사 답을 낸다
+//   1. 녹음 저장 생략
+//   2. 클립 앞쪽 BUDGET_SHORT_AUDIO_MS 만으로 특징 추출
+//   3. 1단계 결과만으로 응답 (통증이 아니면 RESULT_STAGE1_ONLY)
+// 태스크 워치독(60 s)보다 충분히 짧게, 0 이면 무제한
+#ifndef REQUEST_BUDGET_MS
+#define REQUEST_BUDGET_MS 5000
+#endif
+#ifndef BUDGET_SHORT_AUDIO_MS
+#define BUDGET_SHORT_AUDIO_MS 2000
+#endif
+// 관측 전 비용 추정 (디바이스 SD 로드 / 특징 추출 기준), 이후 관측값으로 갱신
+#define BUDGET_DEFAULT_FEATURES_US 400000
+#define BUDGET_DEFAULT_MODEL_US 300000
+#define BUDGET_DEFAULT_STORE_US 200000
+
+// 남은 단계, 비트로 묶어 budget_plan() 에 넘긴다
+typedef enum {
+    BUDGET_FEATURES1 = 1 << 0,      // 전체 클립 기준
+    BUDGET_MODEL1 = 1 << 1,         // 모델 로드 + 실행
+    BUDGET_FEATURES2 = 1 << 2,
+    BUDGET_MODEL2 = 1 << 3,
+    BUDGET_STORE = 1 << 4,
+} budget_step_t;
+
+typedef enum {
+    DEGRADE_SKIP_STORE = 1 << 0,
+    DEGRADE_SHORT_AUDIO = 1 << 1,
+    DEGRADE_STAGE1_ONLY = 1 << 2,
+} degrade_t;
+
+typedef struct {
+    int64_t deadline_us;    // esp_timer 기준, 0 이면 무제한
+    uint32_t degraded;      // degrade_t 비트
+} request_budget_t;
+
+void budget_start(request_budget_t* budget, uint32_t budget_ms);
+int64_t budget_remaining_us(const request_budget_t* budget);
+// steps 의 추정 비용 합 (짧은 오디오면 특징 비용을 길이 비율만큼)
+int64_t budget_estimate(const request_budget_t* budget, uint32_t steps);
+// 관측값 반영: 늘어나면 바로, 줄어들면 천천히 따라간다 (특징은 전체 클립 기준으로 환산한 값)
+void budget_observe(budget_step_t step, int64_t us);
+// 남은 steps 가 예산을 넘으면 순서대로 품질을 낮추고 (메트릭 카운트) 적용된 degrade_t 비트 반환
+uint32_t budget_plan(request_budget_t* budget, uint32_t steps);
+// 요청이 끝날 때 호출, 마감을 넘겼으면 METRIC_DEADLINE_MISSED
+void budget_finish(const request_budget_t* budget);
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef REQUEST_SCHEDULER_H
+#define REQUEST_SCHEDULER_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// 녹음 / 특징 추출 / 추론을 각각의 태스크로 나누고 큐로 연결해
+// 클립 N 을 처리하는 동안 클립 N+1 을 녹음한다
+//   capture --(feature_queue)--> feature --(infer_queue)--> inference
+// 클립 버퍼는 SCHED_CLIP_SLOTS 개를 미리 할당해 돌려 쓴다
+#ifndef SCHED_CLIP_SLOTS
+#define SCHED_CLIP_SLOTS 3
+#endif
+
+// 녹음이 처리보다 빨라 빈 클립 버퍼가 없을 때의 동작
+typedef enum {
+    SCHED_DROP_OLDEST,      // 아직 특징 추출을 시작하지 않은 가장 오래된 클립을 버리고 재사용
+    SCHED_BACKPRESSURE,     // 버퍼가 빌 때까지 다음 녹음을 미룬다
+} sched_policy_t;
+
+#ifndef DEFAULT_SCHED_POLICY
+#define DEFAULT_SCHED_POLICY SCHED_DROP_OLDEST
+#endif
+
+typedef enum {
+    SCHED_STAGE_CAPTURE,
+    SCHED_STAGE_FEATURE,
+    SCHED_STAGE_INFERENCE,
+    SCHED_STAGE_COUNT,
+} sched_stage_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t jobs;
+    uint32_t busy_ms;
+    uint16_t utilization_permille;  // init 이후 busy 비율
+    uint8_t queue_depth;            // 이 단계 앞에서 대기 중인 클립 (capture: 남은 요청)
+    uint8_t max_queue_depth;
+} sched_stage_stats_t;
+
+typedef struct __attribute__((packed)) {
+    sched_stage_stats_t stage[SCHED_STAGE_COUNT];
+    uint32_t dropped;
+    uint32_t backpressure_waits;
+    uint32_t uptime_ms;
+} sched_stats_t;
+
+typedef struct {
+    uint32_t clip;
+    int8_t result;          // 응답 코드, -1: 버려졌거나 실패
+    uint32_t seq;           // 저장소 seq (저장하지 않았으면 0xffffffff)
+    uint32_t latency_us;    // 녹음 종료 -> 결과
+} sched_result_t;
+
+typedef void (*sched_result_fn)(void* ctx, const sched_result_t* result);
+
+esp_err_t init_scheduler(sched_policy_t policy);
+bool scheduler_ready();
+// clips 개를 연속 녹음하면서 처리, 클립마다 on_result 호출 후 반환 (호출자가 직렬화)
+esp_err_t scheduler_run(uint16_t clips, sched_result_fn on_result, void* ctx);
+void scheduler_get_stats(sched_stats_t* stats);
+
+#endif
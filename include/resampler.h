@@ -0,0 +1,43 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// 다상(polyphase) FIR 샘플레이트 변환기, 출력/입력 비율 up/down (기약분수)
+//   프로토타입 저역통과 필터(up * taps 탭, Kaiser 창 sinc)를 up 개 위상으로 나눠
+//   출력 샘플마다 한 위상의 taps 개 계수와 최근 입력 taps 개의 내적만 계산한다
+// 입력은 한 샘플씩 또는 블록으로 흘려 넣을 수 있고 상태는 채널당 고정 크기
+// 위상당 탭 수는 down/up 에 비례해 늘려야 같은 전이 대역이 나온다
+//   (에일리어싱 -60 dB 이하: 25000 -> 22500 은 64, 50000 -> 22500 은 160, resampler_response 로 확인)
+#ifndef RESAMPLER_TAPS
+#define RESAMPLER_TAPS 64
+#endif
+// 차단 주파수: 두 레이트 중 낮은 쪽 나이퀴스트의 비율
+#define RESAMPLER_CUTOFF 0.9f
+#define RESAMPLER_KAISER_BETA 8.0f
+
+typedef struct {
+    uint32_t up;
+    uint32_t down;
+    int taps;
+    float* coeffs;      // [up][taps], 위상마다 시간 역순 (가장 오래된 입력에 곱할 계수가 먼저)
+    float* history;     // 2 * taps, 같은 샘플을 두 곳에 써서 창이 항상 연속
+    int pos;
+    uint32_t phase;
+} resampler_t;
+
+esp_err_t resampler_init(resampler_t* rs, uint32_t in_rate, uint32_t out_rate, int taps, uint32_t caps);
+// resampler_init() 이 할당할 바이트 (배치 결정용)
+size_t resampler_footprint(uint32_t in_rate, uint32_t out_rate, int taps);
+void resampler_deinit(resampler_t* rs);
+void resampler_reset(resampler_t* rs);
+// 입력 count 개에 대해 나올 수 있는 최대 출력 수
+size_t resampler_max_output(const resampler_t* rs, size_t count);
+// 입력 블록 처리, out 에 쓴 샘플 수 반환 (out 은 resampler_max_output() 이상)
+size_t resampler_process(resampler_t* rs, const int16_t* in, size_t count, int16_t* out);
+// 입력 한 샘플 처리, 출력 수 반환 (다운샘플링이면 0 또는 1)
+int resampler_push(resampler_t* rs, int16_t in, int16_t* out);
+
+#endif
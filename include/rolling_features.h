@@ -0,0 +1,45 @@
+#ifndef ROLLING_FEATURES_H
+#define ROLLING_FEATURES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "audio_config.h"
+#include "feature_extraction.h"
+#include "delta_features.h"
+#include "mem_arena.h"
+
+// 연속 분류용 이동 창: hop(FRAME_STEP) 마다 새 프레임의 로그 멜 에너지만 계산해 링 버퍼에 넣고
+// 창 안 프레임의 합을 증감으로 유지한다. 창 평균 로그 멜에 DCT 를 적용하면
+// extract_mfcc() 의 프레임 평균 MFCC 와 같은 값이 된다
+// 시간축 delta 도 양쪽 half 프레임 문맥이 모두 창 안에 있는 프레임분은 증감으로 유지하고,
+// 창 가장자리 프레임(끝 프레임 복제)만 조회 때 더해 scan_clip_logmel() 과 같은 값을 만든다
+//
+// 길이 samples 인 클립에서 extract_mfcc() 가 쓰는 프레임 수
+#define CLIP_FRAMES(samples) ((int)(((samples) - FRAME_LENGTH - 1) / FRAME_STEP + 1))
+
+typedef struct {
+    float* frames;          // [capacity][NUM_MEL_FILTERS] 로그 멜, 가장 오래된 프레임은 head
+    int capacity;
+    int count;
+    int head;
+    double sum[NUM_MEL_FILTERS];
+    delta_kernel_t kernel;
+    delta_stats_t* deltas;  // [0] 창 내부 프레임 누적, [1] 조회용 작업 공간
+    int16_t pending[FRAME_LENGTH];  // 다음 프레임을 만들기 위해 남겨 둔 샘플
+    int pending_count;
+    uint32_t total_frames;
+} rolling_features_t;
+
+esp_err_t rolling_init(rolling_features_t* rolling, int window_frames, uint32_t caps);
+void rolling_deinit(rolling_features_t* rolling);
+void rolling_reset(rolling_features_t* rolling);
+// 샘플을 이어 붙이고 완성된 프레임마다 로그 멜을 계산, 새로 추가된 프레임 수 반환 (scratch: 프레임 버퍼)
+int rolling_push(rolling_features_t* rolling, const int16_t* samples, size_t count, mem_arena_t* scratch);
+bool rolling_full(const rolling_features_t* rolling);
+// 창 전체의 프레임 평균 MFCC (n_mfcc <= MAX_MFCC)
+esp_err_t rolling_mfcc(const rolling_features_t* rolling, feature_slice_t mfcc, int n_mfcc);
+// 창 전체의 delta / delta2 표준편차 (delta_stats_std() 와 같은 정의)
+esp_err_t rolling_deltas(rolling_features_t* rolling, int n_mfcc, feature_slice_t delta, feature_slice_t delta2);
+
+#endif
@@ -3,6 +3,21 @@
 
 #include "esp_err.h"
 
+// SPI 버스 클럭, 카드가 못 따라오면 SD_FALLBACK_FREQ_KHZ 로 다시 마운트
+// (SDSPI 는 기본 속도 20 MHz, 짧은 배선이면 40000 까지)
+#ifndef SD_FREQ_KHZ
+#define SD_FREQ_KHZ 20000
+#endif
+#define SD_FALLBACK_FREQ_KHZ 4000
+// 한 번의 SPI DMA 전송 최대 크기 (sd_reader 의 SD_READ_CHUNK 이상)
+#ifndef SD_MAX_TRANSFER
+#define SD_MAX_TRANSFER (32 * 1024)
+#endif
+// 마운트 후 첫 번째 모델 파일로 읽기 처리량 측정
+#ifndef SD_SELF_TEST
+#define SD_SELF_TEST 1
+#endif
+
 esp_err_t init_sd_card();
 void cleanup_sd_card();
 
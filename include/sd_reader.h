@@ -0,0 +1,37 @@
+#ifndef SD_READER_H
+#define SD_READER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "esp_err.h"
+#include "mem_arena.h"
+
+// FatFs f_read 로 직접 읽는 경로 (newlib FILE* 의 작은 버퍼와 VFS 를 거치지 않음)
+//   내부 RAM DMA 버퍼로 SD_READ_CHUNK 씩 읽어 파일 위치가 항상 섹터 경계에 있으므로
+//   FatFs 가 윈도우 버퍼 없이 다중 섹터(CMD18)로 바로 채운다, 목적지(PSRAM)로는 memcpy
+#ifndef SD_READ_CHUNK
+#define SD_READ_CHUNK (32 * 1024)
+#endif
+#define SD_SECTOR_SIZE 512
+#define SD_DMA_ALIGN 64         // 캐시 라인 정렬
+
+// VFS 마운트 지점과 FatFs 드라이브 (init_sd_card 가 설정, 설정 전이면 경로를 그대로 f_open)
+void sd_reader_set_drive(const char* mount_point, int pdrv);
+
+esp_err_t sd_file_size(const char* path, size_t* size);
+// 파일 앞에서부터 최대 size 바이트를 dst 로
+esp_err_t sd_read_file(const char* path, void* dst, size_t size, size_t* read);
+// 파일 전체를 arena 에 읽어 메모리 FILE* 로 연다 (fclose 로 닫고, 메모리는 아레나 reset 때 반환)
+FILE* sd_open_buffered(const char* path, mem_arena_t* arena);
+
+typedef struct {
+    uint32_t bytes;
+    int64_t raw_us;     // sd_read_file
+    int64_t stdio_us;   // fopen + fread (기본 버퍼)
+} sd_bench_t;
+
+// 같은 파일을 두 경로로 읽어 시간 측정 (처리량 = bytes / us MB/s)
+esp_err_t sd_read_benchmark(const char* path, sd_bench_t* out);
+
+#endif
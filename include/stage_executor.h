@@ -0,0 +1,16 @@
+#ifndef STAGE_EXECUTOR_H
+#define STAGE_EXECUTOR_H
+
+#include "esp_err.h"
+
+// 2단계 추측 실행용 작업 태스크, pipeline_file() 의 1단계와 다른 코어에서 돈다
+//   요청 태스크(uart_event, pipeline_worker)는 코어 고정이 없어 1단계 동안 다른 코어로 옮겨 간다
+//   녹음 바쁜 대기 태스크(sched_capture, cont_capture)도 코어 1 이라 그 동안에는 2단계가 밀린다
+#ifndef STAGE_EXECUTOR_CORE
+#define STAGE_EXECUTOR_CORE 1
+#endif
+
+// 태스크를 만들고 enable_speculation() 으로 등록
+esp_err_t init_stage_executor();
+
+#endif
@@ -1,7 +1,22 @@
 #ifndef UART_HANDLER_H
 #define UART_HANDLER_H
 
+// 명령 포트, 기본은 콘솔과 같은 UART0 (UART0 는 기본 핀, 그 밖의 포트는 UART_CMD_TX/RX_PIN)
+//   콘솔과 공유하면 모니터도 같은 속도로 연결해야 하고 (idf.py monitor -b) 로그 텍스트가 응답 프레임 사이에 섞인다
+//   CONFIG_LOG_DEFAULT_LEVEL_NONE 으로 로그를 끄거나 UART_CMD_NUM 을 UART_NUM_1 과 핀으로 옮긴다
+#ifndef UART_CMD_NUM
+#define UART_CMD_NUM UART_NUM_0
+#endif
+#ifndef UART_CMD_TX_PIN
+#define UART_CMD_TX_PIN 17
+#endif
+#ifndef UART_CMD_RX_PIN
+#define UART_CMD_RX_PIN 18
+#endif
+#ifndef UART_BAUD_RATE
+#define UART_BAUD_RATE 921600
+#endif
+
 void init_uart();
-void uart_read();
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,46 @@
+#ifndef WAV_IO_H
+#define WAV_IO_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define WAV_FORMAT_PCM 1
+#define WAV_FORMAT_IMA_ADPCM 0x11
+#define WAV_PCM_HEADER_SIZE 44
+#define WAV_ADPCM_HEADER_SIZE 60
+#define WAV_MAX_BLOCK_ALIGN 1024
+
+typedef struct {
+    uint16_t format;
+    uint16_t channels;
+    uint32_t sample_rate;
+    uint16_t block_align;
+    uint16_t bits_per_sample;
+    uint16_t samples_per_block;
+    uint32_t data_size;
+    uint32_t num_samples;
+    long data_offset;
+} wav_info_t;
+
+// PCM / IMA-ADPCM 를 구분하지 않고 16-bit 샘플을 순차적으로 읽는 디코더
+typedef struct {
+    wav_info_t info;
+    uint32_t samples_left;
+    int pending_pos;
+    int pending_len;
+    uint8_t block[WAV_MAX_BLOCK_ALIGN];
+    int16_t pending[(WAV_MAX_BLOCK_ALIGN - 4) * 2 + 1];
+} wav_reader_t;
+
+esp_err_t wav_read_header(FILE* file, wav_info_t* info);
+// 44바이트 16-bit mono PCM 헤더를 버퍼에 작성
+void wav_pcm_header(uint8_t* out, uint32_t data_size, uint32_t sample_rate);
+esp_err_t wav_write_pcm_header(FILE* file, uint32_t data_size, uint32_t sample_rate);
+esp_err_t wav_write_adpcm_header(FILE* file, uint32_t data_size, uint32_t num_samples, uint32_t sample_rate);
+
+// 헤더를 읽고 data 청크 시작으로 이동, 헤더가 없으면 44바이트 뒤 16-bit PCM 으로 간주
+esp_err_t wav_reader_open(wav_reader_t* reader, FILE* file);
+size_t wav_reader_read(wav_reader_t* reader, FILE* file, int16_t* out, size_t max_samples);
+
+#endif
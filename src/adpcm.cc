@@ -0,0 +1,104 @@
+#include "adpcm.h"
+
+static const int8_t index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static const int16_t step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+
+static inline int32_t clamp(int32_t x, int32_t lo, int32_t hi) {
+    return x < lo ? lo : (x > hi ? hi : x);
+}
+
+uint8_t adpcm_encode_sample(adpcm_state_t* state, int16_t sample) {
+    int32_t step = step_table[state->step_index];
+    int32_t diff = sample - state->predictor;
+    uint8_t nibble = 0;
+    if (diff < 0) {
+        nibble = 8;
+        diff = -diff;
+    }
+
+    // 디코더와 같은 방식으로 복원값을 계산해 누적 오차를 막는다
+    int32_t delta = step >> 3;
+    if (diff >= step) {
+        nibble |= 4;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        nibble |= 2;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        nibble |= 1;
+        delta += step;
+    }
+
+    state->predictor = clamp(state->predictor + ((nibble & 8) ? -delta : delta), -32768, 32767);
+    state->step_index = clamp(state->step_index + index_table[nibble], 0, 88);
+    return nibble;
+}
+
+int16_t adpcm_decode_sample(adpcm_state_t* state, uint8_t nibble) {
+    int32_t step = step_table[state->step_index];
+    int32_t delta = step >> 3;
+    if (nibble & 4) delta += step;
+    if (nibble & 2) delta += step >> 1;
+    if (nibble & 1) delta += step >> 2;
+
+    state->predictor = clamp(state->predictor + ((nibble & 8) ? -delta : delta), -32768, 32767);
+    state->step_index = clamp(state->step_index + index_table[nibble & 0x0f], 0, 88);
+    return (int16_t)state->predictor;
+}
+
+size_t adpcm_encode_block(adpcm_state_t* state, const int16_t* samples, int n, uint8_t* out) {
+    if (n <= 0) {
+        return 0;
+    }
+
+    // 블록 헤더: 첫 샘플, step index
+    state->predictor = samples[0];
+    out[0] = (uint8_t)(samples[0] & 0xff);
+    out[1] = (uint8_t)((samples[0] >> 8) & 0xff);
+    out[2] = (uint8_t)state->step_index;
+    out[3] = 0;
+
+    size_t len = 4;
+    for (int i = 1; i < n; i += 2) {
+        uint8_t lo = adpcm_encode_sample(state, samples[i]);
+        uint8_t hi = (i + 1 < n) ? adpcm_encode_sample(state, samples[i + 1]) : 0;
+        out[len++] = lo | (hi << 4);
+    }
+    return len;
+}
+
+int adpcm_decode_block(const uint8_t* block, size_t len, int16_t* out) {
+    if (len < 4) {
+        return 0;
+    }
+
+    adpcm_state_t state;
+    state.predictor = (int16_t)(block[0] | (block[1] << 8));
+    state.step_index = clamp(block[2], 0, 88);
+
+    int n = 0;
+    out[n++] = (int16_t)state.predictor;
+    for (size_t i = 4; i < len; i++) {
+        out[n++] = adpcm_decode_sample(&state, block[i] & 0x0f);
+        out[n++] = adpcm_decode_sample(&state, block[i] >> 4);
+    }
+    return n;
+}
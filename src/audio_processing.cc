@@ -1,26 +1,27 @@
 #include "rel_common.h"
 #include "audio_processing.h"
 #include "processing_utils.h"
+#include "audio_config.h"
+#include "data_paths.h"
+#include "adpcm.h"
+#include "wav_io.h"
+#include "resampler.h"
+#include "mem_placement.h"
+#include "metrics.h"
 #include "esp_log.h"
 #include "esp_timer.h"
-#include "esp_dsp.h"
 #include "driver/adc.h"
 #include "esp_adc/adc_cali.h"
 #include "esp_adc/adc_oneshot.h"
 #include "esp_heap_caps.h"
 #include "driver/i2s.h"
 
-#include <math.h>
-
-#define SAMPLE_RATE 22500
-#define RECORD_TIME 6000
 #define BUFFER_SIZE 4096
-#define FRAME_LENGTH 512
-#define FRAME_STEP 256
-#define NUM_MEL_FILTERS 40
-#define FFT_SIZE 512
-#define SAMPLE_INTERVAL (1000000 / SAMPLE_RATE)
-#define MAX_AUDIO_SIZE (SAMPLE_RATE * RECORD_TIME / 1000)
+#define SAMPLE_INTERVAL (1000000 / CAPTURE_RATE)
+#define RESAMPLING (CAPTURE_RATE != SAMPLE_RATE)
+
+// 녹음 루프는 ADC 샘플 하나당 출력이 최대 하나라고 가정 (오버샘플링 후 데시메이션만 지원)
+static_assert(CAPTURE_RATE >= SAMPLE_RATE, "CAPTURE_RATE must not be below SAMPLE_RATE");
 #define ADC_CHANNEL ADC_CHANNEL_1
 
 static const char* TAG = "AUDIO_PROCESSING";
@@ -28,76 +29,8 @@ static const char* TAG = "AUDIO_PROCESSING";
 adc_oneshot_unit_handle_t adc1_handle;
 adc_cali_handle_t adc_cali_handle = NULL;
 
-static float* fbank;
-float* fft_buffer;
-
-void apply_mel_filterbank(float* spectrum, float* mel_energies, float* fbank, int n_filters, int n_fft);
-
-esp_err_t feature_extractor(FILE* audio_file, float* mfcc, int n_mfcc) {
-    fseek(audio_file, 44, SEEK_SET);
-
-    int16_t* audio_data = (int16_t*)heap_caps_malloc(MAX_AUDIO_SIZE * sizeof(int16_t), MALLOC_CAP_SPIRAM);
-    if (!audio_data) {
-        ESP_LOGE(TAG, "Failed to allocate memory for audio data");
-        return ESP_ERR_NO_MEM;
-    }
-
-    int frame_count = 0;
-
-    size_t audio_size = fread(audio_data, sizeof(int16_t), MAX_AUDIO_SIZE, audio_file);
-
-    float* frame_real = (float*)heap_caps_malloc(FRAME_LENGTH * sizeof(float), MALLOC_CAP_SPIRAM);
-    float* frame_imag = (float*)heap_caps_malloc(FRAME_LENGTH * sizeof(float), MALLOC_CAP_SPIRAM);
-    float* mel_energies = (float*)heap_caps_malloc(NUM_MEL_FILTERS * sizeof(float), MALLOC_CAP_SPIRAM);
-
-    for (int i = 0; i < audio_size - FRAME_LENGTH; i += FRAME_STEP) {
-        for (int j = 0; j < FRAME_LENGTH; j++) {
-            frame_real[j] = (float)audio_data[i + j] / 32768.0f;
-            frame_imag[j] = 0.0f;
-        }
-
-        // 프리엠퍼시스
-        dsps_preemphasis(frame_real, frame_real, FRAME_LENGTH, 0.97f);
-
-        // 윈도우 적용
-        dsps_wind_hann_f32(frame_real, FRAME_LENGTH);
-
-        //FFT 수행
-        fft(frame_real, frame_imag, FRAME_LENGTH);
-
-        // 멜 필터뱅크 적용
-        for (int j = 0; j < FRAME_LENGTH / 2 + 1; j++) {
-            float magnitude = sqrtf(frame_real[j] * frame_real[j] + frame_imag[j] * frame_imag[j]);
-            frame_real[j] = magnitude;
-        }
-        apply_mel_filterbank(frame_real, mel_energies, fbank, NUM_MEL_FILTERS, FFT_SIZE / 2 + 1);
-
-        // 로그 변환
-        dsps_log(mel_energies, NUM_MEL_FILTERS);
-
-        // DCT 수행
-        dsps_dct_f32(mel_energies, n_mfcc);
-
-        for (int j = 0; j < n_mfcc; j++) {
-            mfcc[j] += mel_energies[j];
-        }
-
-        frame_count++;
-    }
-
-    if (frame_count > 0) {
-        for (int i = 0; i < n_mfcc; i++) {
-            mfcc[i] /= frame_count;
-        }
-    }
-
-    heap_caps_free(audio_data);
-    heap_caps_free(frame_real);
-    heap_caps_free(frame_imag);
-    heap_caps_free(mel_energies);
-    return ESP_OK;
-}
-
+static record_format_t record_format = DEFAULT_RECORD_FORMAT;
+static resampler_t capture_resampler;
 
 esp_err_t init_audio_processing() {
     esp_err_t ret;
@@ -136,10 +69,16 @@ esp_err_t init_audio_processing() {
         return ret;
     }
 
-    fbank = (float*)heap_caps_malloc(NUM_MEL_FILTERS * (FFT_SIZE / 2 + 1) * sizeof(float), MALLOC_CAP_SPIRAM);
-    create_mel_filterbank(fbank, NUM_MEL_FILTERS, FFT_SIZE, SAMPLE_RATE);
+    if (RESAMPLING) {
+        size_t footprint = resampler_footprint(CAPTURE_RATE, SAMPLE_RATE, RESAMPLER_TAPS);
+        ret = resampler_init(&capture_resampler, CAPTURE_RATE, SAMPLE_RATE, RESAMPLER_TAPS,
+                             mem_place_caps(MEM_RESAMPLER, footprint));
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
 
-    return ESP_OK;
+    return init_feature_extraction();
 }
 
 void cleanup_audio_processing() {
@@ -149,51 +88,84 @@ void cleanup_audio_processing() {
     if (adc_cali_handle) {
         adc_cali_delete_scheme_curve_fitting(adc_cali_handle);
     }
-    heap_caps_free(fbank);
+    resampler_deinit(&capture_resampler);
+    cleanup_feature_extraction();
 }
 
-void apply_mel_filterbank(float* spectrum, float* mel_energies, float* fbank, int n_filters, int n_fft) {
-    for (int i = 0; i < n_filters; i++) {
-        mel_energies[i] = 0.0f;
-        for (int j = 0; j < n_fft / 2 + 1; j++) {
-            mel_energies[i] += spectrum[j] * fbank[i * n_fft + j];
-        }
+void set_record_format(record_format_t format) {
+    record_format = format;
+}
+
+record_format_t get_record_format() {
+    return record_format;
+}
+
+static int16_t read_sample() {
+    int adc_raw;
+    ESP_ERROR_CHECK(adc_oneshot_read(adc1_handle, ADC_CHANNEL, &adc_raw));
+    int voltage_mv;
+    ESP_ERROR_CHECK(adc_cali_raw_to_voltage(adc_cali_handle, adc_raw, &voltage_mv));
+    return (int16_t)map(voltage_mv, 0, 3300, -32768, 32767);
+}
+
+// ADC 한 샘플 -> SAMPLE_RATE 출력 0 또는 1개
+static int capture_sample(int16_t* out) {
+    int16_t sample = read_sample();
+    if (!RESAMPLING) {
+        *out = sample;
+        return 1;
     }
+    return resampler_push(&capture_resampler, sample, out);
 }
 
-void scaler(float* features, int size, const char* scaler_path) {
-    FILE* scaler_file = fopen(scaler_path, "rb");
-    if (!scaler_file) {
-        ESP_LOGE(TAG, "Failed to open scaler file");
-        return;
+static void start_capture() {
+    if (RESAMPLING) {
+        resampler_reset(&capture_resampler);
     }
+}
 
-    float mean, std;
-    fread(&mean, sizeof(float), 1, scaler_file);
-    fread(&std, sizeof(float), 1, scaler_file);
-    fclose(scaler_file);
+size_t record_clip(int16_t* samples, size_t max_samples) {
+    int64_t startTime = esp_timer_get_time();
+    int64_t nextSampleTime = startTime;
+    size_t count = 0;
+    start_capture();
 
-    for (int i = 0; i < size; i++) {
-        features[i] = (features[i] - mean) / std;
+    while (count < max_samples && esp_timer_get_time() - startTime < RECORD_TIME * 1000) {
+        if (esp_timer_get_time() >= nextSampleTime) {
+            count += capture_sample(samples + count);
+            nextSampleTime += SAMPLE_INTERVAL;
+        }
     }
+    metrics_observe(METRIC_HIST_RECORD, esp_timer_get_time() - startTime);
+    return count;
 }
 
-void differential_mfcc(float* mfcc_features, float* delta_mfccs, float* delta2_mfccs, int size) {
-    // 1차 미분
-    dsps_diff(mfcc_features, delta_mfccs, size, 1);
-
-    // 2차 미분
-    dsps_diff(delta_mfccs, delta2_mfccs, size, 1);
+size_t record_samples(int16_t* samples, size_t count, int64_t* next_sample_us) {
+    if (*next_sample_us == 0) {
+        *next_sample_us = esp_timer_get_time();
+        start_capture();
+    }
+    size_t n = 0;
+    while (n < count) {
+        if (esp_timer_get_time() >= *next_sample_us) {
+            n += capture_sample(samples + n);
+            *next_sample_us += SAMPLE_INTERVAL;
+        }
+    }
+    return n;
 }
 
 void recordAudio() {
-    FILE* f = fopen("/sdcard/audio.wav", "wb");
+    char path[DATA_PATH_MAX];
+    FILE* f = fopen(data_path(path, sizeof(path), AUDIO_FILE_NAME), "wb");
     if (!f) {
         ESP_LOGE(TAG, "Failed to open file for writing");
         return;
     }
 
-    for (int i = 0; i < 44; i++) {
+    bool adpcm = record_format == RECORD_FORMAT_IMA_ADPCM;
+    int headerSize = adpcm ? WAV_ADPCM_HEADER_SIZE : WAV_PCM_HEADER_SIZE;
+    for (int i = 0; i < headerSize; i++) {
         fputc(0, f);
     }
 
@@ -201,30 +173,38 @@ void recordAudio() {
     int64_t startTime = esp_timer_get_time();
     int64_t nextSampleTime = startTime;
     uint32_t totalSamples = 0;
+    uint32_t dataSize = 0;
 
-    int16_t* audioBuffer = (int16_t*)heap_caps_malloc(BUFFER_SIZE * sizeof(int16_t), MALLOC_CAP_SPIRAM);
-    if (!audioBuffer) {
+    int16_t* audioBuffer = (int16_t*)mem_place_alloc(MEM_AUDIO, BUFFER_SIZE * sizeof(int16_t));
+    uint8_t* adpcmBlock = adpcm ? (uint8_t*)mem_place_alloc(MEM_AUDIO, ADPCM_BLOCK_ALIGN) : NULL;
+    if (!audioBuffer || (adpcm && !adpcmBlock)) {
         ESP_LOGE(TAG, "Failed to allocate buffer");
+        heap_caps_free(audioBuffer);
+        heap_caps_free(adpcmBlock);
         fclose(f);
         return;
     }
 
+    // ADPCM 은 블록 단위(ADPCM_SAMPLES_PER_BLOCK 샘플 -> ADPCM_BLOCK_ALIGN 바이트)로 기록
+    int flushSize = adpcm ? ADPCM_SAMPLES_PER_BLOCK : BUFFER_SIZE;
+    adpcm_state_t adpcmState = {0, 0};
     int bufferIndex = 0;
+    start_capture();
 
     while (esp_timer_get_time() - startTime < RECORD_TIME * 1000) {
         int64_t currentTime = esp_timer_get_time();
         if (currentTime >= nextSampleTime) {
-            int adc_raw;
-            ESP_ERROR_CHECK(adc_oneshot_read(adc1_handle, ADC_CHANNEL, &adc_raw));
-            int voltage_mv;
-            ESP_ERROR_CHECK(adc_cali_raw_to_voltage(adc_cali_handle, adc_raw, &voltage_mv));
-            int16_t sample = (int16_t)map(voltage_mv, 0, 3300, -32768, 32767);
-
-            audioBuffer[bufferIndex++] = sample;
-            totalSamples++;
-
-            if (bufferIndex >= BUFFER_SIZE) {
-                fwrite(audioBuffer, sizeof(int16_t), BUFFER_SIZE, f);
+            int produced = capture_sample(audioBuffer + bufferIndex);
+            bufferIndex += produced;
+            totalSamples += produced;
+
+            if (bufferIndex >= flushSize) {
+                if (adpcm) {
+                    size_t len = adpcm_encode_block(&adpcmState, audioBuffer, bufferIndex, adpcmBlock);
+                    dataSize += fwrite(adpcmBlock, 1, len, f);
+                } else {
+                    dataSize += fwrite(audioBuffer, sizeof(int16_t), bufferIndex, f) * sizeof(int16_t);
+                }
                 bufferIndex = 0;
             }
 
@@ -233,40 +213,28 @@ void recordAudio() {
     }
 
     if (bufferIndex > 0) {
-        fwrite(audioBuffer, sizeof(int16_t), bufferIndex, f);
+        if (adpcm) {
+            size_t len = adpcm_encode_block(&adpcmState, audioBuffer, bufferIndex, adpcmBlock);
+            dataSize += fwrite(adpcmBlock, 1, len, f);
+        } else {
+            dataSize += fwrite(audioBuffer, sizeof(int16_t), bufferIndex, f) * sizeof(int16_t);
+        }
     }
 
     heap_caps_free(audioBuffer);
+    heap_caps_free(adpcmBlock);
 
-    uint32_t dataSize = totalSamples * 2;
-    writeWaveHeader(f, dataSize);
+    if (adpcm) {
+        wav_write_adpcm_header(f, dataSize, totalSamples, SAMPLE_RATE);
+    } else {
+        writeWaveHeader(f, dataSize);
+    }
 
     fclose(f);
-    ESP_LOGI(TAG, "Recording completed and saved");
+    metrics_observe(METRIC_HIST_RECORD, esp_timer_get_time() - startTime);
+    ESP_LOGI(TAG, "Recording completed and saved (%u samples, %u bytes)", (unsigned)totalSamples, (unsigned)dataSize);
 }
 
 void writeWaveHeader(FILE* file, uint32_t dataSize) {
-    fseek(file, 0, SEEK_SET);
-    
-    fwrite("RIFF", 1, 4, file);
-    uint32_t fileSize = dataSize + 36;
-    fwrite(&fileSize, 1, 4, file);
-    fwrite("WAVE", 1, 4, file);
-    fwrite("fmt ", 1, 4, file);
-    uint32_t fmtSize = 16;
-    fwrite(&fmtSize, 1, 4, file);
-    uint16_t audioFormat = 1;
-    fwrite(&audioFormat, 1, 2, file);
-    uint16_t numChannels = 1;
-    fwrite(&numChannels, 1, 2, file);
-    uint32_t sampleRate = SAMPLE_RATE;
-    fwrite(&sampleRate, 1, 4, file);
-    uint32_t byteRate = SAMPLE_RATE * 2;
-    fwrite(&byteRate, 1, 4, file);
-    uint16_t blockAlign = 2;
-    fwrite(&blockAlign, 1, 2, file);
-    uint16_t bitsPerSample = 16;
-    fwrite(&bitsPerSample, 1, 2, file);
-    fwrite("data", 1, 4, file);
-    fwrite(&dataSize, 1, 4, file);
-}
\ No newline at end of file
+    wav_write_pcm_header(file, dataSize, SAMPLE_RATE);
+}
@@ -0,0 +1,110 @@
+#include "boot_init.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/task.h"
+
+#define BOOT_STEP_STACK 4096
+#define BOOT_FAIL_SHIFT BOOT_MAX_STEPS
+
+static const char* TAG = "BOOT";
+
+typedef struct {
+    const boot_step_t* step;
+    int index;
+    int64_t wait_us;
+    int64_t start_us;
+    int64_t end_us;
+    esp_err_t result;
+} step_state_t;
+
+static EventGroupHandle_t boot_events;
+static step_state_t states[BOOT_MAX_STEPS];
+static int64_t ready_us;
+// boot_run() 이 실패로 끝난 뒤 늦게 의존성이 풀린 단계 (예: 시간 초과 후 SD 마운트 완료)
+static volatile bool boot_aborted;
+
+static void step_task(void* arg) {
+    step_state_t* state = (step_state_t*)arg;
+    const boot_step_t* step = state->step;
+    int64_t created = esp_timer_get_time();
+
+    if (step->deps) {
+        xEventGroupWaitBits(boot_events, step->deps, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+    // 의존 단계가 하나라도 실패했거나 부팅이 이미 실패로 끝났으면 실행하지 않는다
+    EventBits_t failed = (xEventGroupGetBits(boot_events) >> BOOT_FAIL_SHIFT) & step->deps;
+    if (boot_aborted) {
+        failed = 1;
+    }
+
+    state->start_us = esp_timer_get_time();
+    state->wait_us = state->start_us - created;
+    state->result = failed ? ESP_ERR_INVALID_STATE : step->fn();
+    state->end_us = esp_timer_get_time();
+
+    EventBits_t bits = BOOT_STEP_BIT(state->index);
+    if (state->result != ESP_OK) {
+        bits |= BOOT_STEP_BIT(state->index + BOOT_FAIL_SHIFT);
+    }
+    xEventGroupSetBits(boot_events, bits);
+    vTaskDelete(NULL);
+}
+
+esp_err_t boot_run(const boot_step_t* steps, int count, uint32_t timeout_ms) {
+    if (count > BOOT_MAX_STEPS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!boot_events) {
+        boot_events = xEventGroupCreate();
+        if (!boot_events) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    xEventGroupClearBits(boot_events, 0x00ffffff);
+    boot_aborted = false;
+
+    int64_t begin = esp_timer_get_time();
+    EventBits_t all = 0;
+    for (int i = 0; i < count; i++) {
+        states[i] = {};
+        states[i].step = &steps[i];
+        states[i].index = i;
+        states[i].result = ESP_ERR_TIMEOUT;
+        all |= BOOT_STEP_BIT(i);
+
+        uint32_t stack = steps[i].stack ? steps[i].stack : BOOT_STEP_STACK;
+        if (xTaskCreate(step_task, steps[i].name, stack, &states[i], 5, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to start step %s", steps[i].name);
+            xEventGroupSetBits(boot_events, BOOT_STEP_BIT(i) | BOOT_STEP_BIT(i + BOOT_FAIL_SHIFT));
+        }
+    }
+
+    EventBits_t done = xEventGroupWaitBits(boot_events, all, pdFALSE, pdTRUE, pdMS_TO_TICKS(timeout_ms));
+    ready_us = esp_timer_get_time();
+
+    esp_err_t ret = ESP_OK;
+    ESP_LOGI(TAG, "%-12s %8s %8s %8s  %s", "step", "start", "wait", "run", "status");
+    for (int i = 0; i < count; i++) {
+        const step_state_t* s = &states[i];
+        bool finished = done & BOOT_STEP_BIT(i);
+        ESP_LOGI(TAG, "%-12s %6lld ms %5lld ms %5lld ms  %s", steps[i].name, (long long)(s->start_us / 1000),
+                 (long long)(s->wait_us / 1000), (long long)((s->end_us - s->start_us) / 1000),
+                 !finished ? "timeout" : esp_err_to_name(s->result));
+        if (steps[i].required && (!finished || s->result != ESP_OK)) {
+            ret = ESP_FAIL;
+        }
+    }
+    if (ret != ESP_OK) {
+        boot_aborted = true;
+    }
+    ESP_LOGI(TAG, "init graph %lld ms, ready %lld ms after power-on", (long long)((ready_us - begin) / 1000),
+             (long long)(ready_us / 1000));
+    return ret;
+}
+
+int64_t boot_ready_us() {
+    return ready_us;
+}
@@ -0,0 +1,290 @@
+#include "bulk_transfer.h"
+
+#include <string.h>
+
+#define ATT_NOTIFY_OVERHEAD 3
+
+static void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xff;
+    p[1] = v >> 8;
+}
+
+static void put_u32(uint8_t* p, uint32_t v) {
+    put_u16(p, v & 0xffff);
+    put_u16(p + 2, v >> 16);
+}
+
+static uint16_t get_u16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+    return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+uint16_t bulk_chunk_size(uint16_t mtu) {
+    int size = mtu - ATT_NOTIFY_OVERHEAD - BULK_DATA_HEADER_SIZE;
+    if (size > BULK_MAX_FRAME - BULK_DATA_HEADER_SIZE) {
+        size = BULK_MAX_FRAME - BULK_DATA_HEADER_SIZE;
+    }
+    return size > 0 ? size : 1;
+}
+
+uint32_t bulk_crc32(uint32_t crc, const uint8_t* data, size_t len) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xedb88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+esp_err_t bulk_sender_init(bulk_sender_t* sender, uint8_t stream, uint8_t kind, uint32_t total_size,
+                           uint16_t chunk_size, uint8_t window, bulk_read_fn read, bulk_send_fn send, void* ctx) {
+    memset(sender, 0, sizeof(*sender));
+    if (chunk_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t chunks = total_size / chunk_size + (total_size % chunk_size != 0);
+    if (chunks > BULK_MAX_CHUNKS) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    sender->stream = stream;
+    sender->kind = kind;
+    sender->window = window > 0 ? window : 1;
+    sender->chunk_size = chunk_size;
+    sender->total_size = total_size;
+    sender->total_chunks = chunks;
+    sender->read = read;
+    sender->send = send;
+    sender->ctx = ctx;
+    return ESP_OK;
+}
+
+int bulk_sender_pump(bulk_sender_t* sender) {
+    uint8_t frame[BULK_MAX_FRAME];
+    int sent = 0;
+
+    while (!sender->done) {
+        size_t len;
+        if (!sender->start_sent) {
+            frame[0] = BULK_FRAME_START;
+            frame[1] = sender->stream;
+            frame[2] = sender->kind;
+            frame[3] = sender->window;
+            put_u32(frame + 4, sender->total_size);
+            put_u16(frame + 8, sender->chunk_size);
+            len = BULK_START_SIZE;
+        } else if (sender->next_seq < sender->total_chunks &&
+                   sender->next_seq < sender->acked_seq + sender->window) {
+            uint32_t offset = (uint32_t)sender->next_seq * sender->chunk_size;
+            size_t want = sender->total_size - offset < sender->chunk_size ? sender->total_size - offset
+                                                                             : sender->chunk_size;
+            frame[0] = BULK_FRAME_DATA;
+            frame[1] = sender->stream;
+            put_u16(frame + 2, sender->next_seq);
+            size_t got = sender->read(sender->ctx, offset, frame + BULK_DATA_HEADER_SIZE, want);
+            if (got != want) {
+                return sent;
+            }
+            len = BULK_DATA_HEADER_SIZE + got;
+        } else if (sender->next_seq == sender->total_chunks && !sender->end_sent &&
+                   sender->crc_seq == sender->total_chunks) {
+            frame[0] = BULK_FRAME_END;
+            frame[1] = sender->stream;
+            put_u16(frame + 2, sender->total_chunks);
+            put_u32(frame + 4, sender->crc);
+            len = BULK_END_SIZE;
+        } else {
+            break;
+        }
+
+        if (sender->send(sender->ctx, frame, len) != 0) {
+            break;
+        }
+        sent++;
+        sender->frames_sent++;
+
+        if (frame[0] == BULK_FRAME_START) {
+            sender->start_sent = true;
+        } else if (frame[0] == BULK_FRAME_DATA) {
+            // 처음 순서대로 보내는 청크만 CRC 에 반영
+            if (sender->next_seq == sender->crc_seq) {
+                sender->crc = bulk_crc32(sender->crc, frame + BULK_DATA_HEADER_SIZE, len - BULK_DATA_HEADER_SIZE);
+                sender->crc_seq++;
+            }
+            sender->next_seq++;
+        } else {
+            sender->end_sent = true;
+        }
+    }
+    return sent;
+}
+
+esp_err_t bulk_sender_on_frame(bulk_sender_t* sender, const uint8_t* frame, size_t len) {
+    if (len < BULK_ACK_SIZE || frame[1] != sender->stream) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint16_t seq = get_u16(frame + 2);
+    if (seq > sender->total_chunks) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    switch (frame[0]) {
+        case BULK_FRAME_ACK:
+            if (seq > sender->acked_seq) {
+                sender->acked_seq = seq;
+            }
+            return ESP_OK;
+
+        case BULK_FRAME_DONE:
+            sender->acked_seq = sender->total_chunks;
+            sender->done = true;
+            return ESP_OK;
+
+        case BULK_FRAME_NACK:
+            if (seq < sender->next_seq) {
+                sender->retransmits += sender->next_seq - seq;
+                sender->next_seq = seq;
+            }
+            sender->acked_seq = seq;
+            sender->end_sent = false;
+            return ESP_OK;
+
+        default:
+            return ESP_ERR_INVALID_ARG;
+    }
+}
+
+void bulk_sender_on_timeout(bulk_sender_t* sender) {
+    if (sender->done) {
+        return;
+    }
+    // START 확인 전이면 START 부터, 아니면 마지막 ACK 지점부터
+    if (sender->acked_seq == 0 && sender->next_seq == 0 && !sender->end_sent) {
+        sender->start_sent = false;
+    }
+    sender->retransmits += sender->next_seq - sender->acked_seq;
+    sender->next_seq = sender->acked_seq;
+    sender->end_sent = false;
+}
+
+void bulk_receiver_init(bulk_receiver_t* receiver, bulk_write_fn write, void* ctx) {
+    memset(receiver, 0, sizeof(*receiver));
+    receiver->write = write;
+    receiver->ctx = ctx;
+}
+
+static size_t make_ack(uint8_t* ack, uint8_t type, uint8_t stream, uint16_t seq) {
+    ack[0] = type;
+    ack[1] = stream;
+    put_u16(ack + 2, seq);
+    return BULK_ACK_SIZE;
+}
+
+size_t bulk_receiver_on_frame(bulk_receiver_t* receiver, const uint8_t* frame, size_t len, uint8_t* ack) {
+    if (len < 2) {
+        return 0;
+    }
+
+    switch (frame[0]) {
+        case BULK_FRAME_START:
+            if (len < BULK_START_SIZE) {
+                return 0;
+            }
+            // 같은 스트림의 START 재전송이면 상태를 유지한 채 다시 ACK
+            if (!receiver->started || receiver->stream != frame[1] || receiver->complete) {
+                receiver->stream = frame[1];
+                receiver->kind = frame[2];
+                receiver->window = frame[3] > 0 ? frame[3] : 1;
+                receiver->total_size = get_u32(frame + 4);
+                receiver->chunk_size = get_u16(frame + 8);
+                receiver->next_seq = 0;
+                receiver->crc = 0;
+                receiver->started = true;
+                receiver->complete = false;
+                receiver->failed = false;
+            }
+            receiver->since_ack = 0;
+            return make_ack(ack, BULK_FRAME_ACK, receiver->stream, receiver->next_seq);
+
+        case BULK_FRAME_DATA: {
+            if (!receiver->started || frame[1] != receiver->stream || len < BULK_DATA_HEADER_SIZE) {
+                return 0;
+            }
+            uint16_t seq = get_u16(frame + 2);
+            if (seq != receiver->next_seq) {
+                // 앞선 청크가 빠졌으면 한 번만 NACK
+                if (seq > receiver->next_seq) {
+                    if (receiver->since_ack == UINT16_MAX) {
+                        return 0;
+                    }
+                    receiver->since_ack = UINT16_MAX;
+                    return make_ack(ack, BULK_FRAME_NACK, receiver->stream, receiver->next_seq);
+                }
+                // 중복 청크: ACK 가 유실된 것이므로 현재 위치를 다시 알린다
+                return make_ack(ack, BULK_FRAME_ACK, receiver->stream, receiver->next_seq);
+            }
+
+            size_t payload = len - BULK_DATA_HEADER_SIZE;
+            uint32_t offset = (uint32_t)seq * receiver->chunk_size;
+            if (offset + payload > receiver->total_size) {
+                receiver->failed = true;
+                return 0;
+            }
+            receiver->write(receiver->ctx, offset, frame + BULK_DATA_HEADER_SIZE, payload);
+            receiver->crc = bulk_crc32(receiver->crc, frame + BULK_DATA_HEADER_SIZE, payload);
+            receiver->next_seq++;
+            if (receiver->since_ack == UINT16_MAX) {
+                receiver->since_ack = 0;
+            }
+            if (++receiver->since_ack >= (receiver->window + 1) / 2) {
+                receiver->since_ack = 0;
+                return make_ack(ack, BULK_FRAME_ACK, receiver->stream, receiver->next_seq);
+            }
+            return 0;
+        }
+
+        case BULK_FRAME_END: {
+            if (!receiver->started || frame[1] != receiver->stream || len < BULK_END_SIZE) {
+                return 0;
+            }
+            uint16_t chunks = get_u16(frame + 2);
+            if (chunks != receiver->next_seq) {
+                return make_ack(ack, BULK_FRAME_NACK, receiver->stream, receiver->next_seq);
+            }
+            if (get_u32(frame + 4) != receiver->crc) {
+                // CRC 불일치: 처음부터 다시 받는다
+                receiver->next_seq = 0;
+                receiver->crc = 0;
+                receiver->crc_errors++;
+                return make_ack(ack, BULK_FRAME_NACK, receiver->stream, 0);
+            }
+            receiver->complete = true;
+            return make_ack(ack, BULK_FRAME_DONE, receiver->stream, receiver->next_seq);
+        }
+
+        default:
+            return 0;
+    }
+}
+
+size_t bulk_encode_request(uint8_t* frame, uint8_t kind, uint32_t arg) {
+    frame[0] = BULK_FRAME_REQUEST;
+    frame[1] = kind;
+    put_u16(frame + 2, 0);
+    put_u32(frame + 4, arg);
+    return BULK_REQUEST_SIZE;
+}
+
+esp_err_t bulk_decode_request(const uint8_t* frame, size_t len, uint8_t* kind, uint32_t* arg) {
+    if (len < BULK_REQUEST_SIZE || frame[0] != BULK_FRAME_REQUEST) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *kind = frame[1];
+    *arg = get_u32(frame + 4);
+    return ESP_OK;
+}
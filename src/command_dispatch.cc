@@ -0,0 +1,295 @@
+#include "command_dispatch.h"
+#include "audio_processing.h"
+#include "data_paths.h"
+#include "mem_arena.h"
+#include "model_inference.h"
+#include "record_store.h"
+#include "request_scheduler.h"
+#include "continuous_mode.h"
+#include "metrics.h"
+#include "power_mgmt.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define STREAM_RESULTS_DEFAULT 16
+#define RECORD_STREAM_MAX 1000
+#define CONTINUOUS_MAX 10000
+#define NO_SEQ 0xffffffff
+
+static const char* TAG = "CMD";
+
+static SemaphoreHandle_t pipeline_lock;
+static uint32_t runs;
+
+typedef struct __attribute__((packed)) {
+    int8_t result;
+    uint32_t seq;
+} classify_reply_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t seq;
+    int8_t result;
+    int64_t timestamp_us;
+} result_entry_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t clip;
+    int8_t result;
+    uint32_t seq;
+    uint32_t latency_ms;
+} clip_reply_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t index;
+    int8_t result;
+    uint32_t window_end_ms;
+    uint32_t dsp_us;
+    uint32_t classify_us;
+} window_reply_t;
+
+typedef struct {
+    cmd_reply_fn reply;
+    void* ctx;
+} reply_target_t;
+
+// 녹음 / 특징 추출 / 추론은 모두 pipeline_lock 안에서 돌므로 그 동안 최대 클럭
+static void lock_pipeline() {
+    xSemaphoreTake(pipeline_lock, portMAX_DELAY);
+    power_busy_begin();
+}
+
+static void unlock_pipeline() {
+    power_busy_end();
+    xSemaphoreGive(pipeline_lock);
+}
+
+static void send_reply(cmd_reply_fn reply, void* ctx, uint8_t cmd, uint8_t status, const void* data, size_t len) {
+    uint8_t frame[CMD_MAX_PAYLOAD + CMD_FRAME_OVERHEAD];
+    size_t n = cmd_encode_reply(frame, sizeof(frame), cmd, status, data, len);
+    if (n > 0) {
+        reply(ctx, cmd, status, frame, n);
+    }
+}
+
+esp_err_t init_command_dispatch() {
+    if (!pipeline_lock) {
+        pipeline_lock = xSemaphoreCreateMutex();
+    }
+    return pipeline_lock ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+static void run_classify(const cmd_frame_t* req, cmd_reply_fn reply, void* ctx) {
+    char path[DATA_PATH_MAX];
+    char name[DATA_PATH_MAX];
+
+    if (req->cmd == CMD_CLASSIFY && req->len > 0) {
+        if (req->len >= sizeof(name) || memchr(req->payload, '/', req->len)) {
+            send_reply(reply, ctx, req->cmd, CMD_STATUS_BAD_ARG, NULL, 0);
+            return;
+        }
+        memcpy(name, req->payload, req->len);
+        name[req->len] = '\0';
+    } else {
+        strcpy(name, AUDIO_FILE_NAME);
+    }
+
+    send_reply(reply, ctx, req->cmd, CMD_STATUS_PENDING, NULL, 0);
+
+    lock_pipeline();
+    uint32_t next_seq = record_store_next_seq();
+    if (req->cmd == CMD_RECORD) {
+        recordAudio();
+    }
+    const char* answer = pipeline_file(data_path(path, sizeof(path), name));
+    if (runs++ == 0) {
+        ESP_LOGI(TAG, "first result %lld ms after power-on", (long long)(esp_timer_get_time() / 1000));
+    }
+    classify_reply_t out;
+    out.result = (int8_t)atoi(answer);
+    out.seq = record_store_is_open() && record_store_next_seq() != next_seq ? next_seq : NO_SEQ;
+    unlock_pipeline();
+
+    uint8_t status = CMD_STATUS_OK;
+    if (out.result < 0) {
+        status = CMD_STATUS_FAILED;
+    } else if (out.result == RESULT_STAGE1_ONLY) {
+        status = CMD_STATUS_STAGE1_ONLY;
+    }
+    send_reply(reply, ctx, req->cmd, status, &out, sizeof(out));
+}
+
+static void get_stats(const cmd_frame_t* req, cmd_reply_fn reply, void* ctx) {
+    const pipeline_timing_t* t = pipeline_last_timing();
+    cmd_stats_t stats = {};
+
+    stats.runs = runs;
+    stats.last_total_us = t->total_us;
+    for (int i = 0; i < t->stages_run && i < 2; i++) {
+        stats.feature_us[i] = t->stage[i].feature_us;
+        stats.invoke_us[i] = t->stage[i].invoke_us;
+    }
+    stats.internal_peak = internal_arena()->last_request_peak;
+    stats.psram_peak = psram_arena()->last_request_peak;
+    stats.store_oldest_seq = record_store_oldest_seq();
+    stats.store_next_seq = record_store_next_seq();
+    send_reply(reply, ctx, req->cmd, CMD_STATUS_OK, &stats, sizeof(stats));
+}
+
+static void stream_results(const cmd_frame_t* req, cmd_reply_fn reply, void* ctx) {
+    uint32_t from = record_store_oldest_seq();
+    uint16_t max_count = STREAM_RESULTS_DEFAULT;
+
+    if (!record_store_is_open()) {
+        send_reply(reply, ctx, req->cmd, CMD_STATUS_FAILED, NULL, 0);
+        return;
+    }
+    if (req->len >= 4) {
+        memcpy(&from, req->payload, 4);
+    }
+    if (req->len >= 6) {
+        memcpy(&max_count, req->payload + 4, 2);
+    }
+    if (from < record_store_oldest_seq()) {
+        from = record_store_oldest_seq();
+    }
+
+    uint16_t count = 0;
+    for (uint32_t seq = from; seq < record_store_next_seq() && count < max_count; seq++) {
+        store_entry_t entry;
+        if (record_store_lookup(seq, &entry) != ESP_OK) {
+            continue;
+        }
+        result_entry_t out = {entry.seq, entry.result, entry.timestamp_us};
+        send_reply(reply, ctx, req->cmd, CMD_STATUS_MORE, &out, sizeof(out));
+        count++;
+    }
+    send_reply(reply, ctx, req->cmd, CMD_STATUS_OK, &count, sizeof(count));
+}
+
+static void on_clip_result(void* arg, const sched_result_t* result) {
+    reply_target_t* target = (reply_target_t*)arg;
+    clip_reply_t out = {result->clip, result->result, result->seq, result->latency_us / 1000};
+    send_reply(target->reply, target->ctx, CMD_RECORD_STREAM, CMD_STATUS_MORE, &out, sizeof(out));
+}
+
+static void record_stream(const cmd_frame_t* req, cmd_reply_fn reply, void* ctx) {
+    uint16_t clips = 1;
+    if (req->len >= 2) {
+        memcpy(&clips, req->payload, 2);
+    }
+    if (!scheduler_ready() || clips == 0 || clips > RECORD_STREAM_MAX) {
+        send_reply(reply, ctx, req->cmd, scheduler_ready() ? CMD_STATUS_BAD_ARG : CMD_STATUS_FAILED, NULL, 0);
+        return;
+    }
+
+    send_reply(reply, ctx, req->cmd, CMD_STATUS_PENDING, NULL, 0);
+
+    // 스트림 동안 다른 분류 요청은 대기, 스케줄러 안에서는 녹음과 처리가 겹친다
+    reply_target_t target = {reply, ctx};
+    lock_pipeline();
+    scheduler_run(clips, on_clip_result, &target);
+    runs += clips;
+    unlock_pipeline();
+
+    sched_stats_t stats;
+    scheduler_get_stats(&stats);
+    send_reply(reply, ctx, req->cmd, CMD_STATUS_OK, &stats, sizeof(stats));
+}
+
+static void on_window_result(void* arg, const continuous_result_t* result) {
+    reply_target_t* target = (reply_target_t*)arg;
+    window_reply_t out = {result->index, result->result, result->window_end_ms, result->dsp_us, result->classify_us};
+    send_reply(target->reply, target->ctx, CMD_CONTINUOUS, CMD_STATUS_MORE, &out, sizeof(out));
+}
+
+static void continuous(const cmd_frame_t* req, cmd_reply_fn reply, void* ctx) {
+    uint16_t interval_ms = CONTINUOUS_DEFAULT_INTERVAL_MS;
+    uint16_t count = 1;
+    if (req->len >= 2) {
+        memcpy(&interval_ms, req->payload, 2);
+    }
+    if (req->len >= 4) {
+        memcpy(&count, req->payload + 2, 2);
+    }
+    if (!continuous_ready() || count == 0 || count > CONTINUOUS_MAX) {
+        send_reply(reply, ctx, req->cmd, continuous_ready() ? CMD_STATUS_BAD_ARG : CMD_STATUS_FAILED, NULL, 0);
+        return;
+    }
+
+    send_reply(reply, ctx, req->cmd, CMD_STATUS_PENDING, NULL, 0);
+
+    reply_target_t target = {reply, ctx};
+    lock_pipeline();
+    continuous_run(interval_ms, count, on_window_result, &target);
+    runs += count;
+    unlock_pipeline();
+
+    continuous_stats_t stats;
+    continuous_get_stats(&stats);
+    send_reply(reply, ctx, req->cmd, CMD_STATUS_OK, &stats, sizeof(stats));
+}
+
+static void get_metrics(const cmd_frame_t* req, cmd_reply_fn reply, void* ctx) {
+    uint8_t out[CMD_MAX_PAYLOAD - 1];
+    size_t len;
+
+    if (req->len >= 1) {
+        uint8_t hist = req->payload[0];
+        if (hist >= METRIC_HIST_COUNT) {
+            send_reply(reply, ctx, req->cmd, CMD_STATUS_BAD_ARG, NULL, 0);
+            return;
+        }
+        uint32_t buckets[METRICS_HIST_BUCKETS];
+        metrics_hist_buckets((metric_hist_t)hist, buckets);
+        out[0] = hist;
+        memcpy(out + 1, buckets, sizeof(buckets));
+        len = 1 + sizeof(buckets);
+    } else {
+        metrics_refresh_system();
+        len = metrics_encode(out, sizeof(out), esp_timer_get_time() / 1000);
+    }
+    send_reply(reply, ctx, req->cmd, CMD_STATUS_OK, out, len);
+}
+
+void command_dispatch(const cmd_frame_t* request, cmd_reply_fn reply, void* ctx) {
+    ESP_LOGI(TAG, "command 0x%02x, %d bytes", request->cmd, request->len);
+    metrics_add(METRIC_COMMANDS);
+
+    switch (request->cmd) {
+        case CMD_RECORD:
+        case CMD_CLASSIFY:
+            run_classify(request, reply, ctx);
+            break;
+        case CMD_GET_STATS:
+            get_stats(request, reply, ctx);
+            break;
+        case CMD_STREAM_RESULTS:
+            stream_results(request, reply, ctx);
+            break;
+        case CMD_RECORD_STREAM:
+            record_stream(request, reply, ctx);
+            break;
+        case CMD_GET_SCHED_STATS: {
+            sched_stats_t stats;
+            scheduler_get_stats(&stats);
+            send_reply(reply, ctx, request->cmd, CMD_STATUS_OK, &stats, sizeof(stats));
+            break;
+        }
+        case CMD_CONTINUOUS:
+            continuous(request, reply, ctx);
+            break;
+        case CMD_GET_METRICS:
+            get_metrics(request, reply, ctx);
+            break;
+        default:
+            ESP_LOGW(TAG, "unknown command 0x%02x", request->cmd);
+            send_reply(reply, ctx, request->cmd, CMD_STATUS_UNKNOWN, NULL, 0);
+            break;
+    }
+}
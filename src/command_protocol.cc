@@ -0,0 +1,141 @@
+#include "command_protocol.h"
+#include "metrics.h"
+
+#include <string.h>
+
+uint16_t cmd_crc16(uint16_t crc, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+size_t cmd_encode(uint8_t* out, size_t cap, uint8_t cmd, const uint8_t* payload, size_t len) {
+    if (len > CMD_MAX_PAYLOAD || cap < len + CMD_FRAME_OVERHEAD) {
+        return 0;
+    }
+
+    out[0] = CMD_SYNC;
+    out[1] = cmd;
+    out[2] = len & 0xff;
+    out[3] = len >> 8;
+    if (len > 0) {
+        memcpy(out + CMD_HEADER_SIZE, payload, len);
+    }
+    uint16_t crc = cmd_crc16(0xffff, out + 1, CMD_HEADER_SIZE - 1 + len);
+    out[CMD_HEADER_SIZE + len] = crc & 0xff;
+    out[CMD_HEADER_SIZE + len + 1] = crc >> 8;
+    return len + CMD_FRAME_OVERHEAD;
+}
+
+size_t cmd_encode_reply(uint8_t* out, size_t cap, uint8_t cmd, uint8_t status, const void* data, size_t len) {
+    uint8_t payload[CMD_MAX_PAYLOAD];
+    if (len + 1 > CMD_MAX_PAYLOAD) {
+        return 0;
+    }
+    payload[0] = status;
+    if (len > 0) {
+        memcpy(payload + 1, data, len);
+    }
+    return cmd_encode(out, cap, cmd | CMD_REPLY_FLAG, payload, len + 1);
+}
+
+int cmd_send_fragmented(const uint8_t* frame, size_t len, size_t chunk, cmd_send_fn send, void* ctx) {
+    if (chunk == 0) {
+        return -1;
+    }
+    for (size_t offset = 0; offset < len; offset += chunk) {
+        int rc = send(ctx, frame + offset, len - offset < chunk ? len - offset : chunk);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    return 0;
+}
+
+bool cmd_status_is_result(uint8_t status) {
+    return status == CMD_STATUS_OK || status == CMD_STATUS_STAGE1_ONLY || status == CMD_STATUS_FAILED;
+}
+
+int cmd_legacy_result(uint8_t status, const uint8_t* frame, size_t len) {
+    if (status == CMD_STATUS_STAGE1_ONLY) {
+        return CMD_LEGACY_NO_CLASS;
+    }
+    return len > CMD_HEADER_SIZE + 1 ? (int8_t)frame[CMD_HEADER_SIZE + 1] : -1;
+}
+
+void cmd_parser_reset(cmd_parser_t* parser) {
+    parser->count = 0;
+    parser->consumed = 0;
+}
+
+bool cmd_parser_idle(const cmd_parser_t* parser) {
+    return parser->count == parser->consumed;
+}
+
+// raw[from..] 의 다음 동기 바이트를 맨 앞으로, 없으면 모두 버린다
+static void resync(cmd_parser_t* parser, uint16_t from) {
+    uint16_t i = from;
+    while (i < parser->count && parser->raw[i] != CMD_SYNC) {
+        i++;
+    }
+    memmove(parser->raw, parser->raw + i, parser->count - i);
+    parser->count -= i;
+}
+
+// 앞에서 이미 돌려준 프레임을 버리고, 남은 바이트는 다음 동기 바이트부터
+static void discard_consumed(cmd_parser_t* parser) {
+    if (parser->consumed > 0) {
+        uint16_t consumed = parser->consumed;
+        parser->consumed = 0;
+        resync(parser, consumed);
+    }
+}
+
+// 맨 앞의 완전한 프레임 하나를 꺼낸다, raw[0] 은 항상 동기 바이트
+static bool scan(cmd_parser_t* parser, cmd_frame_t* frame) {
+    while (parser->count >= CMD_HEADER_SIZE) {
+        uint16_t len = parser->raw[2] | (parser->raw[3] << 8);
+        // 길이가 말이 안 되면 다음 동기 바이트부터 다시 찾는다
+        if (len > CMD_MAX_PAYLOAD) {
+            resync(parser, 1);
+            continue;
+        }
+        if (parser->count < len + CMD_FRAME_OVERHEAD) {
+            return false;
+        }
+
+        uint16_t crc = cmd_crc16(0xffff, parser->raw + 1, CMD_HEADER_SIZE - 1 + len);
+        const uint8_t* tail = parser->raw + CMD_HEADER_SIZE + len;
+        if (crc != (tail[0] | (tail[1] << 8))) {
+            parser->crc_errors++;
+            metrics_add(METRIC_CMD_CRC_ERRORS);
+            resync(parser, 1);
+            continue;
+        }
+        frame->cmd = parser->raw[1];
+        frame->len = len;
+        frame->payload = parser->raw + CMD_HEADER_SIZE;
+        parser->consumed = len + CMD_FRAME_OVERHEAD;
+        return true;
+    }
+    return false;
+}
+
+bool cmd_parser_push(cmd_parser_t* parser, uint8_t byte, cmd_frame_t* frame) {
+    discard_consumed(parser);
+    if (parser->count == 0 && byte != CMD_SYNC) {
+        return false;
+    }
+    // 프레임 하나가 완성되거나 resync 로 줄어들기 전에는 가득 차지 않는다
+    parser->raw[parser->count++] = byte;
+    return scan(parser, frame);
+}
+
+bool cmd_parser_poll(cmd_parser_t* parser, cmd_frame_t* frame) {
+    discard_consumed(parser);
+    return scan(parser, frame);
+}
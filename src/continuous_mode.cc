@@ -0,0 +1,255 @@
+#include "continuous_mode.h"
+#include "audio_processing.h"
+#include "mem_arena.h"
+#include "mem_placement.h"
+#include "model_inference.h"
+#include "metrics.h"
+#include "rolling_features.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define CAPTURE_TASK_STACK 3072
+#define PROCESS_TASK_STACK 8192
+#define FRAME_SCRATCH_SIZE (8 * 1024)
+// 처리가 밀렸을 때 녹음을 계속 받아 버리는 청크
+#define DISCARD_CHUNK CONTINUOUS_CHUNKS
+// filled_queue 에 넣으면 처리 태스크가 그 앞의 청크를 모두 소비했음을 알린다
+#define FLUSH_MARKER 0xff
+
+static const char* TAG = "CONTINUOUS";
+
+typedef struct {
+    uint8_t index;
+    bool start;         // 이번 실행의 첫 청크
+    bool gap;           // 직전 청크와 이어지지 않음 (창을 다시 채운다)
+    uint32_t end_ms;    // 실행 시작 후 이 청크 끝까지의 녹음 시간 (버린 청크 포함)
+} chunk_msg_t;
+
+static int16_t* chunks[CONTINUOUS_CHUNKS + 1];
+static rolling_features_t rolling;
+static mem_arena_t frame_scratch;
+static clip_features_t features;
+static QueueHandle_t start_queue;
+static QueueHandle_t free_queue;
+static QueueHandle_t filled_queue;
+static QueueHandle_t result_queue;
+static SemaphoreHandle_t capture_idle;
+static SemaphoreHandle_t flushed;
+static volatile bool running;
+static uint32_t interval_frames;
+
+static uint32_t classifications;
+static uint32_t frames;
+static uint32_t overruns;
+static int64_t dsp_us;
+static int64_t classify_us;
+
+static void capture_task(void* arg) {
+    uint8_t token;
+
+    while (1) {
+        if (xQueueReceive(start_queue, &token, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        int64_t next_sample_us = 0;
+        uint64_t recorded = 0;
+        bool start = true;
+        bool gap = true;
+        while (running) {
+            uint8_t index;
+            if (xQueueReceive(free_queue, &index, 0) != pdTRUE) {
+                // 빈 청크가 없으면 샘플 간격을 유지하려고 녹음은 계속하되 버린다
+                overruns++;
+                metrics_add(METRIC_CLIPS_DROPPED);
+                gap = true;
+                recorded += record_samples(chunks[DISCARD_CHUNK], CONTINUOUS_CHUNK_SAMPLES, &next_sample_us);
+            } else {
+                recorded += record_samples(chunks[index], CONTINUOUS_CHUNK_SAMPLES, &next_sample_us);
+                chunk_msg_t msg = {index, start, gap, (uint32_t)(recorded * 1000 / SAMPLE_RATE)};
+                start = false;
+                gap = false;
+                xQueueSend(filled_queue, &msg, portMAX_DELAY);
+            }
+
+            // idle 태스크(WDT)에 한 틱 양보, 밀린 샘플은 next_sample_us 기준으로 바로 따라잡는다
+            vTaskDelay(1);
+        }
+        xSemaphoreGive(capture_idle);
+    }
+}
+
+static void classify_window(uint32_t* index, uint32_t end_ms, int64_t* pending_dsp_us) {
+    int64_t begin = esp_timer_get_time();
+    int8_t result = -1;
+    if (rolling_clip_features(&rolling, &features) == ESP_OK) {
+        result = (int8_t)atoi(pipeline_clip(&features, NULL, 0, NULL));
+    }
+    int64_t elapsed = esp_timer_get_time() - begin;
+
+    continuous_result_t out;
+    out.index = (*index)++;
+    out.result = result;
+    out.window_end_ms = end_ms;
+    out.dsp_us = *pending_dsp_us;
+    out.classify_us = elapsed;
+    *pending_dsp_us = 0;
+
+    classifications++;
+    classify_us += elapsed;
+    xQueueSend(result_queue, &out, portMAX_DELAY);
+}
+
+static void process_task(void* arg) {
+    uint32_t since_result = 0;
+    uint32_t index = 0;
+    int64_t pending_dsp_us = 0;
+
+    while (1) {
+        chunk_msg_t msg;
+        if (xQueueReceive(filled_queue, &msg, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        if (msg.index == FLUSH_MARKER) {
+            xSemaphoreGive(flushed);
+            continue;
+        }
+        if (msg.start) {
+            index = 0;
+        }
+        if (msg.gap) {
+            rolling_reset(&rolling);
+            since_result = 0;
+            pending_dsp_us = 0;
+        }
+
+        int64_t begin = esp_timer_get_time();
+        int added = rolling_push(&rolling, chunks[msg.index], CONTINUOUS_CHUNK_SAMPLES, &frame_scratch);
+        int64_t elapsed = esp_timer_get_time() - begin;
+        xQueueSend(free_queue, &msg.index, 0);
+
+        metrics_observe(METRIC_HIST_FRAME_DSP, elapsed);
+        frames += added;
+        dsp_us += elapsed;
+        pending_dsp_us += elapsed;
+        since_result += added;
+
+        // 창이 찬 뒤로는 interval 만큼 새 프레임이 쌓일 때마다 한 번 분류
+        if (running && rolling_full(&rolling) && since_result >= interval_frames) {
+            since_result = 0;
+            classify_window(&index, msg.end_ms, &pending_dsp_us);
+        }
+    }
+}
+
+esp_err_t init_continuous() {
+    if (start_queue) {
+        return ESP_OK;
+    }
+
+    start_queue = xQueueCreate(1, sizeof(uint8_t));
+    free_queue = xQueueCreate(CONTINUOUS_CHUNKS, sizeof(uint8_t));
+    filled_queue = xQueueCreate(CONTINUOUS_CHUNKS + 1, sizeof(chunk_msg_t));
+    result_queue = xQueueCreate(4, sizeof(continuous_result_t));
+    capture_idle = xSemaphoreCreateBinary();
+    flushed = xSemaphoreCreateBinary();
+    if (!start_queue || !free_queue || !filled_queue || !result_queue || !capture_idle || !flushed) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    int window_frames = CLIP_FRAMES(CONTINUOUS_WINDOW_MS * SAMPLE_RATE / 1000);
+    size_t rolling_size = (size_t)window_frames * NUM_MEL_FILTERS * sizeof(float) + 2 * sizeof(delta_stats_t);
+    esp_err_t ret = rolling_init(&rolling, window_frames, mem_place_caps(MEM_AUDIO, rolling_size));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = mem_arena_init(&frame_scratch, "frame", FRAME_SCRATCH_SIZE,
+                         mem_place_caps(MEM_FRAME_SCRATCH, FRAME_SCRATCH_SIZE));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    for (uint8_t i = 0; i <= CONTINUOUS_CHUNKS; i++) {
+        chunks[i] = (int16_t*)mem_place_alloc(MEM_AUDIO, CONTINUOUS_CHUNK_SAMPLES * sizeof(int16_t));
+        if (!chunks[i]) {
+            ESP_LOGE(TAG, "Failed to allocate chunk %d", i);
+            return ESP_ERR_NO_MEM;
+        }
+        if (i < CONTINUOUS_CHUNKS) {
+            xQueueSend(free_queue, &i, 0);
+        }
+    }
+
+    // 녹음(바쁜 대기)은 코어 1, 프레임 DSP 와 추론은 코어 0
+    if (xTaskCreatePinnedToCore(capture_task, "cont_capture", CAPTURE_TASK_STACK, NULL, 6, NULL, 1) != pdPASS ||
+        xTaskCreatePinnedToCore(process_task, "cont_process", PROCESS_TASK_STACK, NULL, 5, NULL, 0) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "continuous mode ready: %d ms window (%d frames), %d x %d sample chunks", CONTINUOUS_WINDOW_MS,
+             rolling.capacity, CONTINUOUS_CHUNKS, CONTINUOUS_CHUNK_SAMPLES);
+    return ESP_OK;
+}
+
+bool continuous_ready() {
+    return start_queue != NULL;
+}
+
+esp_err_t continuous_run(uint16_t interval_ms, uint16_t count, continuous_result_fn on_result, void* ctx) {
+    if (!start_queue) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (count == 0) {
+        return ESP_OK;
+    }
+
+    interval_frames = (uint32_t)interval_ms * SAMPLE_RATE / 1000 / FRAME_STEP;
+    if (interval_frames == 0) {
+        interval_frames = 1;
+    }
+    xQueueReset(result_queue);
+
+    uint8_t token = 0;
+    running = true;
+    xQueueSend(start_queue, &token, portMAX_DELAY);
+    for (uint16_t i = 0; i < count; i++) {
+        continuous_result_t result;
+        xQueueReceive(result_queue, &result, portMAX_DELAY);
+        on_result(ctx, &result);
+    }
+
+    // 녹음을 멈추고 이미 받은 청크를 처리 태스크가 모두 소비할 때까지 기다린다
+    running = false;
+    xSemaphoreTake(capture_idle, portMAX_DELAY);
+    chunk_msg_t marker = {FLUSH_MARKER, false, false, 0};
+    xQueueSend(filled_queue, &marker, portMAX_DELAY);
+    // 그 사이 끝난 창의 결과는 버린다 (비우지 않으면 처리 태스크가 result_queue 에서 막혀 flush 가 오지 않는다)
+    while (xSemaphoreTake(flushed, 0) != pdTRUE) {
+        continuous_result_t late;
+        xQueueReceive(result_queue, &late, pdMS_TO_TICKS(10));
+    }
+    xQueueReset(result_queue);
+
+    continuous_stats_t stats;
+    continuous_get_stats(&stats);
+    ESP_LOGI(TAG, "run of %u classifications done: %u us/frame DSP, %u us/classification, %u overruns", count,
+             (unsigned)stats.frame_dsp_us, (unsigned)stats.classify_us, (unsigned)stats.overruns);
+    return ESP_OK;
+}
+
+void continuous_get_stats(continuous_stats_t* stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->classifications = classifications;
+    stats->frames = frames;
+    stats->overruns = overruns;
+    stats->frame_dsp_us = frames ? dsp_us / frames : 0;
+    stats->classify_us = classifications ? classify_us / classifications : 0;
+}
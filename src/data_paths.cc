@@ -0,0 +1,27 @@
+#include "data_paths.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static char data_root[DATA_PATH_MAX] = DEFAULT_DATA_ROOT;
+
+void set_data_root(const char* root) {
+    size_t len = strlen(root);
+    while (len > 1 && root[len - 1] == '/') {
+        len--;
+    }
+    if (len >= sizeof(data_root)) {
+        len = sizeof(data_root) - 1;
+    }
+    memcpy(data_root, root, len);
+    data_root[len] = '\0';
+}
+
+const char* get_data_root() {
+    return data_root;
+}
+
+const char* data_path(char* buf, size_t len, const char* name) {
+    snprintf(buf, len, "%s/%s", data_root, name);
+    return buf;
+}
@@ -0,0 +1,178 @@
+#include "delta_features.h"
+#include "esp_log.h"
+
+#include <math.h>
+#include <string.h>
+
+static const char* TAG = "DELTA";
+
+esp_err_t delta_kernel_init(delta_kernel_t* kernel, int width) {
+    if (width < 3 || width > DELTA_MAX_WIDTH || width % 2 == 0) {
+        ESP_LOGE(TAG, "Unsupported delta width %d", width);
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(kernel, 0, sizeof(*kernel));
+    kernel->width = width;
+    kernel->half = width / 2;
+
+    float s2 = 0.0f;
+    for (int n = -kernel->half; n <= kernel->half; n++) {
+        s2 += (float)(n * n);
+    }
+    float c = s2 / width;
+    float q2 = 0.0f;
+    for (int n = -kernel->half; n <= kernel->half; n++) {
+        q2 += (n * n - c) * (n * n - c);
+    }
+    for (int n = -kernel->half; n <= kernel->half; n++) {
+        kernel->w1[n + kernel->half] = n / s2;
+        kernel->w2[n + kernel->half] = 2.0f * (n * n - c) / q2;
+    }
+    return ESP_OK;
+}
+
+void delta_frame(const delta_kernel_t* kernel, const float* const* frames, float* d1, float* d2) {
+    memset(d1, 0, NUM_MEL_FILTERS * sizeof(float));
+    memset(d2, 0, NUM_MEL_FILTERS * sizeof(float));
+    for (int i = 0; i < kernel->width; i++) {
+        const float* x = frames[i];
+        float w1 = kernel->w1[i];
+        float w2 = kernel->w2[i];
+        for (int j = 0; j < NUM_MEL_FILTERS; j++) {
+            d1[j] += w1 * x[j];
+            d2[j] += w2 * x[j];
+        }
+    }
+}
+
+void delta_stats_reset(delta_stats_t* stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+void delta_stats_update(delta_stats_t* stats, const float* d1, const float* d2, float sign) {
+    const float* d[2] = {d1, d2};
+    for (int o = 0; o < 2; o++) {
+        float* sum = stats->sum[o];
+        float* cross = stats->cross[o];
+        const float* x = d[o];
+        for (int i = 0; i < NUM_MEL_FILTERS; i++) {
+            sum[i] += sign * x[i];
+            float xi = sign * x[i];
+            for (int j = i; j < NUM_MEL_FILTERS; j++) {
+                *cross++ += xi * x[j];
+            }
+        }
+    }
+    stats->count += sign > 0 ? 1 : -1;
+}
+
+// 계수 k 의 DCT 행 m 에 대해 m . mean 과 m^T E[x x^T] m 으로 분산 계산
+static float coefficient_std(const float* sum, const float* cross, int count, const float* m) {
+    float mean = 0.0f;
+    float second = 0.0f;
+    for (int i = 0; i < NUM_MEL_FILTERS; i++) {
+        mean += m[i] * sum[i];
+        // 위 삼각 행 i 는 대각 원소 한 번, 나머지는 대칭이므로 두 번
+        float row = cross[0] * m[i];
+        for (int j = 1; j < NUM_MEL_FILTERS - i; j++) {
+            row += 2.0f * cross[j] * m[i + j];
+        }
+        second += m[i] * row;
+        cross += NUM_MEL_FILTERS - i;
+    }
+    mean /= count;
+    float variance = second / count - mean * mean;
+    return variance > 0.0f ? sqrtf(variance) : 0.0f;
+}
+
+esp_err_t delta_stats_std(const delta_stats_t* stats, int n_mfcc, feature_slice_t delta, feature_slice_t delta2) {
+    if (n_mfcc > MAX_MFCC || n_mfcc < NUM_MEL_FILTERS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    feature_slice_t out[2] = {delta, delta2};
+    float m[NUM_MEL_FILTERS];
+    for (int k = 0; k < n_mfcc; k++) {
+        // dsps_dct_f32 와 같은 비정규화 DCT-II, n >= NUM_MEL_FILTERS 는 0 으로 채워진 입력
+        for (int n = 0; n < NUM_MEL_FILTERS; n++) {
+            m[n] = cosf((float)M_PI / n_mfcc * (n + 0.5f) * k);
+        }
+        for (int o = 0; o < 2; o++) {
+            out[o].data[k * out[o].stride] =
+                stats->count > 0 ? coefficient_std(stats->sum[o], stats->cross[o], stats->count, m) : 0.0f;
+        }
+    }
+    return ESP_OK;
+}
+
+// 중심 프레임 center 의 delta 를 링에서 계산해 누적, [0, last] 밖은 끝 프레임 복제
+static void emit_delta(const delta_kernel_t* kernel, const float* ring, int center, int last, delta_stats_t* stats) {
+    const float* frames[DELTA_MAX_WIDTH];
+    float d1[NUM_MEL_FILTERS];
+    float d2[NUM_MEL_FILTERS];
+    for (int i = 0; i < kernel->width; i++) {
+        int t = center + i - kernel->half;
+        t = t < 0 ? 0 : t > last ? last : t;
+        frames[i] = ring + (size_t)(t % kernel->width) * NUM_MEL_FILTERS;
+    }
+    delta_frame(kernel, frames, d1, d2);
+    delta_stats_update(stats, d1, d2, 1.0f);
+}
+
+esp_err_t scan_clip_logmel(const int16_t* audio_data, size_t audio_size, clip_logmel_t* out, mem_arena_t* scratch,
+                           const bool* cancel) {
+    delta_kernel_t kernel;
+    esp_err_t ret = delta_kernel_init(&kernel, DELTA_WIDTH);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (!scratch) {
+        scratch = internal_arena();
+    }
+    ArenaBuffer<float> frame_real(scratch, FRAME_LENGTH);
+    ArenaBuffer<float> frame_imag(scratch, FRAME_LENGTH);
+    ArenaBuffer<float> ring(scratch, (size_t)kernel.width * NUM_MEL_FILTERS);
+    if (!frame_real || !frame_imag || !ring) {
+        ESP_LOGE(TAG, "Failed to allocate frame buffers");
+        return ESP_ERR_NO_MEM;
+    }
+
+    double sum[NUM_MEL_FILTERS] = {0};
+    delta_stats_reset(&out->deltas);
+    int frames = 0;
+
+    // 중심 프레임의 delta 는 half 프레임 뒤가 들어오면 확정
+    for (size_t i = 0; i + FRAME_LENGTH < audio_size; i += FRAME_STEP) {
+        if (cancel && __atomic_load_n(cancel, __ATOMIC_ACQUIRE)) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        float* mel = ring.get() + (size_t)(frames % kernel.width) * NUM_MEL_FILTERS;
+        logmel_frame(audio_data + i, frame_real.get(), frame_imag.get(), mel);
+        for (int j = 0; j < NUM_MEL_FILTERS; j++) {
+            sum[j] += mel[j];
+        }
+        if (++frames > kernel.half) {
+            emit_delta(&kernel, ring.get(), frames - 1 - kernel.half, frames - 1, &out->deltas);
+        }
+    }
+    // 마지막 half 프레임은 끝 프레임 복제
+    for (int center = frames > kernel.half ? frames - kernel.half : 0; center < frames; center++) {
+        emit_delta(&kernel, ring.get(), center, frames - 1, &out->deltas);
+    }
+
+    for (int j = 0; j < NUM_MEL_FILTERS; j++) {
+        out->mean[j] = frames > 0 ? (float)(sum[j] / frames) : 0.0f;
+    }
+    return ESP_OK;
+}
+
+esp_err_t clip_logmel_features(const clip_logmel_t* clip, const feature_view_t* view) {
+    float mel[MFCC_BUFFER_SIZE];
+    memcpy(mel, clip->mean, sizeof(clip->mean));
+    mfcc_from_logmel(mel, view->n_mfcc);
+    for (int j = 0; j < view->n_mfcc; j++) {
+        view->mfcc.data[j * view->mfcc.stride] = mel[j];
+    }
+    return delta_stats_std(&clip->deltas, view->n_mfcc, view->delta, view->delta2);
+}
@@ -0,0 +1,455 @@
+#include "feature_extraction.h"
+#include "audio_config.h"
+#include "processing_utils.h"
+#include "esp_log.h"
+#include "esp_dsp.h"
+#include "esp_heap_caps.h"
+#include "mem_arena.h"
+#include "wav_io.h"
+#include "mem_placement.h"
+#include "esp_timer.h"
+
+#include <math.h>
+#include <string.h>
+
+static const char* TAG = "FEATURE_EXTRACTION";
+
+// 멜 필터 하나의 비영 구간: spectrum[start .. start + length) 와 weights[offset ..] 의 내적
+typedef struct {
+    int16_t start;
+    int16_t length;
+    int16_t offset;
+} mel_band_t;
+
+// 프레임마다 읽는 표 (MEM_DSP_TABLES 배치)
+typedef struct {
+    float* window;
+    float* weights;     // 밴드 순서로 이어 붙인 비영 가중치
+} dsp_tables_t;
+
+static mel_band_t bands[NUM_MEL_FILTERS];
+static int weight_count;
+static dsp_tables_t tables;
+
+feature_view_t make_feature_view(float* base, int n_mfcc) {
+    feature_view_t view;
+    view.mfcc = {base, 1};
+    view.delta = {base + n_mfcc, 1};
+    view.delta2 = {base + 2 * n_mfcc, 1};
+    view.n_mfcc = n_mfcc;
+    return view;
+}
+
+// 밀집 필터뱅크 [NUM_MEL_FILTERS][FFT_SIZE / 2 + 1] 에서 밴드별 앞뒤 0 을 잘라낸 구간
+static void build_bands(const float* dense) {
+    const int n_bins = FFT_SIZE / 2 + 1;
+    weight_count = 0;
+    for (int i = 0; i < NUM_MEL_FILTERS; i++) {
+        const float* row = dense + i * n_bins;
+        int first = 0;
+        int last = n_bins - 1;
+        while (first < n_bins && row[first] == 0.0f) {
+            first++;
+        }
+        while (last >= first && row[last] == 0.0f) {
+            last--;
+        }
+        bands[i].start = first < n_bins ? first : 0;
+        bands[i].length = first < n_bins ? last - first + 1 : 0;
+        bands[i].offset = weight_count;
+        weight_count += bands[i].length;
+    }
+}
+
+static void fill_tables(dsp_tables_t* t, const float* dense) {
+    const int n_bins = FFT_SIZE / 2 + 1;
+    for (int i = 0; i < NUM_MEL_FILTERS; i++) {
+        memcpy(t->weights + bands[i].offset, dense + i * n_bins + bands[i].start, bands[i].length * sizeof(float));
+    }
+    // 한 번만 생성하고 프레임마다 곱한다
+    dsps_wind_hann_f32(t->window, FRAME_LENGTH);
+}
+
+static float* dense_filterbank() {
+    // 초기화 때만 쓰는 밀집 표 (41 KB) 는 PSRAM
+    float* dense = (float*)heap_caps_calloc(NUM_MEL_FILTERS * (FFT_SIZE / 2 + 1), sizeof(float), MEM_CAPS_COLD);
+    if (dense) {
+        create_mel_filterbank(dense, NUM_MEL_FILTERS, FFT_SIZE, SAMPLE_RATE);
+    }
+    return dense;
+}
+
+esp_err_t init_feature_extraction() {
+    float* dense = dense_filterbank();
+    if (!dense) {
+        ESP_LOGE(TAG, "Failed to allocate filterbank");
+        return ESP_ERR_NO_MEM;
+    }
+    build_bands(dense);
+
+    tables.window = (float*)mem_place_alloc(MEM_DSP_TABLES, FRAME_LENGTH * sizeof(float));
+    tables.weights = (float*)mem_place_alloc(MEM_DSP_TABLES, weight_count * sizeof(float));
+    if (!tables.window || !tables.weights) {
+        ESP_LOGE(TAG, "Failed to allocate DSP tables");
+        heap_caps_free(dense);
+        cleanup_feature_extraction();
+        return ESP_ERR_NO_MEM;
+    }
+    fill_tables(&tables, dense);
+    heap_caps_free(dense);
+    ESP_LOGI(TAG, "sparse filterbank: %d of %d weights", weight_count, NUM_MEL_FILTERS * (FFT_SIZE / 2 + 1));
+    return ESP_OK;
+}
+
+void cleanup_feature_extraction() {
+    heap_caps_free(tables.window);
+    heap_caps_free(tables.weights);
+    memset(&tables, 0, sizeof(tables));
+}
+
+static void apply_sparse_filterbank(const float* spectrum, const float* weights, float* mel_energies) {
+    for (int i = 0; i < NUM_MEL_FILTERS; i++) {
+        const float* w = weights + bands[i].offset;
+        const float* x = spectrum + bands[i].start;
+        float sum = 0.0f;
+        for (int k = 0; k < bands[i].length; k++) {
+            sum += w[k] * x[k];
+        }
+        mel_energies[i] = sum;
+    }
+}
+
+static void logmel_with(const dsp_tables_t* t, const int16_t* samples, float* frame_real, float* frame_imag,
+                        float* mel_energies) {
+    for (int j = 0; j < FRAME_LENGTH; j++) {
+        frame_real[j] = (float)samples[j] / 32768.0f;
+        frame_imag[j] = 0.0f;
+    }
+
+    // 프리엠퍼시스
+    dsps_preemphasis(frame_real, frame_real, FRAME_LENGTH, 0.97f);
+
+    // 윈도우 적용
+    for (int j = 0; j < FRAME_LENGTH; j++) {
+        frame_real[j] *= t->window[j];
+    }
+
+    // FFT 수행
+    fft(frame_real, frame_imag, FRAME_LENGTH);
+
+    // 멜 필터뱅크 적용 (필터마다 비영 구간만)
+    for (int j = 0; j < FFT_SIZE / 2 + 1; j++) {
+        frame_real[j] = sqrtf(frame_real[j] * frame_real[j] + frame_imag[j] * frame_imag[j]);
+    }
+    apply_sparse_filterbank(frame_real, t->weights, mel_energies);
+
+    // 로그 변환
+    dsps_log(mel_energies, NUM_MEL_FILTERS);
+}
+
+void logmel_frame(const int16_t* samples, float* frame_real, float* frame_imag, float* mel_energies) {
+    logmel_with(&tables, samples, frame_real, frame_imag, mel_energies);
+}
+
+// 이전 구현: 밀집 필터뱅크 (비영 구간 밖의 0 곱셈 포함)
+static void logmel_dense(const float* window, float* dense, const int16_t* samples, float* frame_real,
+                         float* frame_imag, float* mel_energies) {
+    for (int j = 0; j < FRAME_LENGTH; j++) {
+        frame_real[j] = (float)samples[j] / 32768.0f;
+        frame_imag[j] = 0.0f;
+    }
+    dsps_preemphasis(frame_real, frame_real, FRAME_LENGTH, 0.97f);
+    for (int j = 0; j < FRAME_LENGTH; j++) {
+        frame_real[j] *= window[j];
+    }
+    fft(frame_real, frame_imag, FRAME_LENGTH);
+    for (int j = 0; j < FFT_SIZE / 2 + 1; j++) {
+        frame_real[j] = sqrtf(frame_real[j] * frame_real[j] + frame_imag[j] * frame_imag[j]);
+    }
+    apply_mel_filterbank(frame_real, mel_energies, dense, NUM_MEL_FILTERS, FFT_SIZE);
+    dsps_log(mel_energies, NUM_MEL_FILTERS);
+}
+
+#define BENCH_AUDIO_FRAMES 8
+
+esp_err_t benchmark_frame_placement(int frames, placement_bench_t* out) {
+    if (frames <= 0 || !tables.weights) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    memset(out, 0, sizeof(*out));
+
+    // 입력 오디오는 실제처럼 PSRAM
+    const size_t audio_size = FRAME_LENGTH + (BENCH_AUDIO_FRAMES - 1) * FRAME_STEP;
+    int16_t* audio = (int16_t*)heap_caps_malloc(audio_size * sizeof(int16_t), MEM_CAPS_COLD);
+    float* dense = dense_filterbank();
+    dsp_tables_t cold = {};
+    cold.window = (float*)heap_caps_malloc(FRAME_LENGTH * sizeof(float), MEM_CAPS_COLD);
+    cold.weights = (float*)heap_caps_malloc(weight_count * sizeof(float), MEM_CAPS_COLD);
+    float* cold_frame = (float*)heap_caps_malloc((2 * FRAME_LENGTH + MFCC_BUFFER_SIZE) * sizeof(float), MEM_CAPS_COLD);
+    // 현재 배치의 프레임 버퍼는 요청 아레나와 같은 티어
+    uint32_t scratch_caps = mem_place_tier(MEM_FRAME_SCRATCH) == MEM_HOT ? MEM_CAPS_HOT : MEM_CAPS_COLD;
+    float* hot_frame = (float*)heap_caps_malloc((2 * FRAME_LENGTH + MFCC_BUFFER_SIZE) * sizeof(float), scratch_caps);
+
+    esp_err_t ret = ESP_OK;
+    if (!audio || !dense || !cold.window || !cold.weights || !cold_frame || !hot_frame) {
+        ESP_LOGE(TAG, "Failed to allocate benchmark buffers");
+        ret = ESP_ERR_NO_MEM;
+    } else {
+        uint32_t seed = 1;
+        for (size_t i = 0; i < audio_size; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            audio[i] = (int16_t)(seed >> 16) / 8;
+        }
+        fill_tables(&cold, dense);
+
+        float* mel = cold_frame + 2 * FRAME_LENGTH;
+        int64_t start = esp_timer_get_time();
+        for (int f = 0; f < frames; f++) {
+            logmel_dense(cold.window, dense, audio + (f % BENCH_AUDIO_FRAMES) * FRAME_STEP, cold_frame,
+                         cold_frame + FRAME_LENGTH, mel);
+        }
+        out->before_ns = (esp_timer_get_time() - start) * 1000 / frames;
+
+        start = esp_timer_get_time();
+        for (int f = 0; f < frames; f++) {
+            logmel_with(&cold, audio + (f % BENCH_AUDIO_FRAMES) * FRAME_STEP, cold_frame, cold_frame + FRAME_LENGTH,
+                        mel);
+        }
+        out->cold_ns = (esp_timer_get_time() - start) * 1000 / frames;
+
+        mel = hot_frame + 2 * FRAME_LENGTH;
+        start = esp_timer_get_time();
+        for (int f = 0; f < frames; f++) {
+            logmel_with(&tables, audio + (f % BENCH_AUDIO_FRAMES) * FRAME_STEP, hot_frame, hot_frame + FRAME_LENGTH,
+                        mel);
+        }
+        out->after_ns = (esp_timer_get_time() - start) * 1000 / frames;
+    }
+
+    heap_caps_free(audio);
+    heap_caps_free(dense);
+    heap_caps_free(cold.window);
+    heap_caps_free(cold.weights);
+    heap_caps_free(cold_frame);
+    heap_caps_free(hot_frame);
+    return ret;
+}
+
+void mfcc_from_logmel(float* mel_energies, int n_mfcc) {
+    // DCT 수행 (n_mfcc > NUM_MEL_FILTERS 이면 0으로 채운 뒤 변환)
+    for (int j = NUM_MEL_FILTERS; j < n_mfcc; j++) {
+        mel_energies[j] = 0.0f;
+    }
+    dsps_dct_f32(mel_energies, n_mfcc);
+}
+
+void mfcc_frame(const int16_t* samples, float* frame_real, float* frame_imag, float* mel_energies, int n_mfcc) {
+    logmel_frame(samples, frame_real, frame_imag, mel_energies);
+    mfcc_from_logmel(mel_energies, n_mfcc);
+}
+
+esp_err_t extract_mfcc(const int16_t* audio_data, size_t audio_size, feature_slice_t mfcc, int n_mfcc,
+                       mem_arena_t* scratch, const bool* cancel) {
+    if (n_mfcc > MAX_MFCC || n_mfcc < NUM_MEL_FILTERS) {
+        ESP_LOGE(TAG, "Unsupported MFCC count: %d", n_mfcc);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!scratch) {
+        scratch = internal_arena();
+    }
+    ArenaBuffer<float> frame_real(scratch, FRAME_LENGTH);
+    ArenaBuffer<float> frame_imag(scratch, FRAME_LENGTH);
+    ArenaBuffer<float> mel_energies(scratch, MFCC_BUFFER_SIZE);
+    if (!frame_real || !frame_imag || !mel_energies) {
+        ESP_LOGE(TAG, "Failed to allocate frame buffers");
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int j = 0; j < n_mfcc; j++) {
+        mfcc.data[j * mfcc.stride] = 0.0f;
+    }
+    int frame_count = 0;
+
+    for (size_t i = 0; i + FRAME_LENGTH < audio_size; i += FRAME_STEP) {
+        if (cancel && __atomic_load_n(cancel, __ATOMIC_ACQUIRE)) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        mfcc_frame(audio_data + i, frame_real.get(), frame_imag.get(), mel_energies.get(), n_mfcc);
+
+        for (int j = 0; j < n_mfcc; j++) {
+            mfcc.data[j * mfcc.stride] += mel_energies[j];
+        }
+
+        frame_count++;
+    }
+
+    if (frame_count > 0) {
+        for (int i = 0; i < n_mfcc; i++) {
+            mfcc.data[i * mfcc.stride] /= frame_count;
+        }
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t read_wav_clip(FILE* audio_file, int16_t* audio_data, size_t max, size_t* count) {
+    ArenaBuffer<wav_reader_t> reader(psram_arena(), 1);
+    if (!reader) {
+        ESP_LOGE(TAG, "Failed to allocate WAV reader");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // PCM / IMA-ADPCM WAV 모두 16-bit 샘플로 읽는다
+    esp_err_t ret = wav_reader_open(reader.get(), audio_file);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (reader[0].info.sample_rate != 0 && reader[0].info.sample_rate != SAMPLE_RATE) {
+        ESP_LOGW(TAG, "Sample rate %u differs from %d", (unsigned)reader[0].info.sample_rate, SAMPLE_RATE);
+    }
+
+    *count = wav_reader_read(reader.get(), audio_file, audio_data, max);
+    return ESP_OK;
+}
+
+esp_err_t feature_extractor(FILE* audio_file, feature_slice_t mfcc, int n_mfcc) {
+    ArenaBuffer<int16_t> audio_data(psram_arena(), MAX_AUDIO_SIZE);
+    if (!audio_data) {
+        ESP_LOGE(TAG, "Failed to allocate memory for audio data");
+        return ESP_ERR_NO_MEM;
+    }
+
+    size_t audio_size;
+    esp_err_t ret = read_wav_clip(audio_file, audio_data.get(), MAX_AUDIO_SIZE, &audio_size);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return extract_mfcc(audio_data.get(), audio_size, mfcc, n_mfcc);
+}
+
+spectrogram_config_t default_spectrogram_config(int frames, int bins, size_t audio_size) {
+    spectrogram_config_t config;
+    config.frames = frames;
+    config.bins = bins;
+    config.hop = FRAME_STEP;
+    if (frames > 1 && audio_size > FRAME_LENGTH) {
+        config.hop = (int)((audio_size - FRAME_LENGTH) / (frames - 1));
+        if (config.hop < 1) {
+            config.hop = 1;
+        }
+    }
+    config.pad = SPEC_PAD_ZERO;
+    config.mean = 0.0f;
+    config.std = 1.0f;
+    return config;
+}
+
+static inline void sink_write(const tensor_sink_t* sink, int index, float value) {
+    if (sink->f32) {
+        sink->f32[index] = value;
+        return;
+    }
+    int32_t q = (int32_t)lrintf(value / sink->scale) + sink->zero_point;
+    sink->i8[index] = (int8_t)(q < -128 ? -128 : q > 127 ? 127 : q);
+}
+
+esp_err_t extract_spectrogram(const int16_t* audio_data, size_t audio_size, const spectrogram_config_t* config,
+                              tensor_sink_t sink, mem_arena_t* scratch) {
+    if (config->bins != NUM_MEL_FILTERS || config->frames <= 0 || config->hop <= 0 || config->std == 0.0f ||
+        (!sink.f32 && (!sink.i8 || sink.scale == 0.0f))) {
+        ESP_LOGE(TAG, "Unsupported spectrogram %d x %d (hop %d)", config->frames, config->bins, config->hop);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!scratch) {
+        scratch = internal_arena();
+    }
+    ArenaBuffer<float> frame_real(scratch, FRAME_LENGTH);
+    ArenaBuffer<float> frame_imag(scratch, FRAME_LENGTH);
+    ArenaBuffer<float> mel_energies(scratch, NUM_MEL_FILTERS);
+    if (!frame_real || !frame_imag || !mel_energies) {
+        ESP_LOGE(TAG, "Failed to allocate frame buffers");
+        return ESP_ERR_NO_MEM;
+    }
+
+    float inv_std = 1.0f / config->std;
+    int valid = 0;
+    for (int t = 0; t < config->frames; t++) {
+        size_t start = (size_t)t * config->hop;
+        if (start + FRAME_LENGTH > audio_size) {
+            break;
+        }
+        logmel_frame(audio_data + start, frame_real.get(), frame_imag.get(), mel_energies.get());
+        for (int j = 0; j < NUM_MEL_FILTERS; j++) {
+            sink_write(&sink, t * NUM_MEL_FILTERS + j, (mel_energies[j] - config->mean) * inv_std);
+        }
+        valid++;
+    }
+
+    // 뒤쪽 패딩: EDGE 는 마지막 프레임의 값(mel_energies 에 남아 있음)을 반복
+    bool edge = config->pad == SPEC_PAD_EDGE && valid > 0;
+    for (int t = valid; t < config->frames; t++) {
+        for (int j = 0; j < NUM_MEL_FILTERS; j++) {
+            sink_write(&sink, t * NUM_MEL_FILTERS + j, edge ? (mel_energies[j] - config->mean) * inv_std : 0.0f);
+        }
+    }
+    return ESP_OK;
+}
+
+void apply_mel_filterbank(float* spectrum, float* mel_energies, float* fbank, int n_filters, int n_fft) {
+    int n_bins = n_fft / 2 + 1;
+    for (int i = 0; i < n_filters; i++) {
+        mel_energies[i] = 0.0f;
+        for (int j = 0; j < n_bins; j++) {
+            mel_energies[i] += spectrum[j] * fbank[i * n_bins + j];
+        }
+    }
+}
+
+esp_err_t load_scaler(const char* scaler_path, float* mean, float* std) {
+    FILE* scaler_file = fopen(scaler_path, "rb");
+    if (!scaler_file) {
+        ESP_LOGE(TAG, "Failed to open scaler file");
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    size_t read = fread(mean, sizeof(float), 1, scaler_file);
+    read += fread(std, sizeof(float), 1, scaler_file);
+    fclose(scaler_file);
+    return read == 2 ? ESP_OK : ESP_ERR_INVALID_SIZE;
+}
+
+void apply_scaler(feature_slice_t features, int size, float mean, float std) {
+    for (int i = 0; i < size; i++) {
+        float* value = features.data + i * features.stride;
+        *value = (*value - mean) / std;
+    }
+}
+
+void scaler(float* features, int size, const char* scaler_path) {
+    float mean, std;
+    if (load_scaler(scaler_path, &mean, &std) != ESP_OK) {
+        return;
+    }
+    apply_scaler({features, 1}, size, mean, std);
+}
+
+static void slice_diff(feature_slice_t input, feature_slice_t output, int size) {
+    if (input.stride == 1 && output.stride == 1) {
+        dsps_diff(input.data, output.data, size, 1);
+    } else {
+        for (int i = 1; i < size; i++) {
+            output.data[i * output.stride] = input.data[i * input.stride] - input.data[(i - 1) * input.stride];
+        }
+    }
+    output.data[0] = 0.0f;
+}
+
+void differential_mfcc(feature_slice_t mfcc_features, feature_slice_t delta_mfccs, feature_slice_t delta2_mfccs, int size) {
+    // 1차 미분
+    slice_diff(mfcc_features, delta_mfccs, size);
+
+    // 2차 미분
+    slice_diff(delta_mfccs, delta2_mfccs, size);
+}
@@ -2,11 +2,27 @@
 #include "gap.h"
 #include "gatt_svc.h"
 #include "nimble_handler.h"
+#include "model_inference.h"
+#include "nimble/nimble_port.h"
+
+#if ADV_RESULT_BROADCAST && ADV_COMPANY_ID_UNSET
+#error "ADV_RESULT_BROADCAST needs the assigned company ID in ADV_COMPANY_ID"
+#endif
 
 static const char* TAG = "BLE_GAP";
 
 static uint8_t own_addr_type;
 static uint8_t addr_val[6] = {0};
+// 광고와 연결 상태(conn_count, adv_ready)는 NimBLE 호스트 태스크에서만 읽고 쓴다
+// 연결 수가 BLE_MAX_CLIENTS 보다 적으면 연결된 상태에서도 계속 광고
+static int conn_count;
+static bool adv_ready;
+// 방송할 최근 결과 (파이프라인 태스크가 쓰고 호스트 태스크가 읽는다)
+static adv_result_t latest_result;
+static bool have_result;
+static portMUX_TYPE result_lock = portMUX_INITIALIZER_UNLOCKED;
+// 다른 태스크의 결과 갱신을 호스트 태스크로 넘기는 이벤트 (이미 대기 중이면 다시 넣지 않는다)
+static struct ble_npl_event adv_update_event;
 static const ble_uuid128_t pipeline_svc_uuid = BLE_UUID128_INIT(0x4f, 0xaf, 0xc2, 0x01, 0x1f, 0xb5, 0x45, 0x9e, 
     0x8f, 0xcc, 0xc5, 0xc9, 0xc3, 0x31, 0x91, 0x4b);
 static const ble_uuid128_t pipeline_chr_uuid = BLE_UUID128_INIT(0xbe, 0xb5, 0x48, 0x3e, 0x36, 0xe1, 0x46, 0x88, 
@@ -14,8 +30,9 @@ static const ble_uuid128_t pipeline_chr_uuid = BLE_UUID128_INIT(0xbe, 0xb5, 0x48
 
 inline static void format_addr(char *addr_str, uint8_t addr[]);
 static void print_conn_desc(struct ble_gap_conn_desc *desc);
-static void start_advertising(void);
+static void start_advertising(bool burst = false);
 static int gap_event_handler(struct ble_gap_event *event, void *arg);
+static void request_fast_link(uint16_t conn_handle);
 
 /* Private functions */
 inline static void format_addr(char *addr_str, uint8_t addr[]) {
@@ -45,20 +62,60 @@ static void print_conn_desc(struct ble_gap_conn_desc *desc) {
              desc->sec_state.bonded);
 }
 
-static void start_advertising(void) {
+static bool copy_result(adv_result_t* out) {
+    taskENTER_CRITICAL(&result_lock);
+    bool valid = have_result;
+    *out = latest_result;
+    taskEXIT_CRITICAL(&result_lock);
+    return valid && ADV_RESULT_BROADCAST;
+}
+
+static void start_advertising(bool burst) {
     int rc = 0;
     const char *name;
     struct ble_hs_adv_fields adv_fields = {0};
     struct ble_hs_adv_fields rsp_fields = {0};
     struct ble_gap_adv_params adv_params = {0};
+    adv_result_t result;
+
+    // 연결 자리가 없으면 결과 방송만 (연결 불가 광고)
+    bool connectable = conn_count < BLE_MAX_CLIENTS;
+    bool broadcast = copy_result(&result);
+    if (ble_gap_adv_active() || (!connectable && !broadcast)) {
+        return;
+    }
 
     /* Set advertising flags */
     adv_fields.flags = BLE_HS_ADV_F_DISC_GEN | BLE_HS_ADV_F_BREDR_UNSUP;
+    name = ble_svc_gap_device_name();
 
-    /* Set pipeline UUID */
-    adv_fields.uuids128 = (ble_uuid128_t*)&pipeline_svc_uuid;
-    adv_fields.num_uuids128 = 1;
-    adv_fields.uuids128_is_complete = 1;
+    if (broadcast) {
+        /* Set result as manufacturer data, name stays in the advertisement */
+        adv_fields.mfg_data = (uint8_t *)&result;
+        adv_fields.mfg_data_len = sizeof(result);
+        adv_fields.name = (uint8_t *)name;
+        adv_fields.name_len = strlen(name);
+        adv_fields.name_is_complete = 1;
+
+        /* Pipeline UUID moves to the scan response */
+        rsp_fields.uuids128 = (ble_uuid128_t*)&pipeline_svc_uuid;
+        rsp_fields.num_uuids128 = 1;
+        rsp_fields.uuids128_is_complete = 1;
+    } else {
+        /* Set pipeline UUID */
+        adv_fields.uuids128 = (ble_uuid128_t*)&pipeline_svc_uuid;
+        adv_fields.num_uuids128 = 1;
+        adv_fields.uuids128_is_complete = 1;
+
+        /* Move device name to scan response */
+        rsp_fields.name = (uint8_t *)name;
+        rsp_fields.name_len = strlen(name);
+        rsp_fields.name_is_complete = 1;
+
+        rsp_fields.device_addr = addr_val;
+        rsp_fields.device_addr_type = own_addr_type;
+        rsp_fields.device_addr_is_present = 1;
+    }
 
     /* Set advertisement fields */
     rc = ble_gap_adv_set_fields(&adv_fields);
@@ -67,22 +124,12 @@ static void start_advertising(void) {
         return;
     }
 
-    /* Move device name to scan response */
-    name = ble_svc_gap_device_name();
-    rsp_fields.name = (uint8_t *)name;
-    rsp_fields.name_len = strlen(name);
-    rsp_fields.name_is_complete = 1;
-
     rsp_fields.appearance = BLE_GAP_APPEARANCE_GENERIC_TAG;
     rsp_fields.appearance_is_present = 1;
 
     rsp_fields.le_role = BLE_GAP_LE_ROLE_PERIPHERAL;
     rsp_fields.le_role_is_present = 1;
 
-    rsp_fields.device_addr = addr_val;
-    rsp_fields.device_addr_type = own_addr_type;
-    rsp_fields.device_addr_is_present = 1;
-
     /* Set scan response fields */
     rc = ble_gap_adv_rsp_set_fields(&rsp_fields);
     if (rc != 0) {
@@ -91,21 +138,66 @@ static void start_advertising(void) {
     }
 
     /* Set advertising parameters */
-    adv_params.conn_mode = BLE_GAP_CONN_MODE_UND;
+    adv_params.conn_mode = connectable ? BLE_GAP_CONN_MODE_UND : BLE_GAP_CONN_MODE_NON;
     adv_params.disc_mode = BLE_GAP_DISC_MODE_GEN;
-    adv_params.itvl_min = BLE_GAP_ADV_ITVL_MS(500);
-    adv_params.itvl_max = BLE_GAP_ADV_ITVL_MS(510);
+    if (burst) {
+        adv_params.itvl_min = BLE_GAP_ADV_ITVL_MS(ADV_BURST_ITVL_MS);
+        adv_params.itvl_max = BLE_GAP_ADV_ITVL_MS(ADV_BURST_ITVL_MS + 10);
+    } else {
+        adv_params.itvl_min = BLE_GAP_ADV_ITVL_MS(500);
+        adv_params.itvl_max = BLE_GAP_ADV_ITVL_MS(510);
+    }
 
-    /* Start advertising */
-    rc = ble_gap_adv_start(own_addr_type, NULL, BLE_HS_FOREVER, &adv_params,
+    /* Start advertising, a burst ends with BLE_GAP_EVENT_ADV_COMPLETE */
+    rc = ble_gap_adv_start(own_addr_type, NULL, burst ? ADV_BURST_MS : BLE_HS_FOREVER, &adv_params,
                            gap_event_handler, NULL);
     if (rc != 0) {
         ESP_LOGE(TAG, "failed to start advertising, error code: %d", rc);
         return;
     }
-    ESP_LOGI(TAG, "advertising started!");
+    ESP_LOGI(TAG, "advertising started!%s", burst ? " (result burst)" : "");
 }
 
+void adv_publish_result(int8_t result, uint32_t seq, int64_t done_us) {
+    taskENTER_CRITICAL(&result_lock);
+    latest_result.company_id = ADV_COMPANY_ID;
+    latest_result.result = result;
+    latest_result.seq = seq;
+    latest_result.timestamp_ms = (uint32_t)(done_us / 1000);
+    have_result = true;
+    taskEXIT_CRITICAL(&result_lock);
+
+    ble_npl_eventq_put(nimble_port_get_dflt_eventq(), &adv_update_event);
+}
+
+// 호스트 태스크: 진행 중인 광고를 새 데이터와 빠른 간격으로 다시 시작
+static void adv_update_cb(struct ble_npl_event* event) {
+    if (!adv_ready) {
+        // adv_init() 이 최근 결과로 시작한다
+        return;
+    }
+    ble_gap_adv_stop();
+    start_advertising(true);
+}
+
+// bulk 전송용: 2M PHY, 최대 데이터 길이(DLE), 큰 MTU 를 요청 (거절되어도 연결은 유지)
+static void request_fast_link(uint16_t conn_handle) {
+    int rc = ble_gap_set_prefered_le_phy(conn_handle, BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_2M_MASK,
+                                         BLE_GAP_LE_PHY_CODED_ANY);
+    if (rc != 0) {
+        ESP_LOGW(TAG, "failed to request 2M PHY, error code: %d", rc);
+    }
+
+    rc = ble_gap_set_data_len(conn_handle, BLE_HCI_SET_DATALEN_TX_OCTETS_MAX, BLE_HCI_SET_DATALEN_TX_TIME_MAX);
+    if (rc != 0) {
+        ESP_LOGW(TAG, "failed to set data length, error code: %d", rc);
+    }
+
+    rc = ble_gattc_exchange_mtu(conn_handle, NULL, NULL);
+    if (rc != 0) {
+        ESP_LOGW(TAG, "failed to exchange mtu, error code: %d", rc);
+    }
+}
 
 static int gap_event_handler(struct ble_gap_event *event, void *arg) {
     /* Local variables */
@@ -122,6 +214,7 @@ static int gap_event_handler(struct ble_gap_event *event, void *arg) {
                  event->connect.status);
 
         if (event->connect.status == 0) {
+            conn_count++;
             rc = ble_gap_conn_find(event->connect.conn_handle, &desc);
             if (rc != 0) {
                 ESP_LOGE(TAG,
@@ -130,6 +223,8 @@ static int gap_event_handler(struct ble_gap_event *event, void *arg) {
                 return rc;
             }
             print_conn_desc(&desc);
+            start_advertising();
+            request_fast_link(event->connect.conn_handle);
             struct ble_gap_upd_params lambda_params = {.itvl_min = desc.conn_itvl,
                                                 .itvl_max = desc.conn_itvl,
                                                 .latency = 3,
@@ -153,9 +248,23 @@ static int gap_event_handler(struct ble_gap_event *event, void *arg) {
         ESP_LOGI(TAG, "disconnected from peer; reason=%d",
                  event->disconnect.reason);
 
+        if (conn_count > 0) {
+            conn_count--;
+        }
+        gatt_svr_disconnect_cb(event->disconnect.conn.conn_handle);
+        // 자리가 없어 연결 불가로 광고 중이었으면 연결 가능 광고로 바꾼다
+        if (conn_count == BLE_MAX_CLIENTS - 1) {
+            ble_gap_adv_stop();
+        }
         start_advertising();
         return rc;
 
+    case BLE_GAP_EVENT_PHY_UPDATE_COMPLETE:
+        ESP_LOGI(TAG, "phy update; status=%d tx_phy=%d rx_phy=%d",
+                 event->phy_updated.status, event->phy_updated.tx_phy,
+                 event->phy_updated.rx_phy);
+        return rc;
+
     case BLE_GAP_EVENT_CONN_UPDATE:
         ESP_LOGI(TAG, "connection updated; status=%d",
                  event->conn_update.status);
@@ -184,6 +293,7 @@ static int gap_event_handler(struct ble_gap_event *event, void *arg) {
                      event->notify_tx.conn_handle, event->notify_tx.attr_handle,
                      event->notify_tx.status, event->notify_tx.indication);
         }
+        gatt_svr_notify_tx_cb(event);
         return rc;
 
     case BLE_GAP_EVENT_SUBSCRIBE:
@@ -232,7 +342,7 @@ void adv_init(void) {
     format_addr(addr_str, addr_val);
     ESP_LOGI(TAG, "device address: %s", addr_str);
 
-    vTaskDelay(pdMS_TO_TICKS(100)); 
+    adv_ready = true;
     start_advertising();
 }
 
@@ -240,6 +350,10 @@ int gap_init(void) {
     int rc = 0;
 
     ble_svc_gap_init();
+    ble_npl_event_init(&adv_update_event, adv_update_cb, NULL);
+#if ADV_RESULT_BROADCAST
+    set_result_listener(adv_publish_result);
+#endif
 
     rc = ble_svc_gap_device_name_set(DEVICE_NAME);
     if (rc != 0) {
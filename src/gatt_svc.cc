@@ -2,6 +2,15 @@
 #include "nimble_handler.h"
 #include "gatt_svc.h"
 #include "model_inference.h"
+#include "command_dispatch.h"
+#include "bulk_transfer.h"
+#include "data_paths.h"
+#include "record_store.h"
+#include "mem_arena.h"
+#include "metrics.h"
+#include "esp_timer.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 
 static const char* TAG = "BLE_GATT";
 
@@ -11,9 +20,121 @@ static const ble_uuid128_t pipeline_svc_uuid = BLE_UUID128_INIT(0x4f, 0xaf, 0xc2
 static const ble_uuid128_t pipeline_chr_uuid = BLE_UUID128_INIT(0xbe, 0xb5, 0x48, 0x3e, 0x36, 0xe1, 0x46, 0x88, 
     0xb7, 0xf5, 0xea, 0x07, 0x36, 0x1b, 0x26, 0xa8);
 static uint16_t pipeline_chr_val_handle;
+// bulk transfer (WAV / 특징 / 트레이스 스트리밍)
+static const ble_uuid128_t bulk_chr_uuid = BLE_UUID128_INIT(0x5c, 0x1e, 0x7a, 0x93, 0x0d, 0x42, 0x4b, 0x61,
+    0x9a, 0x27, 0x3e, 0x8b, 0xd4, 0x60, 0x15, 0xc7);
+static uint16_t bulk_chr_val_handle;
+// 런타임 메트릭 스냅샷 (읽기 전용, metrics_encode() 형식)
+static const ble_uuid128_t metrics_chr_uuid = BLE_UUID128_INIT(0x3d, 0x8a, 0x51, 0xe4, 0x7b, 0x26, 0x4c, 0x0f,
+    0xa1, 0x93, 0x6e, 0x2d, 0xb8, 0x04, 0x57, 0xf1);
+static uint16_t metrics_chr_val_handle;
+
+// 쓰기 콜백은 명령만 큐에 넣고, 파이프라인과 알림 전송은 별도 태스크에서 처리
+#define COMMAND_QUEUE_LEN 4
+#define NOTIFY_QUEUE_LEN 8
+// 큐 항목 하나가 응답 프레임 하나, 전송할 때 연결의 MTU 에 맞춰 여러 알림으로 나눈다
+#define NOTIFY_MAX_LEN (CMD_MAX_PAYLOAD + CMD_FRAME_OVERHEAD)
+#define ATT_NOTIFY_OVERHEAD 3
+#define PIPELINE_CMD_MAX_PAYLOAD 32
+#define NOTIFY_TX_TIMEOUT_MS 1000
+#define NOTIFY_RETRY_MS 20
+#define NOTIFY_MAX_RETRIES 10
+#define PIPELINE_WORKER_STACK 8192
+#define NOTIFY_TASK_STACK 3072
+#define BULK_QUEUE_LEN 8
+#define BULK_TASK_STACK 6144
+#define BULK_ACK_TIMEOUT_MS 500
+#define BULK_MAX_TIMEOUTS 10
+#define BULK_MEM_SOURCE_SIZE 1536
+// 조각 읽기가 끊기면 이 시간 뒤 다음 읽기부터 새 스냅샷
+#define METRICS_READ_HOLD_MS 2000
+
+typedef struct {
+    uint16_t conn_handle;
+    bool legacy;            // 1바이트 'r' 명령: 텍스트 알림 "w" / 결과 / "EOF" 로 응답
+    bool owner;             // classify_job 을 연 요청, 결과를 합류한 연결에도 전달
+    uint8_t cmd;
+    uint16_t len;
+    uint8_t payload[PIPELINE_CMD_MAX_PAYLOAD];
+} pipeline_cmd_t;
+
+typedef struct {
+    uint16_t conn_handle;
+    uint16_t attr_handle;
+    uint16_t len;
+    uint8_t data[NOTIFY_MAX_LEN];
+} notify_msg_t;
+
+typedef struct {
+    uint16_t conn_handle;
+    uint8_t len;
+    uint8_t data[BULK_REQUEST_SIZE];
+} bulk_msg_t;
+
+// 전송 원본: 파일의 [base, base + size) 또는 메모리 버퍼
+typedef struct {
+    uint16_t conn_handle;
+    FILE* file;
+    long base;
+    bool record;            // 저장소 레코드: 읽을 때마다 세그먼트가 재사용되지 않았는지 확인
+    uint32_t record_seq;
+    bool stale;
+    uint8_t mem[BULK_MEM_SOURCE_SIZE];
+    bool blocked;
+} bulk_source_t;
+
+// 결과 알림 대상: 구독 여부와 응답 형식 (BLE_GAP_EVENT_SUBSCRIBE / 쓰기 때 갱신)
+typedef struct {
+    uint16_t conn_handle;
+    bool subscribed;
+    bool legacy;
+} ble_client_t;
+
+// 진행 중인(대기열 포함) 분류 요청 하나, 같은 명령과 인자의 요청은 새로 실행하지 않고 합류
+typedef struct {
+    bool active;
+    uint8_t cmd;
+    uint16_t len;
+    uint8_t payload[PIPELINE_CMD_MAX_PAYLOAD];
+    int joiner_count;
+    ble_client_t joiners[BLE_MAX_CLIENTS];
+} classify_job_t;
+
+// 연결마다 읽기 중인 메트릭 스냅샷, 값이 MTU 보다 길어 read blob 으로 나눠 읽어도 한 시점의 값을 준다
+//   NimBLE 는 조각마다 전체 값을 요청하므로 보낸 바이트 수로 한 번의 읽기가 끝났는지 판단한다
+typedef struct {
+    uint16_t conn_handle;
+    uint16_t remaining;     // 이번 읽기에서 클라이언트가 아직 받지 않은 바이트
+    uint16_t len;
+    int64_t encoded_us;
+    uint8_t data[METRICS_ENCODED_SIZE];
+} metrics_read_t;
+
+typedef enum {
+    JOB_OWNER,      // 새 분류를 연다
+    JOB_JOINED,     // 진행 중인 분류의 결과를 받는다
+    JOB_NONE,       // 다른 분류가 진행 중, 평소처럼 대기열에
+} job_join_t;
+
+static QueueHandle_t command_queue;
+static QueueHandle_t notify_queue;
+static SemaphoreHandle_t notify_tx_done;
+static QueueHandle_t bulk_queue;
+static ble_client_t clients[BLE_MAX_CLIENTS];
+static classify_job_t classify_job;
+// 호스트 태스크에서만 접근 (읽기 / 연결 끊김 콜백)
+static metrics_read_t metrics_reads[BLE_MAX_CLIENTS];
+// 호스트 태스크(쓰기 / 구독 콜백)와 파이프라인 워커가 공유
+static portMUX_TYPE clients_lock = portMUX_INITIALIZER_UNLOCKED;
 
 static int pipeline_chr_access(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg);
 static int send_notification(uint16_t conn_handle, uint16_t handle, uint8_t* data, uint16_t length);
+static void queue_notification(uint16_t conn_handle, const void* data, size_t len);
+static void pipeline_worker_task(void *arg);
+static void notify_task(void *arg);
+static int bulk_chr_access(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg);
+static int metrics_chr_access(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg);
+static void bulk_task(void *arg);
 void gatt_svr_subscribe_cb(struct ble_gap_event *event);
 
 // gatt service table
@@ -28,6 +149,18 @@ static const struct ble_gatt_svc_def gatt_svr_svcs[] = {
                 .flags = BLE_GATT_CHR_F_WRITE | BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_NOTIFY,
                 .val_handle = &pipeline_chr_val_handle
             },
+            {
+                .uuid = &bulk_chr_uuid.u,
+                .access_cb = bulk_chr_access,
+                .flags = BLE_GATT_CHR_F_WRITE | BLE_GATT_CHR_F_WRITE_NO_RSP | BLE_GATT_CHR_F_NOTIFY,
+                .val_handle = &bulk_chr_val_handle
+            },
+            {
+                .uuid = &metrics_chr_uuid.u,
+                .access_cb = metrics_chr_access,
+                .flags = BLE_GATT_CHR_F_READ,
+                .val_handle = &metrics_chr_val_handle
+            },
             {0}
         },
     },
@@ -46,6 +179,35 @@ int gatt_svc_init(void) {
     /* Local variables */
     int rc;
 
+    /* 0. Pipeline worker and notification sender */
+    if (!command_queue) {
+        for (int i = 0; i < BLE_MAX_CLIENTS; i++) {
+            clients[i].conn_handle = BLE_HS_CONN_HANDLE_NONE;
+            metrics_reads[i].conn_handle = BLE_HS_CONN_HANDLE_NONE;
+        }
+        command_queue = xQueueCreate(COMMAND_QUEUE_LEN, sizeof(pipeline_cmd_t));
+        notify_queue = xQueueCreate(NOTIFY_QUEUE_LEN, sizeof(notify_msg_t));
+        notify_tx_done = xSemaphoreCreateBinary();
+        if (init_command_dispatch() != ESP_OK) {
+            return BLE_HS_ENOMEM;
+        }
+        bulk_queue = xQueueCreate(BULK_QUEUE_LEN, sizeof(bulk_msg_t));
+        if (!command_queue || !notify_queue || !notify_tx_done || !bulk_queue) {
+            return BLE_HS_ENOMEM;
+        }
+        if (xTaskCreate(pipeline_worker_task, "pipeline_worker", PIPELINE_WORKER_STACK, NULL, 5, NULL) != pdPASS ||
+            xTaskCreate(notify_task, "ble_notify", NOTIFY_TASK_STACK, NULL, 6, NULL) != pdPASS ||
+            xTaskCreate(bulk_task, "ble_bulk", BULK_TASK_STACK, NULL, 4, NULL) != pdPASS) {
+            return BLE_HS_ENOMEM;
+        }
+    }
+
+    /* 큰 MTU 를 선호해 bulk 청크 하나에 더 많은 데이터를 싣는다 */
+    rc = ble_att_set_preferred_mtu(BLE_ATT_MTU_MAX);
+    if (rc != 0) {
+        ESP_LOGW(TAG, "failed to set preferred mtu: %d", rc);
+    }
+
     /* 1. GATT service initialization */
     ble_svc_gatt_init();
 
@@ -64,16 +226,97 @@ int gatt_svc_init(void) {
     return 0;
 }
 
+// clients_lock 안에서 호출
+static ble_client_t* find_client(uint16_t conn_handle, bool create) {
+    ble_client_t* empty = NULL;
+    for (int i = 0; i < BLE_MAX_CLIENTS; i++) {
+        if (clients[i].conn_handle == conn_handle) {
+            return &clients[i];
+        }
+        if (!empty && clients[i].conn_handle == BLE_HS_CONN_HANDLE_NONE) {
+            empty = &clients[i];
+        }
+    }
+    if (create && empty) {
+        empty->conn_handle = conn_handle;
+        empty->subscribed = false;
+        empty->legacy = false;
+        return empty;
+    }
+    return NULL;
+}
+
+// 구독만 하고 명령을 보내지 않는 연결은 프레임 형식으로 받는다
+static void remember_format(uint16_t conn_handle, bool legacy) {
+    taskENTER_CRITICAL(&clients_lock);
+    ble_client_t* client = find_client(conn_handle, true);
+    if (client) {
+        client->legacy = legacy;
+    }
+    taskEXIT_CRITICAL(&clients_lock);
+}
+
+static job_join_t join_classify(const pipeline_cmd_t* cmd) {
+    job_join_t join = JOB_NONE;
+    taskENTER_CRITICAL(&clients_lock);
+    ble_client_t* client = find_client(cmd->conn_handle, true);
+    if (client) {
+        client->legacy = cmd->legacy;
+    }
+    if (!classify_job.active) {
+        classify_job.active = true;
+        classify_job.cmd = cmd->cmd;
+        classify_job.len = cmd->len;
+        memcpy(classify_job.payload, cmd->payload, cmd->len);
+        classify_job.joiner_count = 0;
+        join = JOB_OWNER;
+    } else if (classify_job.cmd == cmd->cmd && classify_job.len == cmd->len &&
+               memcmp(classify_job.payload, cmd->payload, cmd->len) == 0) {
+        // 같은 연결이 다시 요청해도 한 번만 받는다
+        bool listed = false;
+        for (int i = 0; i < classify_job.joiner_count; i++) {
+            listed |= classify_job.joiners[i].conn_handle == cmd->conn_handle;
+        }
+        if (!listed && classify_job.joiner_count < BLE_MAX_CLIENTS) {
+            ble_client_t* joiner = &classify_job.joiners[classify_job.joiner_count++];
+            joiner->conn_handle = cmd->conn_handle;
+            joiner->legacy = cmd->legacy;
+        }
+        join = JOB_JOINED;
+    }
+    taskEXIT_CRITICAL(&clients_lock);
+    return join;
+}
+
+// 호스트 태스크에서 호출되므로 알림 큐가 가득 차면 기다리지 않고 버린다
+static void send_pending(const pipeline_cmd_t* cmd) {
+    notify_msg_t msg;
+    msg.conn_handle = cmd->conn_handle;
+    msg.attr_handle = pipeline_chr_val_handle;
+    if (cmd->legacy) {
+        msg.data[0] = 'w';
+        msg.len = 1;
+    } else {
+        msg.len = cmd_encode_reply(msg.data, sizeof(msg.data), cmd->cmd, CMD_STATUS_PENDING, NULL, 0);
+    }
+    if (msg.len == 0 || xQueueSend(notify_queue, &msg, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "대기 알림 생략 (conn %d)", cmd->conn_handle);
+    }
+}
+
 static int pipeline_chr_access(uint16_t conn_handle, uint16_t attr_handle,
     struct ble_gatt_access_ctxt *ctxt, void *arg) {
     int rc;
-    uint8_t command[1];
+    uint8_t command[PIPELINE_CMD_MAX_PAYLOAD + CMD_FRAME_OVERHEAD];
     uint16_t len;
+    pipeline_cmd_t cmd = {};
+    cmd_parser_t parser = {};
+    cmd_frame_t frame;
 
     switch (ctxt->op) {
         case BLE_GATT_ACCESS_OP_WRITE_CHR:
             len = OS_MBUF_PKTLEN(ctxt->om);
-            if (len != 1) {
+            if (len == 0 || len > sizeof(command)) {
                 ESP_LOGE(TAG, "유효하지 않은 명령 길이: %d", len);
                 return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
             }
@@ -84,26 +327,49 @@ static int pipeline_chr_access(uint16_t conn_handle, uint16_t attr_handle,
                 return BLE_ATT_ERR_UNLIKELY;
             }
 
-            ESP_LOGI(TAG, "받은 명령: %c", command[0]);
-
-            if (command[0] == 'r') {
-                ESP_LOGI(TAG, "'r' 명령 수신, 처리 중...");
-                vTaskDelay(pdMS_TO_TICKS(100));
-                rc = send_notification(conn_handle, pipeline_chr_val_handle, (uint8_t*)"w", strlen("w"));
-                vTaskDelay(pdMS_TO_TICKS(100));
-                const char* result = pipeline();
-                rc = send_notification(conn_handle, pipeline_chr_val_handle, (uint8_t*)result, strlen(result));
-                vTaskDelay(pdMS_TO_TICKS(100));
-                rc = send_notification(conn_handle, pipeline_chr_val_handle, (uint8_t*)"EOF", strlen("EOF"));
-                vTaskDelay(pdMS_TO_TICKS(100));
-                if (rc != 0) {
-                    ESP_LOGE(TAG, "파이프라인 결과 전송 실패: %d", rc);
-                    return BLE_ATT_ERR_UNLIKELY;
+            cmd.conn_handle = conn_handle;
+            if (len == 1 && command[0] == 'r') {
+                // 기존 앱 호환: 저장된 audio.wav 분류
+                cmd.legacy = true;
+                cmd.cmd = CMD_CLASSIFY;
+            } else {
+                // 쓰기 한 번에 프레임 하나가 온전히 들어 있어야 한다
+                bool complete = false;
+                for (uint16_t i = 0; i < len && !complete; i++) {
+                    complete = cmd_parser_push(&parser, command[i], &frame);
+                }
+                if (!complete) {
+                    ESP_LOGE(TAG, "잘못된 명령 프레임 (%d bytes)", len);
+                    return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+                }
+                cmd.cmd = frame.cmd;
+                cmd.len = frame.len;
+                memcpy(cmd.payload, frame.payload, frame.len);
+            }
+
+            if (cmd.cmd == CMD_CLASSIFY || cmd.cmd == CMD_RECORD) {
+                job_join_t join = join_classify(&cmd);
+                if (join == JOB_JOINED) {
+                    ESP_LOGI(TAG, "명령 0x%02x, 진행 중인 분류에 합류 (conn %d)", cmd.cmd, conn_handle);
+                    metrics_add(METRIC_COALESCED);
+                    send_pending(&cmd);
+                    return 0;
                 }
+                cmd.owner = join == JOB_OWNER;
             } else {
-                ESP_LOGE(TAG, "알 수 없는 명령: %c", command[0]);
-                return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+                remember_format(conn_handle, false);
+            }
+
+            if (xQueueSend(command_queue, &cmd, 0) != pdTRUE) {
+                ESP_LOGE(TAG, "명령 큐가 가득 참");
+                if (cmd.owner) {
+                    taskENTER_CRITICAL(&clients_lock);
+                    classify_job.active = false;
+                    taskEXIT_CRITICAL(&clients_lock);
+                }
+                return BLE_ATT_ERR_INSUFFICIENT_RES;
             }
+            ESP_LOGI(TAG, "명령 0x%02x 수신, 처리 대기열에 추가", cmd.cmd);
             return 0;
 
         case BLE_GATT_ACCESS_OP_READ_CHR:
@@ -118,6 +384,51 @@ static int pipeline_chr_access(uint16_t conn_handle, uint16_t attr_handle,
 }
 
 
+static metrics_read_t* find_metrics_read(uint16_t conn_handle) {
+    metrics_read_t* empty = NULL;
+    for (int i = 0; i < BLE_MAX_CLIENTS; i++) {
+        if (metrics_reads[i].conn_handle == conn_handle) {
+            return &metrics_reads[i];
+        }
+        if (!empty && metrics_reads[i].conn_handle == BLE_HS_CONN_HANDLE_NONE) {
+            empty = &metrics_reads[i];
+        }
+    }
+    if (empty) {
+        empty->conn_handle = conn_handle;
+        empty->remaining = 0;
+    }
+    return empty;
+}
+
+// 첫 조각(offset 0)에서 스냅샷을 만들고, 이어지는 read blob 은 같은 버퍼에서 준다
+static int metrics_chr_access(uint16_t conn_handle, uint16_t attr_handle,
+    struct ble_gatt_access_ctxt *ctxt, void *arg) {
+    if (ctxt->op != BLE_GATT_ACCESS_OP_READ_CHR) {
+        return BLE_ATT_ERR_UNLIKELY;
+    }
+
+    metrics_read_t* read = find_metrics_read(conn_handle);
+    if (!read) {
+        return BLE_ATT_ERR_INSUFFICIENT_RES;
+    }
+    int64_t now = esp_timer_get_time();
+    if (read->remaining == 0 || now - read->encoded_us > METRICS_READ_HOLD_MS * 1000LL) {
+        metrics_refresh_system();
+        read->len = metrics_encode(read->data, sizeof(read->data), now / 1000);
+        read->remaining = read->len;
+        read->encoded_us = now;
+    }
+
+    // 응답 하나에 MTU - 1 바이트까지 실린다
+    uint16_t mtu = ble_att_mtu(conn_handle);
+    uint16_t sent = mtu > 1 ? mtu - 1 : read->remaining;
+    read->remaining = read->remaining > sent ? read->remaining - sent : 0;
+
+    int rc = os_mbuf_append(ctxt->om, read->data, read->len);
+    return rc == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+}
+
 void gatt_svr_register_cb(struct ble_gatt_register_ctxt *ctxt, void *arg) {
     char buf[BLE_UUID_STR_LEN];
     ESP_LOGI(TAG, "GATT 서비스 등록 요청, 작업: %d", ctxt->op);
@@ -159,6 +470,350 @@ static int send_notification(uint16_t conn_handle, uint16_t handle, uint8_t* dat
     return rc;
 }
 
+static void queue_notification(uint16_t conn_handle, const void* data, size_t len) {
+    notify_msg_t msg;
+    if (len > NOTIFY_MAX_LEN) {
+        ESP_LOGE(TAG, "응답이 너무 김: %u bytes", (unsigned)len);
+        return;
+    }
+    msg.conn_handle = conn_handle;
+    msg.attr_handle = pipeline_chr_val_handle;
+    msg.len = len;
+    memcpy(msg.data, data, msg.len);
+    if (xQueueSend(notify_queue, &msg, portMAX_DELAY) != pdTRUE) {
+        ESP_LOGE(TAG, "알림 큐 추가 실패");
+    }
+}
+
+// 연결 하나에 응답 전달, 'r' 명령 형식이면 기존 텍스트 알림으로 변환
+static void deliver_reply(uint16_t conn_handle, bool legacy, uint8_t status, const uint8_t* frame, size_t len) {
+    if (!legacy) {
+        queue_notification(conn_handle, frame, len);
+        return;
+    }
+
+    if (status == CMD_STATUS_PENDING) {
+        queue_notification(conn_handle, "w", 1);
+    } else {
+        char text[8];
+        int n = snprintf(text, sizeof(text), "%d", cmd_legacy_result(status, frame, len));
+        queue_notification(conn_handle, text, n);
+        queue_notification(conn_handle, "EOF", 3);
+    }
+}
+
+static bool add_target(ble_client_t* targets, int* count, uint16_t conn_handle, bool legacy) {
+    for (int i = 0; i < *count; i++) {
+        if (targets[i].conn_handle == conn_handle) {
+            return false;
+        }
+    }
+    targets[*count].conn_handle = conn_handle;
+    targets[*count].legacy = legacy;
+    (*count)++;
+    return true;
+}
+
+// 분류 결과 하나를 요청한 연결, 합류한 연결, 결과 알림을 구독한 모든 연결에 전달
+static void fan_out_result(const pipeline_cmd_t* req, uint8_t status, const uint8_t* frame, size_t len) {
+    ble_client_t targets[1 + 2 * BLE_MAX_CLIENTS];
+    int count = 0;
+    add_target(targets, &count, req->conn_handle, req->legacy);
+
+    taskENTER_CRITICAL(&clients_lock);
+    if (req->owner) {
+        for (int i = 0; i < classify_job.joiner_count; i++) {
+            add_target(targets, &count, classify_job.joiners[i].conn_handle, classify_job.joiners[i].legacy);
+        }
+        classify_job.active = false;
+    }
+    // 잘못된 인자 같은 요청 오류는 구독자에게 알리지 않는다
+    bool result = cmd_status_is_result(status);
+    for (int i = 0; i < BLE_MAX_CLIENTS && result; i++) {
+        if (clients[i].conn_handle != BLE_HS_CONN_HANDLE_NONE && clients[i].subscribed) {
+            add_target(targets, &count, clients[i].conn_handle, clients[i].legacy);
+        }
+    }
+    taskEXIT_CRITICAL(&clients_lock);
+
+    if (count > 1) {
+        ESP_LOGI(TAG, "분류 결과를 %d 개 연결에 전달", count);
+    }
+    for (int i = 0; i < count; i++) {
+        deliver_reply(targets[i].conn_handle, targets[i].legacy, status, frame, len);
+    }
+}
+
+static void ble_reply(void* ctx, uint8_t cmd, uint8_t status, const uint8_t* frame, size_t len) {
+    const pipeline_cmd_t* req = (const pipeline_cmd_t*)ctx;
+
+    if ((cmd == CMD_CLASSIFY || cmd == CMD_RECORD) && status != CMD_STATUS_PENDING) {
+        fan_out_result(req, status, frame, len);
+        return;
+    }
+    deliver_reply(req->conn_handle, req->legacy, status, frame, len);
+}
+
+static void pipeline_worker_task(void *arg) {
+    pipeline_cmd_t cmd;
+
+    while (1) {
+        if (xQueueReceive(command_queue, &cmd, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        cmd_frame_t frame = {cmd.cmd, cmd.len, cmd.payload};
+        command_dispatch(&frame, ble_reply, &cmd);
+    }
+}
+
+// 알림 한 개 전송 후 BLE_GAP_EVENT_NOTIFY_TX 를 받을 때까지 기다린다
+static int notify_fragment(void* ctx, const uint8_t* data, size_t len) {
+    const notify_msg_t* msg = (const notify_msg_t*)ctx;
+
+    xSemaphoreTake(notify_tx_done, 0);
+    int rc = BLE_HS_ENOMEM;
+    for (int retry = 0; retry < NOTIFY_MAX_RETRIES; retry++) {
+        rc = send_notification(msg->conn_handle, msg->attr_handle, (uint8_t*)data, len);
+        if (rc != BLE_HS_ENOMEM) {
+            break;
+        }
+        // mbuf 부족: 컨트롤러가 비울 때까지 잠시 대기
+        vTaskDelay(pdMS_TO_TICKS(NOTIFY_RETRY_MS));
+    }
+
+    if (rc == 0 && xSemaphoreTake(notify_tx_done, pdMS_TO_TICKS(NOTIFY_TX_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "알림 전송 완료 이벤트 시간 초과");
+    }
+    return rc;
+}
+
+// 큐의 응답을 하나씩, 연결의 MTU 보다 긴 프레임은 여러 알림으로 나눠 순서대로 보낸다
+static void notify_task(void *arg) {
+    notify_msg_t msg;
+
+    while (1) {
+        if (xQueueReceive(notify_queue, &msg, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        uint16_t mtu = ble_att_mtu(msg.conn_handle);
+        if (mtu < BLE_ATT_MTU_DFLT) {
+            mtu = BLE_ATT_MTU_DFLT;
+        }
+        int rc = cmd_send_fragmented(msg.data, msg.len, mtu - ATT_NOTIFY_OVERHEAD, notify_fragment, &msg);
+        if (rc != 0) {
+            ESP_LOGE(TAG, "파이프라인 결과 전송 실패: %d", rc);
+            metrics_add(METRIC_NOTIFY_FAILURES);
+        }
+    }
+}
+
+void gatt_svr_notify_tx_cb(struct ble_gap_event *event) {
+    if (event->notify_tx.attr_handle == pipeline_chr_val_handle && notify_tx_done) {
+        xSemaphoreGive(notify_tx_done);
+    }
+}
+
+static int bulk_chr_access(uint16_t conn_handle, uint16_t attr_handle,
+    struct ble_gatt_access_ctxt *ctxt, void *arg) {
+    bulk_msg_t msg;
+    uint16_t len;
+
+    if (ctxt->op != BLE_GATT_ACCESS_OP_WRITE_CHR) {
+        return BLE_ATT_ERR_UNLIKELY;
+    }
+
+    len = OS_MBUF_PKTLEN(ctxt->om);
+    if (len < BULK_ACK_SIZE || len > sizeof(msg.data)) {
+        return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+    }
+    if (ble_hs_mbuf_to_flat(ctxt->om, msg.data, sizeof(msg.data), &len) != 0) {
+        return BLE_ATT_ERR_UNLIKELY;
+    }
+
+    msg.conn_handle = conn_handle;
+    msg.len = len;
+    if (xQueueSend(bulk_queue, &msg, 0) != pdTRUE) {
+        return BLE_ATT_ERR_INSUFFICIENT_RES;
+    }
+    return 0;
+}
+
+static size_t bulk_read(void* ctx, uint32_t offset, uint8_t* buf, size_t len) {
+    bulk_source_t* src = (bulk_source_t*)ctx;
+    if (!src->file) {
+        memcpy(buf, src->mem + offset, len);
+        return len;
+    }
+    // 순차 전송에서는 대부분 이미 그 위치에 있으므로 되돌아갈 때만 seek
+    long pos = src->base + offset;
+    if (ftell(src->file) != pos) {
+        fseek(src->file, pos, SEEK_SET);
+    }
+    size_t n = fread(buf, 1, len, src->file);
+    if (src->record && !record_store_contains(src->record_seq)) {
+        src->stale = true;
+        return 0;
+    }
+    return n;
+}
+
+static int bulk_send(void* ctx, const uint8_t* frame, size_t len) {
+    bulk_source_t* src = (bulk_source_t*)ctx;
+    struct os_mbuf *om = ble_hs_mbuf_from_flat(frame, len);
+    if (!om) {
+        src->blocked = true;
+        return BLE_HS_ENOMEM;
+    }
+    int rc = ble_gatts_notify_custom(src->conn_handle, bulk_chr_val_handle, om);
+    src->blocked = rc == BLE_HS_ENOMEM;
+    return rc;
+}
+
+// 요청 종류에 맞춰 원본을 열고 전체 크기를 반환 (실패 시 -1)
+static long bulk_open_source(bulk_source_t* src, uint8_t kind, uint32_t arg) {
+    char path[DATA_PATH_MAX];
+    uint32_t size;
+    int n;
+
+    src->file = NULL;
+    src->base = 0;
+    src->record = false;
+    src->stale = false;
+    switch (kind) {
+        case BULK_KIND_AUDIO:
+            src->file = fopen(data_path(path, sizeof(path), AUDIO_FILE_NAME), "rb");
+            if (!src->file) {
+                return -1;
+            }
+            fseek(src->file, 0, SEEK_END);
+            size = ftell(src->file);
+            fseek(src->file, 0, SEEK_SET);
+            return size;
+
+        case BULK_KIND_RECORD:
+            src->file = record_store_open_wav(arg, &src->base, &size);
+            src->record = true;
+            src->record_seq = arg;
+            return src->file ? (long)size : -1;
+
+        case BULK_KIND_FEATURES:
+            if (arg == 0xffffffff) {
+                arg = record_store_next_seq() - 1;
+            }
+            n = record_store_read_features(arg, (float*)src->mem, sizeof(src->mem) / sizeof(float));
+            return n < 0 ? -1 : n * (long)sizeof(float);
+
+        case BULK_KIND_TRACE: {
+            const pipeline_timing_t* t = pipeline_last_timing();
+            n = snprintf((char*)src->mem, sizeof(src->mem), "total_us=%lld stages=%d\n", (long long)t->total_us,
+                         t->stages_run);
+            for (int i = 0; i < t->stages_run && i < 2; i++) {
+                n += snprintf((char*)src->mem + n, sizeof(src->mem) - n, "stage%d load_us=%lld feature_us=%lld invoke_us=%lld\n",
+                              i + 1, (long long)t->stage[i].model_load_us, (long long)t->stage[i].feature_us,
+                              (long long)t->stage[i].invoke_us);
+            }
+            n += snprintf((char*)src->mem + n, sizeof(src->mem) - n,
+                          "internal_request_peak=%u psram_request_peak=%u internal_peak=%u psram_peak=%u\n",
+                          (unsigned)internal_arena()->last_request_peak, (unsigned)psram_arena()->last_request_peak,
+                          (unsigned)internal_arena()->peak, (unsigned)psram_arena()->peak);
+            return n;
+        }
+
+        default:
+            return -1;
+    }
+}
+
+static void bulk_close_source(bulk_source_t* src) {
+    if (src->file) {
+        fclose(src->file);
+        src->file = NULL;
+    }
+}
+
+// 요청을 받으면 MTU 에 맞춘 청크로 알림을 연속 전송하고, 윈도우가 차면 ACK 를 기다린다
+static void bulk_task(void *arg) {
+    static bulk_source_t src;
+    static bulk_sender_t sender;
+    bulk_msg_t msg;
+    bool active = false;
+    uint8_t stream = 0;
+    int timeouts = 0;
+    int64_t start_us = 0;
+
+    while (1) {
+        TickType_t wait = !active ? portMAX_DELAY
+                          : src.blocked ? pdMS_TO_TICKS(NOTIFY_RETRY_MS)
+                          : pdMS_TO_TICKS(BULK_ACK_TIMEOUT_MS);
+        if (xQueueReceive(bulk_queue, &msg, wait) == pdTRUE) {
+            uint8_t kind;
+            uint32_t req_arg;
+            if (bulk_decode_request(msg.data, msg.len, &kind, &req_arg) == ESP_OK) {
+                // 새 요청은 진행 중인 전송을 대체
+                bulk_close_source(&src);
+                src.conn_handle = msg.conn_handle;
+                src.blocked = false;
+                long size = bulk_open_source(&src, kind, req_arg);
+                if (size < 0) {
+                    ESP_LOGE(TAG, "bulk 요청 원본 없음: kind=%d arg=%u", kind, (unsigned)req_arg);
+                    active = false;
+                    continue;
+                }
+                // 연결마다 교환한 MTU 가 다르므로 요청한 연결의 값을 전송 시작 때 읽는다
+                uint16_t mtu = ble_att_mtu(msg.conn_handle);
+                if (mtu < BLE_ATT_MTU_DFLT) {
+                    mtu = BLE_ATT_MTU_DFLT;
+                }
+                if (bulk_sender_init(&sender, ++stream, kind, size, bulk_chunk_size(mtu), BULK_DEFAULT_WINDOW,
+                                     bulk_read, bulk_send, &src) != ESP_OK) {
+                    ESP_LOGE(TAG, "bulk 요청이 너무 큼: kind=%d, %ld bytes, mtu %d", kind, size, mtu);
+                    bulk_close_source(&src);
+                    active = false;
+                    continue;
+                }
+                ESP_LOGI(TAG, "bulk 전송 시작: kind=%d, %ld bytes, mtu %d, chunk %d", kind, size, mtu,
+                         sender.chunk_size);
+                active = true;
+                timeouts = 0;
+                start_us = esp_timer_get_time();
+            } else if (active && bulk_sender_on_frame(&sender, msg.data, msg.len) == ESP_OK) {
+                timeouts = 0;
+            }
+        } else if (active && !src.blocked) {
+            if (++timeouts > BULK_MAX_TIMEOUTS) {
+                ESP_LOGE(TAG, "bulk 전송 중단: ACK 없음");
+                bulk_close_source(&src);
+                active = false;
+                continue;
+            }
+            bulk_sender_on_timeout(&sender);
+        }
+
+        if (!active) {
+            continue;
+        }
+        src.blocked = false;
+        bulk_sender_pump(&sender);
+        if (src.stale) {
+            ESP_LOGE(TAG, "bulk 전송 중단: 레코드 %u 가 덮어쓰임", (unsigned)src.record_seq);
+            bulk_close_source(&src);
+            active = false;
+            continue;
+        }
+
+        if (sender.done) {
+            int64_t elapsed_us = esp_timer_get_time() - start_us;
+            ESP_LOGI(TAG, "bulk 전송 완료: %u bytes, %u frames, 재전송 %u, %lld ms (%.1f kB/s)",
+                     (unsigned)sender.total_size, (unsigned)sender.frames_sent, (unsigned)sender.retransmits,
+                     (long long)(elapsed_us / 1000), elapsed_us > 0 ? sender.total_size * 1000.0 / elapsed_us : 0.0);
+            bulk_close_source(&src);
+            active = false;
+        }
+    }
+}
+
 void gatt_svr_subscribe_cb(struct ble_gap_event *event) {
     /* Check connection handle */
     if (event->subscribe.conn_handle != BLE_HS_CONN_HANDLE_NONE) {
@@ -167,5 +822,42 @@ void gatt_svr_subscribe_cb(struct ble_gap_event *event) {
     } else {
         ESP_LOGI(TAG, "subscribe by nimble stack; attr_handle=%d",
                  event->subscribe.attr_handle);
+        return;
+    }
+
+    if (event->subscribe.attr_handle != pipeline_chr_val_handle) {
+        return;
+    }
+    taskENTER_CRITICAL(&clients_lock);
+    ble_client_t* client = find_client(event->subscribe.conn_handle, event->subscribe.cur_notify);
+    if (client) {
+        client->subscribed = event->subscribe.cur_notify;
+    }
+    taskEXIT_CRITICAL(&clients_lock);
+    if (!client && event->subscribe.cur_notify) {
+        ESP_LOGW(TAG, "구독 연결 수 초과 (conn %d)", event->subscribe.conn_handle);
+    }
+}
+
+void gatt_svr_disconnect_cb(uint16_t conn_handle) {
+    for (int i = 0; i < BLE_MAX_CLIENTS; i++) {
+        if (metrics_reads[i].conn_handle == conn_handle) {
+            metrics_reads[i].conn_handle = BLE_HS_CONN_HANDLE_NONE;
+        }
+    }
+
+    taskENTER_CRITICAL(&clients_lock);
+    ble_client_t* client = find_client(conn_handle, false);
+    if (client) {
+        client->conn_handle = BLE_HS_CONN_HANDLE_NONE;
+        client->subscribed = false;
+    }
+    // 결과를 기다리던 연결이 끊기면 합류 목록에서 제외
+    for (int i = 0; i < classify_job.joiner_count; i++) {
+        if (classify_job.joiners[i].conn_handle == conn_handle) {
+            classify_job.joiners[i] = classify_job.joiners[--classify_job.joiner_count];
+            break;
+        }
     }
+    taskEXIT_CRITICAL(&clients_lock);
 }
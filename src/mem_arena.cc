@@ -0,0 +1,106 @@
+#include "mem_arena.h"
+#include "mem_placement.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+static const char* TAG = "MEM_ARENA";
+
+static mem_arena_t internal;
+static mem_arena_t psram;
+// bind_request_arenas() 로 현재 스레드에 묶인 아레나, 없으면 전역 아레나
+static thread_local mem_arena_t* bound_internal;
+static thread_local mem_arena_t* bound_psram;
+
+esp_err_t mem_arena_init(mem_arena_t* arena, const char* name, size_t size, uint32_t caps) {
+    arena->name = name;
+    arena->base = (uint8_t*)heap_caps_aligned_alloc(MEM_ARENA_ALIGN, size, caps);
+    arena->size = arena->base ? size : 0;
+    arena->used = 0;
+    arena->peak = 0;
+    arena->request_peak = 0;
+    arena->last_request_peak = 0;
+    arena->caps = caps;
+    if (!arena->base) {
+        ESP_LOGE(TAG, "Failed to allocate %s arena (%u bytes)", name, (unsigned)size);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void mem_arena_deinit(mem_arena_t* arena) {
+    heap_caps_free(arena->base);
+    arena->base = NULL;
+    arena->size = 0;
+    arena->used = 0;
+}
+
+void* mem_arena_alloc(mem_arena_t* arena, size_t size, size_t align) {
+    size_t offset = (arena->used + align - 1) & ~(align - 1);
+    if (!arena->base || offset + size > arena->size) {
+        ESP_LOGE(TAG, "%s arena exhausted: need %u, used %u of %u", arena->name,
+                 (unsigned)size, (unsigned)arena->used, (unsigned)arena->size);
+        return NULL;
+    }
+    arena->used = offset + size;
+    if (arena->used > arena->request_peak) {
+        arena->request_peak = arena->used;
+        if (arena->used > arena->peak) {
+            arena->peak = arena->used;
+        }
+    }
+    return arena->base + offset;
+}
+
+void mem_arena_rewind(mem_arena_t* arena, size_t mark) {
+    if (mark < arena->used) {
+        arena->used = mark;
+    }
+}
+
+void mem_arena_reset(mem_arena_t* arena) {
+    arena->used = 0;
+    arena->last_request_peak = arena->request_peak;
+    arena->request_peak = 0;
+}
+
+esp_err_t init_request_arenas() {
+    esp_err_t ret = mem_arena_init(&internal, "internal", INTERNAL_ARENA_SIZE,
+                                   mem_place_caps(MEM_FRAME_SCRATCH, INTERNAL_ARENA_SIZE));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = mem_arena_init(&psram, "psram", PSRAM_ARENA_SIZE, mem_place_caps(MEM_REQUEST_BULK, PSRAM_ARENA_SIZE));
+    if (ret != ESP_OK) {
+        mem_arena_deinit(&internal);
+        return ret;
+    }
+    return ESP_OK;
+}
+
+void cleanup_request_arenas() {
+    mem_arena_deinit(&internal);
+    mem_arena_deinit(&psram);
+}
+
+void bind_request_arenas(mem_arena_t* internal_req, mem_arena_t* psram_req) {
+    bound_internal = internal_req;
+    bound_psram = psram_req;
+}
+
+mem_arena_t* internal_arena() {
+    return bound_internal ? bound_internal : &internal;
+}
+
+mem_arena_t* psram_arena() {
+    return bound_psram ? bound_psram : &psram;
+}
+
+void reset_request_arenas() {
+    mem_arena_t* in = internal_arena();
+    mem_arena_t* ps = psram_arena();
+    ESP_LOGI(TAG, "request high-water: internal %u/%u, psram %u/%u (lifetime %u, %u)",
+             (unsigned)in->request_peak, (unsigned)in->size, (unsigned)ps->request_peak, (unsigned)ps->size,
+             (unsigned)in->peak, (unsigned)ps->peak);
+    mem_arena_reset(in);
+    mem_arena_reset(ps);
+}
@@ -0,0 +1,82 @@
+#include "mem_placement.h"
+#include "esp_log.h"
+
+#include <string.h>
+
+static const char* TAG = "MEM_PLACE";
+
+static const char* const region_names[MEM_REGION_COUNT] = {
+    "dsp_tables", "frame_scratch", "resampler", "request_bulk", "model", "audio",
+};
+
+static mem_tier_t tiers[MEM_REGION_COUNT] = {
+    MEM_PLACE_DSP_TABLES, MEM_PLACE_FRAME_SCRATCH, MEM_PLACE_RESAMPLER,
+    MEM_PLACE_REQUEST_BULK, MEM_PLACE_MODEL, MEM_PLACE_AUDIO,
+};
+
+// [영역][0: 내부 RAM, 1: PSRAM] 배치한 바이트 (해제는 추적하지 않는 누적값)
+// 부팅 단계들이 동시에 할당하므로 원자적으로 갱신
+static size_t placed_bytes[MEM_REGION_COUNT][2];
+static uint32_t fallbacks[MEM_REGION_COUNT];
+
+void mem_place_set(mem_region_t region, mem_tier_t tier) {
+    tiers[region] = tier;
+}
+
+mem_tier_t mem_place_tier(mem_region_t region) {
+    return tiers[region];
+}
+
+// HOT 은 한 블록으로 들어가고 예약분이 남을 때만 내부 RAM
+static uint32_t decide(mem_region_t region, size_t size) {
+    if (tiers[region] == MEM_COLD) {
+        // PSRAM 이 없는 보드는 내부 RAM
+        return heap_caps_get_free_size(MEM_CAPS_COLD) >= size ? MEM_CAPS_COLD : MEM_CAPS_HOT;
+    }
+    size_t free_internal = heap_caps_get_free_size(MEM_CAPS_HOT);
+    if (heap_caps_get_largest_free_block(MEM_CAPS_HOT) >= size && free_internal >= size + MEM_INTERNAL_RESERVE) {
+        return MEM_CAPS_HOT;
+    }
+    __atomic_fetch_add(&fallbacks[region], 1, __ATOMIC_RELAXED);
+    ESP_LOGW(TAG, "%s: %u bytes do not fit internal RAM (%u free), using PSRAM", region_names[region],
+             (unsigned)size, (unsigned)free_internal);
+    return MEM_CAPS_COLD;
+}
+
+static void record(mem_region_t region, uint32_t caps, size_t size) {
+    __atomic_fetch_add(&placed_bytes[region][caps == MEM_CAPS_HOT ? 0 : 1], size, __ATOMIC_RELAXED);
+}
+
+uint32_t mem_place_caps(mem_region_t region, size_t size) {
+    uint32_t caps = decide(region, size);
+    record(region, caps, size);
+    return caps;
+}
+
+void* mem_place_alloc(mem_region_t region, size_t size, size_t align, bool zero) {
+    uint32_t caps = decide(region, size);
+    void* ptr = heap_caps_aligned_alloc(align, size, caps);
+    if (!ptr && caps == MEM_CAPS_HOT) {
+        // 조각난 내부 RAM 에서 실패하면 PSRAM 으로
+        __atomic_fetch_add(&fallbacks[region], 1, __ATOMIC_RELAXED);
+        caps = MEM_CAPS_COLD;
+        ptr = heap_caps_aligned_alloc(align, size, caps);
+    }
+    if (!ptr) {
+        ESP_LOGE(TAG, "%s: failed to allocate %u bytes", region_names[region], (unsigned)size);
+        return NULL;
+    }
+    if (zero) {
+        memset(ptr, 0, size);
+    }
+    record(region, caps, size);
+    return ptr;
+}
+
+void mem_place_report() {
+    ESP_LOGI(TAG, "%-14s %5s %10s %10s %9s", "region", "tier", "internal", "psram", "fallbacks");
+    for (int i = 0; i < MEM_REGION_COUNT; i++) {
+        ESP_LOGI(TAG, "%-14s %5s %10u %10u %9u", region_names[i], tiers[i] == MEM_HOT ? "hot" : "cold",
+                 (unsigned)placed_bytes[i][0], (unsigned)placed_bytes[i][1], (unsigned)fallbacks[i]);
+    }
+}
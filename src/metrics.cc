@@ -0,0 +1,129 @@
+#include "metrics.h"
+
+#include <string.h>
+
+static uint32_t counters[METRIC_COUNTER_COUNT];
+static uint32_t gauges[METRIC_GAUGE_COUNT];
+static uint32_t buckets[METRIC_HIST_COUNT][METRICS_HIST_BUCKETS];
+static uint32_t hist_max[METRIC_HIST_COUNT];
+
+static int bucket_of(int64_t us) {
+    if (us <= 1) {
+        return 0;
+    }
+    int bucket = 63 - __builtin_clzll((uint64_t)us);
+    return bucket < METRICS_HIST_BUCKETS ? bucket : METRICS_HIST_BUCKETS - 1;
+}
+
+void metrics_add(metric_counter_t counter, uint32_t n) {
+    __atomic_fetch_add(&counters[counter], n, __ATOMIC_RELAXED);
+}
+
+void metrics_set(metric_gauge_t gauge, uint32_t value) {
+    __atomic_store_n(&gauges[gauge], value, __ATOMIC_RELAXED);
+}
+
+void metrics_observe(metric_hist_t hist, int64_t us) {
+    if (us < 0) {
+        us = 0;
+    }
+    __atomic_fetch_add(&buckets[hist][bucket_of(us)], 1, __ATOMIC_RELAXED);
+
+    uint32_t value = us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+    uint32_t seen = __atomic_load_n(&hist_max[hist], __ATOMIC_RELAXED);
+    while (value > seen &&
+           !__atomic_compare_exchange_n(&hist_max[hist], &seen, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+uint32_t metrics_counter(metric_counter_t counter) {
+    return __atomic_load_n(&counters[counter], __ATOMIC_RELAXED);
+}
+
+void metrics_hist_buckets(metric_hist_t hist, uint32_t* out) {
+    for (int i = 0; i < METRICS_HIST_BUCKETS; i++) {
+        out[i] = __atomic_load_n(&buckets[hist][i], __ATOMIC_RELAXED);
+    }
+}
+
+// rank 번째 관측값이 속한 버킷 안에서 선형 보간, 최댓값을 넘지 않게 자른다
+static uint32_t percentile(const uint32_t* counts, uint32_t total, uint32_t max_us, uint32_t permille) {
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = ((uint64_t)total * permille + 999) / 1000;
+    uint64_t seen = 0;
+    for (int i = 0; i < METRICS_HIST_BUCKETS; i++) {
+        if (counts[i] == 0 || seen + counts[i] < rank) {
+            seen += counts[i];
+            continue;
+        }
+        uint64_t lo = i == 0 ? 0 : 1ull << i;
+        uint64_t hi = i == METRICS_HIST_BUCKETS - 1 ? max_us : 2ull << i;
+        uint64_t value = lo + (hi - lo) * (rank - seen) / counts[i];
+        return value < max_us ? (uint32_t)value : max_us;
+    }
+    return max_us;
+}
+
+void metrics_hist_summary(metric_hist_t hist, metric_hist_summary_t* out) {
+    uint32_t counts[METRICS_HIST_BUCKETS];
+    metrics_hist_buckets(hist, counts);
+    uint32_t total = 0;
+    for (int i = 0; i < METRICS_HIST_BUCKETS; i++) {
+        total += counts[i];
+    }
+
+    out->count = total;
+    out->max_us = __atomic_load_n(&hist_max[hist], __ATOMIC_RELAXED);
+    out->p50_us = percentile(counts, total, out->max_us, 500);
+    out->p99_us = percentile(counts, total, out->max_us, 990);
+}
+
+void metrics_reset() {
+    for (int i = 0; i < METRIC_COUNTER_COUNT; i++) {
+        __atomic_store_n(&counters[i], 0, __ATOMIC_RELAXED);
+    }
+    for (int h = 0; h < METRIC_HIST_COUNT; h++) {
+        for (int i = 0; i < METRICS_HIST_BUCKETS; i++) {
+            __atomic_store_n(&buckets[h][i], 0, __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&hist_max[h], 0, __ATOMIC_RELAXED);
+    }
+}
+
+static uint8_t* put_u32(uint8_t* p, uint32_t value) {
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+    return p + 4;
+}
+
+size_t metrics_encode(uint8_t* out, size_t cap, uint32_t uptime_ms) {
+    if (cap < METRICS_ENCODED_SIZE) {
+        return 0;
+    }
+
+    uint8_t* p = out;
+    *p++ = METRICS_VERSION;
+    *p++ = METRIC_COUNTER_COUNT;
+    *p++ = METRIC_GAUGE_COUNT;
+    *p++ = METRIC_HIST_COUNT;
+    p = put_u32(p, uptime_ms);
+    for (int i = 0; i < METRIC_COUNTER_COUNT; i++) {
+        p = put_u32(p, metrics_counter((metric_counter_t)i));
+    }
+    for (int i = 0; i < METRIC_GAUGE_COUNT; i++) {
+        p = put_u32(p, __atomic_load_n(&gauges[i], __ATOMIC_RELAXED));
+    }
+    for (int i = 0; i < METRIC_HIST_COUNT; i++) {
+        metric_hist_summary_t summary;
+        metrics_hist_summary((metric_hist_t)i, &summary);
+        p = put_u32(p, summary.count);
+        p = put_u32(p, summary.p50_us);
+        p = put_u32(p, summary.p99_us);
+        p = put_u32(p, summary.max_us);
+    }
+    return p - out;
+}
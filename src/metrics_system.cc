@@ -0,0 +1,42 @@
+#include "metrics.h"
+#include "mem_arena.h"
+#include "power_mgmt.h"
+
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// METRIC_STACK_FIRST 부터 이 순서로 기록, 없는 태스크(BLE 비활성 등)는 0
+static const char* const watched_tasks[METRICS_MAX_TASKS] = {
+    "uart_event",
+    "pipeline_worker",
+    "ble_notify",
+    "ble_bulk",
+    "nimble_host",
+    "sched_capture",
+    "sched_feature",
+    "sched_infer",
+    "cont_capture",
+    "cont_process",
+    "uart_worker",
+};
+
+void metrics_refresh_system() {
+    metrics_set(METRIC_FREE_INTERNAL, heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+    metrics_set(METRIC_FREE_PSRAM, heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+    metrics_set(METRIC_LARGEST_INTERNAL, heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+    metrics_set(METRIC_MIN_FREE_INTERNAL, heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL));
+    metrics_set(METRIC_INTERNAL_ARENA_PEAK, internal_arena()->peak);
+    metrics_set(METRIC_PSRAM_ARENA_PEAK, psram_arena()->peak);
+
+    uint32_t max_freq_ms, low_ms;
+    power_times(&max_freq_ms, &low_ms);
+    metrics_set(METRIC_PM_MAX_FREQ_MS, max_freq_ms);
+    metrics_set(METRIC_PM_LOW_MS, low_ms);
+
+    for (int i = 0; i < METRICS_MAX_TASKS; i++) {
+        TaskHandle_t task = xTaskGetHandle(watched_tasks[i]);
+        // ESP-IDF 의 high water mark 는 바이트 단위
+        metrics_set((metric_gauge_t)(METRIC_STACK_FIRST + i), task ? uxTaskGetStackHighWaterMark(task) : 0);
+    }
+}
@@ -1,6 +1,15 @@
-#include "rel_common.h"
 #include "model_inference.h"
-#include "audio_processing.h"
+#include "feature_extraction.h"
+#include "feature_pipeline.h"
+#include "delta_features.h"
+#include "audio_config.h"
+#include "data_paths.h"
+#include "mem_arena.h"
+#include "mem_placement.h"
+#include "sd_reader.h"
+#include "record_store.h"
+#include "request_budget.h"
+#include "metrics.h"
 #include "esp_log.h"
 #include "esp_heap_caps.h"
 #include "esp_timer.h"
@@ -9,189 +18,628 @@
 #include "tensorflow/lite/micro/micro_interpreter.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <mutex>
+#include <new>
+
 static const char* TAG = "MODEL_INFERENCE";
 
-tflite::MicroMutableOpResolver<3> resolver1;
-tflite::MicroMutableOpResolver<4> resolver2;
-static tflite::MicroInterpreter* interpreter;
+tflite::MicroMutableOpResolver<10> resolver_spectrogram;
+static pipeline_result_t last_result;
+static volatile pipeline_mode_t pipeline_mode = DEFAULT_PIPELINE_MODE;
+static volatile uint32_t request_budget_ms = REQUEST_BUDGET_MS;
+
+// DEGRADE_SHORT_AUDIO 에서 특징 추출에 쓰는 앞쪽 샘플 수
+#define SHORT_AUDIO_SIZE (SAMPLE_RATE * BUDGET_SHORT_AUDIO_MS / 1000)
+
+// 추측 실행 중인 2단계 (pipeline_file() 전용이라 한 번에 하나)
+typedef struct {
+    const int16_t* samples;
+    size_t count;
+    bool cancel;
+    int pred;                   // -1 실패, -2 취소
+    stage_timing_t timing;
+    float features[STAGE2_FEATURES];
+    float scores[PIPELINE_MAX_SCORES];
+    int score_count;
+} speculative_job_t;
+
+static const stage_executor_t* spec_executor;
+static speculative_job_t spec_job;
+static mem_arena_t spec_internal;
+static mem_arena_t spec_psram;
+
+// 부팅 시 미리 읽어 둔 모델 (경로가 같으면 SD 를 다시 읽지 않는다)
+// 명령 태스크는 preload 와 동시에 시작하므로 슬롯은 다 읽은 뒤 data 를 release 로 기록해 공개하고,
+// 공개된 슬롯은 cleanup_model_inference() 전까지 바꾸지 않는다
+typedef struct {
+    char path[DATA_PATH_MAX];
+    uint8_t* data;
+    long size;
+} cached_model_t;
+static cached_model_t model_cache[3];
+
+// 캐스케이드 단계 정의 (특징 파이프라인 + 모델 파일 + 연산자), 모델을 추가하려면 spec 과 CascadeStage 인스턴스 하나
+struct stage1_spec {
+    static constexpr int n_mfcc = 40;
+    static constexpr scale_order_t order = SCALE_BEFORE_DELTAS;
+    static constexpr const char* scaler = FIRST_SCALER_FILE_NAME;
+    static constexpr const char* model = FIRST_MODEL_FILE_NAME;
+    static constexpr unsigned int ops = 3;
+    template <typename Resolver>
+    static void add_ops(Resolver& resolver) {
+        resolver.AddFullyConnected();
+        resolver.AddLeakyRelu();
+        resolver.AddLogistic();
+    }
+};
+
+struct stage2_spec {
+    static constexpr int n_mfcc = 80;
+    static constexpr scale_order_t order = SCALE_AFTER_DELTAS;
+    static constexpr const char* scaler = SECOND_SCALER_FILE_NAME;
+    static constexpr const char* model = SECOND_MODEL_FILE_NAME;
+    static constexpr unsigned int ops = 3;
+    template <typename Resolver>
+    static void add_ops(Resolver& resolver) {
+        resolver.AddFullyConnected();
+        resolver.AddLeakyRelu();
+        resolver.AddSoftmax();
+    }
+};
+
+// 한 단계: 특징을 모델 입력 텐서에 바로 기록하고 실행 (argmax, 실패 시 -1)
+template <typename Spec>
+class CascadeStage {
+public:
+    typedef FeaturePipeline<Spec> Features;
+    static constexpr int kFeatures = Features::kFeatures;
+
+    static void init() { Spec::add_ops(resolver_); }
+    // 특징은 audio_file 에서 추출하거나 (features == NULL) 미리 계산된 값을 복사
+    // features_out / scores 가 있으면 모델 입력과 출력 점수를 복사
+    // max_samples: audio_file 에서 특징 추출에 쓸 앞쪽 샘플 수
+    static int predict(FILE* audio_file, const float* features, stage_timing_t* timing, float* features_out = NULL,
+                       float* scores = NULL, int* score_count = NULL, size_t max_samples = MAX_AUDIO_SIZE);
+    static int predict_with(const char* model_path, FILE* audio_file, const float* features, stage_timing_t* timing,
+                            float* features_out, float* scores, int* score_count, size_t max_samples);
+    // 메모리상의 PCM 클립에서 특징을 입력 텐서에 바로 추출 (scratch 는 요청 내부 아레나)
+    static int predict_samples(const int16_t* samples, size_t count, stage_timing_t* timing, float* features_out,
+                               float* scores, int* score_count);
+
+private:
+    static esp_err_t fill(TfLiteTensor* input, void* ctx);
+    static tflite::MicroMutableOpResolver<Spec::ops> resolver_;
+};
+
+template <typename Spec>
+tflite::MicroMutableOpResolver<Spec::ops> CascadeStage<Spec>::resolver_;
+
+typedef CascadeStage<stage1_spec> Stage1;
+typedef CascadeStage<stage2_spec> Stage2;
+static_assert(Stage1::kFeatures == STAGE1_FEATURES && Stage2::kFeatures == STAGE2_FEATURES,
+              "clip_features_t layout");
 
 esp_err_t init_model_inference() {
-    resolver1.AddFullyConnected();
-    resolver1.AddLeakyRelu();
-    resolver1.AddLogistic();
-
-    resolver2.AddFullyConnected();
-    resolver2.AddLeakyRelu();
-    resolver2.AddSoftmax();
+    Stage1::init();
+    Stage2::init();
+
+    // 합성곱 스펙트로그램 모델 (int8 모델의 입출력 Quantize / Dequantize 포함)
+    resolver_spectrogram.AddConv2D();
+    resolver_spectrogram.AddDepthwiseConv2D();
+    resolver_spectrogram.AddMaxPool2D();
+    resolver_spectrogram.AddAveragePool2D();
+    resolver_spectrogram.AddReshape();
+    resolver_spectrogram.AddMean();
+    resolver_spectrogram.AddFullyConnected();
+    resolver_spectrogram.AddSoftmax();
+    resolver_spectrogram.AddQuantize();
+    resolver_spectrogram.AddDequantize();
 
     return ESP_OK;
 }
 
 void cleanup_model_inference() {
-    // 필요한 경우 모델 관련 리소스 정리
+    for (int i = 0; i < 3; i++) {
+        heap_caps_free(model_cache[i].data);
+        model_cache[i].data = NULL;
+        model_cache[i].path[0] = '\0';
+    }
 }
 
-esp_err_t model_predict(FILE* audio_file, const char* model_path, int feature_num) {
-    const int kTensorArenaSize = 250 * 1024;
-    float* features = (float*)heap_caps_malloc(feature_num * sizeof(float), MALLOC_CAP_SPIRAM);
-    if (!features) {
-        ESP_LOGE(TAG, "Failed to allocate features");
+static const cached_model_t* cached_model(const char* path) {
+    for (int i = 0; i < 3; i++) {
+        if (__atomic_load_n(&model_cache[i].data, __ATOMIC_ACQUIRE) && strcmp(model_cache[i].path, path) == 0) {
+            return &model_cache[i];
+        }
+    }
+    return NULL;
+}
+
+// 스펙트로그램 스케일러는 선택 사항, 처음 한 번만 읽고 (없으면 경고 한 번) 이후 요청은 캐시 사용
+static std::once_flag spectrogram_scaler_once;
+static bool spectrogram_scaled;
+static float spectrogram_mean;
+static float spectrogram_std;
+
+static void load_spectrogram_scaler() {
+    std::call_once(spectrogram_scaler_once, [] {
+        char scaler_path[DATA_PATH_MAX];
+        // load_scaler() 는 파일이 없으면 오류를 남기므로 있는지 먼저 확인
+        FILE* probe = fopen(data_path(scaler_path, sizeof(scaler_path), SPECTROGRAM_SCALER_FILE_NAME), "rb");
+        if (probe) {
+            fclose(probe);
+            spectrogram_scaled = load_scaler(scaler_path, &spectrogram_mean, &spectrogram_std) == ESP_OK;
+        }
+        if (!spectrogram_scaled) {
+            ESP_LOGW(TAG, "%s not found, spectrogram features are not scaled", scaler_path);
+        }
+    });
+}
+
+static esp_err_t preload_model(cached_model_t* cache, const char* name) {
+    cached_model_t loaded;
+    data_path(loaded.path, sizeof(loaded.path), name);
+    if (cached_model(loaded.path)) {
+        return ESP_OK;
+    }
+    if (__atomic_load_n(&cache->data, __ATOMIC_ACQUIRE)) {
+        // 다른 모델이 공개된 슬롯은 요청이 쓰고 있을 수 있다
+        ESP_LOGW(TAG, "model slot busy, %s stays on SD", loaded.path);
         return ESP_FAIL;
     }
+    size_t size;
+    if (sd_file_size(loaded.path, &size) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    loaded.size = size;
+
+    // flatbuffer 는 16바이트 정렬이 필요
+    loaded.data = (uint8_t*)mem_place_alloc(MEM_MODEL, size, 16);
+    size_t read = 0;
+    bool ok = loaded.data && sd_read_file(loaded.path, loaded.data, size, &read) == ESP_OK && read == size;
+    if (!ok) {
+        heap_caps_free(loaded.data);
+        return ESP_FAIL;
+    }
+
+    // data 가 NULL 인 동안 요청은 이 슬롯을 보지 않는다
+    memcpy(cache->path, loaded.path, sizeof(cache->path));
+    cache->size = loaded.size;
+    __atomic_store_n(&cache->data, loaded.data, __ATOMIC_RELEASE);
+    ESP_LOGI(TAG, "preloaded %s (%ld bytes)", cache->path, cache->size);
+    return ESP_OK;
+}
 
-    uint8_t* tensor_arena = (uint8_t*)heap_caps_malloc(kTensorArenaSize, MALLOC_CAP_SPIRAM);
+// 이미 읽은 모델은 그대로 두고 빠진 모델만 읽는다 (요청 처리 중에도 호출 가능)
+esp_err_t preload_models() {
+    Stage1::Features::load_scaler_once();
+    Stage2::Features::load_scaler_once();
+    esp_err_t ret = preload_model(&model_cache[0], FIRST_MODEL_FILE_NAME);
+    if (ret == ESP_OK) {
+        ret = preload_model(&model_cache[1], SECOND_MODEL_FILE_NAME);
+    }
+    if (ret == ESP_OK && pipeline_mode == PIPELINE_SPECTROGRAM) {
+        ret = preload_model(&model_cache[2], SPECTROGRAM_MODEL_FILE_NAME);
+        load_spectrogram_scaler();
+    }
+    return ret;
+}
+
+// 입력 텐서 채우기, 모델 로드와 AllocateTensors 이후 Invoke 전에 호출
+typedef esp_err_t (*fill_input_fn)(TfLiteTensor* input, void* ctx);
+
+// 출력 i 번째 점수 (int8 출력이면 역양자화)
+static float output_score(const TfLiteTensor* output, int i) {
+    if (output->type == kTfLiteInt8) {
+        return (output->data.int8[i] - output->params.zero_point) * output->params.scale;
+    }
+    return output->data.f[i];
+}
+
+// 모델 로드 -> 인터프리터 생성 -> fill() 로 입력 기록 -> 실행, argmax 반환 (실패 시 -1)
+// scores 가 있으면 출력 점수를 복사 (재진입 가능, 호출 스레드의 아레나 사용)
+static int run_model(const char* model_path, const tflite::MicroOpResolver& resolver, fill_input_fn fill,
+                     void* ctx, stage_timing_t* timing, float* scores, int* score_count) {
+    const int kTensorArenaSize = 250 * 1024;
+    int64_t start_time = esp_timer_get_time();
+    ArenaBuffer<uint8_t> tensor_arena(psram_arena(), kTensorArenaSize);
     if (!tensor_arena) {
         ESP_LOGE(TAG, "Failed to allocate tensor arena");
-        heap_caps_free(features);
         return ESP_FAIL;
     }
 
-    FILE* model_file = fopen(model_path, "rb");
-    if (!model_file) {
+    const cached_model_t* cached = cached_model(model_path);
+    size_t model_size = 0;
+    if (!cached && sd_file_size(model_path, &model_size) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to open model file");
-        heap_caps_free(features);
-        heap_caps_free(tensor_arena);
         return ESP_FAIL;
     }
 
-    fseek(model_file, 0, SEEK_END);
-    long model_size = ftell(model_file);
-    fseek(model_file, 0, SEEK_SET);
+    ArenaBuffer<uint8_t> model_data(psram_arena(), model_size);
+    if (!cached) {
+        size_t read = 0;
+        if (!model_data) {
+            ESP_LOGE(TAG, "Failed to allocate memory for model");
+            return ESP_FAIL;
+        }
+        if (sd_read_file(model_path, model_data.get(), model_size, &read) != ESP_OK || read != model_size) {
+            return ESP_FAIL;
+        }
+    }
 
-    uint8_t* model_data = (uint8_t*)heap_caps_malloc(model_size, MALLOC_CAP_SPIRAM);
-    if (!model_data) {
-        ESP_LOGE(TAG, "Failed to allocate memory for model");
-        fclose(model_file);
-        heap_caps_free(features);
-        heap_caps_free(tensor_arena);
+    ArenaBuffer<uint8_t> interpreter_mem(psram_arena(), sizeof(tflite::MicroInterpreter));
+    if (!interpreter_mem) {
+        ESP_LOGE(TAG, "Failed to allocate interpreter");
         return ESP_FAIL;
     }
 
-    fread(model_data, 1, model_size, model_file);
-    fclose(model_file);
+    const tflite::Model* model = tflite::GetModel(cached ? cached->data : model_data.get());
+    tflite::MicroInterpreter* interpreter = new (interpreter_mem.get())
+        tflite::MicroInterpreter(model, resolver, tensor_arena.get(), kTensorArenaSize, nullptr, nullptr);
+
+    int result = ESP_FAIL;
+    int64_t load_done = 0;
+    int64_t feature_done = 0;
 
-    const tflite::Model* model = tflite::GetModel(model_data);
-    if (feature_num == 120)
-        interpreter = new tflite::MicroInterpreter(model, resolver1, tensor_arena, kTensorArenaSize, nullptr, nullptr);
-    else
-        interpreter = new tflite::MicroInterpreter(model, resolver2, tensor_arena, kTensorArenaSize, nullptr, nullptr);
     if (interpreter->AllocateTensors() != kTfLiteOk) {
         ESP_LOGE(TAG, "Failed to allocate tensors");
-        heap_caps_free(features);
-        heap_caps_free(tensor_arena);
-        heap_caps_free(model_data);
-        delete interpreter;
-        return ESP_FAIL;
+        goto cleanup;
     }
 
-    esp_err_t ret;
-    if (feature_num == 120) {
-        ret = process1(audio_file, features);
-    } else {
-        ret = process2(audio_file, features);
-    }
+    load_done = esp_timer_get_time();
 
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Audio processing failed");
-        heap_caps_free(features);
-        heap_caps_free(tensor_arena);
-        heap_caps_free(model_data);
-        delete interpreter;
-        return ESP_FAIL;
+    if (fill(interpreter->input(0), ctx) != ESP_OK) {
+        goto cleanup;
     }
 
-    memcpy(interpreter->input(0)->data.f, features, feature_num * sizeof(float));
+    feature_done = esp_timer_get_time();
 
     if (interpreter->Invoke() != kTfLiteOk) {
         ESP_LOGE(TAG, "Inference failed");
-        heap_caps_free(features);
-        heap_caps_free(tensor_arena);
-        heap_caps_free(model_data);
-        delete interpreter;
-        return ESP_FAIL;
+        goto cleanup;
     }
 
-    float* output = interpreter->output(0)->data.f;
-    int output_size = interpreter->output(0)->dims->data[1];
-    int result = std::distance(output, std::max_element(output, output + output_size));
+    {
+        const TfLiteTensor* output = interpreter->output(0);
+        int output_size = output->dims->data[output->dims->size - 1];
+        float best = 0.0f;
+        for (int i = 0; i < output_size; i++) {
+            float score = output_score(output, i);
+            if (scores && i < PIPELINE_MAX_SCORES) {
+                scores[i] = score;
+            }
+            if (i == 0 || score > best) {
+                best = score;
+                result = i;
+            }
+        }
+        if (scores) {
+            *score_count = std::min(output_size, PIPELINE_MAX_SCORES);
+        }
+    }
 
-    heap_caps_free(features);
-    heap_caps_free(tensor_arena);
-    heap_caps_free(model_data);
-    delete interpreter;
+    if (timing) {
+        timing->model_load_us = load_done - start_time;
+        timing->feature_us = feature_done - load_done;
+        timing->invoke_us = esp_timer_get_time() - feature_done;
+    }
 
+cleanup:
+    interpreter->~MicroInterpreter();
     return result;
 }
 
-esp_err_t process1(FILE* audio_file, float* features) {
-    float* mfcc = (float*)heap_caps_malloc(40 * sizeof(float), MALLOC_CAP_SPIRAM);
-    float* delta_mfccs = (float*)heap_caps_calloc(40, sizeof(float), MALLOC_CAP_SPIRAM);
-    float* delta2_mfccs = (float*)heap_caps_calloc(40, sizeof(float), MALLOC_CAP_SPIRAM);
+// 캐스케이드 모델의 1차원 특징 입력
+typedef struct {
+    FILE* audio_file;
+    const float* features;
+    const int16_t* samples;
+    size_t count;
+    float* features_out;
+    size_t max_samples;
+} vector_input_t;
+
+template <typename Spec>
+esp_err_t CascadeStage<Spec>::fill(TfLiteTensor* input, void* ctx) {
+    const vector_input_t* in = (const vector_input_t*)ctx;
+    if (input->type != kTfLiteFloat32 || input->bytes < kFeatures * sizeof(float)) {
+        ESP_LOGE(TAG, "Unexpected input tensor (type %d, %u bytes)", input->type, (unsigned)input->bytes);
+        return ESP_FAIL;
+    }
 
-    if (!mfcc || !delta_mfccs || !delta2_mfccs) {
-        ESP_LOGE(TAG, "Failed to allocate memory for MFCC");
-        return ESP_ERR_NO_MEM;
+    // 특징을 입력 텐서에 바로 기록
+    if (in->features) {
+        memcpy(input->data.f, in->features, kFeatures * sizeof(float));
+    } else if (in->samples) {
+        if (Features::from_samples(in->samples, in->count, input->data.f, internal_arena()) != ESP_OK) {
+            ESP_LOGE(TAG, "Audio processing failed");
+            return ESP_FAIL;
+        }
+    } else if (Features::from_file(in->audio_file, input->data.f, in->max_samples) != ESP_OK) {
+        ESP_LOGE(TAG, "Audio processing failed");
+        return ESP_FAIL;
     }
 
-    esp_err_t ret = feature_extractor(audio_file, mfcc, 40);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Feature extraction failed");
-        goto cleanup;
+    // 실행 중 입력 텐서 메모리가 재사용될 수 있으므로 Invoke 전에 복사
+    if (in->features_out) {
+        memcpy(in->features_out, input->data.f, kFeatures * sizeof(float));
     }
+    return ESP_OK;
+}
 
-    scaler(mfcc, 40, "/sdcard/first_model_scaler.pkl");
-    differential_mfcc(mfcc, delta_mfccs, delta2_mfccs, 40);
+template <typename Spec>
+int CascadeStage<Spec>::predict_with(const char* model_path, FILE* audio_file, const float* features,
+                                     stage_timing_t* timing, float* features_out, float* scores, int* score_count,
+                                     size_t max_samples) {
+    vector_input_t in = {audio_file, features, NULL, 0, features_out, max_samples};
+    return run_model(model_path, resolver_, fill, &in, timing, scores, score_count);
+}
 
-    memcpy(features, mfcc, 40 * sizeof(float));
-    memcpy(features + 40, delta_mfccs, 40 * sizeof(float));
-    memcpy(features + 80, delta2_mfccs, 40 * sizeof(float));
+template <typename Spec>
+int CascadeStage<Spec>::predict_samples(const int16_t* samples, size_t count, stage_timing_t* timing,
+                                        float* features_out, float* scores, int* score_count) {
+    char model_path[DATA_PATH_MAX];
+    vector_input_t in = {NULL, NULL, samples, count, features_out, count};
+    return run_model(data_path(model_path, sizeof(model_path), Spec::model), resolver_, fill, &in, timing, scores,
+                     score_count);
+}
 
-cleanup:
-    heap_caps_free(mfcc);
-    heap_caps_free(delta_mfccs);
-    heap_caps_free(delta2_mfccs);
-    return ret;
+template <typename Spec>
+int CascadeStage<Spec>::predict(FILE* audio_file, const float* features, stage_timing_t* timing, float* features_out,
+                                float* scores, int* score_count, size_t max_samples) {
+    char model_path[DATA_PATH_MAX];
+    return predict_with(data_path(model_path, sizeof(model_path), Spec::model), audio_file, features, timing,
+                        features_out, scores, score_count, max_samples);
+}
+
+// 스펙트로그램 모델 입력: samples 가 없으면 audio_file 에서 읽는다
+typedef struct {
+    FILE* audio_file;
+    const int16_t* samples;
+    size_t count;
+} spectrogram_input_t;
+
+static esp_err_t fill_spectrogram(TfLiteTensor* input, void* ctx) {
+    const spectrogram_input_t* in = (const spectrogram_input_t*)ctx;
+    // [1, frames, bins] 또는 [1, frames, bins, 1]
+    const TfLiteIntArray* dims = input->dims;
+    size_t element_size = input->type == kTfLiteInt8 ? 1 : sizeof(float);
+    if ((input->type != kTfLiteFloat32 && input->type != kTfLiteInt8) || dims->size < 3 ||
+        (dims->size == 4 && dims->data[3] != 1) ||
+        input->bytes < (size_t)dims->data[1] * dims->data[2] * element_size) {
+        ESP_LOGE(TAG, "Unexpected spectrogram input (type %d, %d dims)", input->type, dims->size);
+        return ESP_FAIL;
+    }
+
+    ArenaBuffer<int16_t> audio_data(psram_arena(), in->samples ? 0 : MAX_AUDIO_SIZE);
+    const int16_t* samples = in->samples;
+    size_t count = in->count;
+    if (!samples) {
+        if (!audio_data) {
+            ESP_LOGE(TAG, "Failed to allocate memory for audio data");
+            return ESP_ERR_NO_MEM;
+        }
+        if (read_wav_clip(in->audio_file, audio_data.get(), MAX_AUDIO_SIZE, &count) != ESP_OK) {
+            ESP_LOGE(TAG, "Audio processing failed");
+            return ESP_FAIL;
+        }
+        samples = audio_data.get();
+    }
+
+    // hop 은 실제 길이가 아니라 RECORD_TIME 클립 기준 (짧은 파일은 뒤쪽이 패딩된다)
+    spectrogram_config_t config = default_spectrogram_config(dims->data[1], dims->data[2], MAX_AUDIO_SIZE);
+    config.pad = SPECTROGRAM_PAD;
+    load_spectrogram_scaler();
+    if (spectrogram_scaled) {
+        config.mean = spectrogram_mean;
+        config.std = spectrogram_std;
+    }
+
+    tensor_sink_t sink = {NULL, NULL, 0.0f, 0};
+    if (input->type == kTfLiteInt8) {
+        sink.i8 = input->data.int8;
+        sink.scale = input->params.scale;
+        sink.zero_point = input->params.zero_point;
+    } else {
+        sink.f32 = input->data.f;
+    }
+    return extract_spectrogram(samples, count, &config, sink);
+}
+
+static int predict_spectrogram(FILE* audio_file, const int16_t* samples, size_t count, stage_timing_t* timing,
+                               float* scores, int* score_count) {
+    char model_path[DATA_PATH_MAX];
+    spectrogram_input_t in = {audio_file, samples, count};
+    return run_model(data_path(model_path, sizeof(model_path), SPECTROGRAM_MODEL_FILE_NAME), resolver_spectrogram,
+                     fill_spectrogram, &in, timing, scores, score_count);
+}
+
+void set_pipeline_mode(pipeline_mode_t mode) {
+    pipeline_mode = mode;
+}
+
+pipeline_mode_t get_pipeline_mode() {
+    return pipeline_mode;
+}
+
+// feature_num 으로 단계를 고르고 model_path 의 모델로 실행
+esp_err_t model_predict(FILE* audio_file, const char* model_path, int feature_num, stage_timing_t* timing) {
+    if (feature_num == Stage1::kFeatures) {
+        return Stage1::predict_with(model_path, audio_file, NULL, timing, NULL, NULL, NULL, MAX_AUDIO_SIZE);
+    }
+    if (feature_num == Stage2::kFeatures) {
+        return Stage2::predict_with(model_path, audio_file, NULL, timing, NULL, NULL, NULL, MAX_AUDIO_SIZE);
+    }
+    return ESP_ERR_INVALID_ARG;
 }
 
-esp_err_t process2(FILE* audio_file, float* features) {
-    float* mfcc = (float*)heap_caps_malloc(80 * sizeof(float), MALLOC_CAP_SPIRAM);
-    float* delta_mfccs = (float*)heap_caps_calloc(80, sizeof(float), MALLOC_CAP_SPIRAM);
-    float* delta2_mfccs = (float*)heap_caps_calloc(80, sizeof(float), MALLOC_CAP_SPIRAM);
+esp_err_t model_predict_features(const float* features, const char* model_path, int feature_num,
+                                 stage_timing_t* timing) {
+    if (feature_num == Stage1::kFeatures) {
+        return Stage1::predict_with(model_path, NULL, features, timing, NULL, NULL, NULL, MAX_AUDIO_SIZE);
+    }
+    if (feature_num == Stage2::kFeatures) {
+        return Stage2::predict_with(model_path, NULL, features, timing, NULL, NULL, NULL, MAX_AUDIO_SIZE);
+    }
+    return ESP_ERR_INVALID_ARG;
+}
 
-    if (!mfcc || !delta_mfccs || !delta2_mfccs) {
-        ESP_LOGE(TAG, "Failed to allocate memory for MFCC");
+esp_err_t clip_features(const int16_t* samples, size_t count, clip_features_t* out, mem_arena_t* scratch) {
+    int64_t start_time = esp_timer_get_time();
+    if (!scratch) {
+        scratch = internal_arena();
+    }
+#if TEMPORAL_DELTAS
+    // 한 번 훑은 요약에서 두 단계 모두 만든다 (프레임 DSP 는 1단계 시간에 포함)
+    ArenaBuffer<clip_logmel_t> clip(scratch, 1);
+    if (!clip) {
+        ESP_LOGE(TAG, "Failed to allocate clip summary");
         return ESP_ERR_NO_MEM;
     }
+    esp_err_t ret = scan_clip_logmel(samples, count, clip.get(), scratch);
+    if (ret == ESP_OK) {
+        ret = Stage1::Features::from_clip(clip.get(), out->stage1);
+    }
+#else
+    esp_err_t ret = Stage1::Features::from_samples(samples, count, out->stage1, scratch);
+#endif
+    if (ret != ESP_OK) {
+        return ret;
+    }
 
-    esp_err_t ret = feature_extractor(audio_file, mfcc, 80);
+    int64_t stage1_done = esp_timer_get_time();
+#if TEMPORAL_DELTAS
+    ret = Stage2::Features::from_clip(clip.get(), out->stage2);
+#else
+    ret = Stage2::Features::from_samples(samples, count, out->stage2, scratch);
+#endif
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Feature extraction failed");
-        goto cleanup;
+        return ret;
     }
 
-    differential_mfcc(mfcc, delta_mfccs, delta2_mfccs, 80);
+    out->feature_us[0] = stage1_done - start_time;
+    out->feature_us[1] = esp_timer_get_time() - stage1_done;
+    return ESP_OK;
+}
+
+esp_err_t rolling_clip_features(rolling_features_t* rolling, clip_features_t* out) {
+    int64_t start_time = esp_timer_get_time();
+    esp_err_t ret = Stage1::Features::from_rolling(rolling, out->stage1);
+    if (ret != ESP_OK) {
+        return ret;
+    }
 
-    memcpy(features, mfcc, 80 * sizeof(float));
-    memcpy(features + 80, delta_mfccs, 80 * sizeof(float));
-    memcpy(features + 160, delta2_mfccs, 80 * sizeof(float));
+    int64_t stage1_done = esp_timer_get_time();
+    ret = Stage2::Features::from_rolling(rolling, out->stage2);
+    if (ret != ESP_OK) {
+        return ret;
+    }
 
-    scaler(features, 240, "/sdcard/second_model_scaler.pkl");
+    out->feature_us[0] = stage1_done - start_time;
+    out->feature_us[1] = esp_timer_get_time() - stage1_done;
+    return ESP_OK;
+}
 
-cleanup:
-    heap_caps_free(mfcc);
-    heap_caps_free(delta_mfccs);
-    heap_caps_free(delta2_mfccs);
-    return ret;
+// 2단계 모델 출력 -> 응답 코드
+static const char* second_stage_answer(int pred) {
+    switch (pred) {
+        case 0:
+            ESP_LOGI(TAG, "model : Awake");
+            return "1";
+        case 1:
+            ESP_LOGI(TAG, "model : Diaper");
+            return "2";
+        case 2:
+            ESP_LOGI(TAG, "model : hug");
+            return "3";
+        case 3:
+            ESP_LOGI(TAG, "model : Hungry");
+            return "4";
+        case 4:
+            ESP_LOGI(TAG, "model : Sleepy");
+            return "5";
+        default:
+            ESP_LOGI(TAG, "model : Wrong prediction");
+            return "6";
+    }
 }
 
-const char* pipeline() {
-    FILE* audio_file = fopen("/sdcard/audio.wav", "rb");
-    if (!audio_file) {
-        ESP_LOGE(TAG, "Failed to open audio file");
-        return "-1";
+static void log_timing(const pipeline_timing_t* timing) {
+    for (int i = 0; i < timing->stages_run; i++) {
+        ESP_LOGI(TAG, "stage %d: load %lld us, features %lld us, invoke %lld us", i + 1,
+                 (long long)timing->stage[i].model_load_us, (long long)timing->stage[i].feature_us,
+                 (long long)timing->stage[i].invoke_us);
+    }
+    ESP_LOGI(TAG, "pipeline total %lld us", (long long)timing->total_us);
+}
+
+static result_listener_fn result_listener;
+
+void set_result_listener(result_listener_fn listener) {
+    result_listener = listener;
+}
+
+static void notify_result(const char* answer, uint32_t seq) {
+    if (result_listener) {
+        result_listener((int8_t)atoi(answer), seq, esp_timer_get_time());
+    }
+}
+
+static void observe_metrics(const pipeline_timing_t* timing, const char* answer) {
+    int code = atoi(answer);
+    metrics_add(METRIC_CLASSIFICATIONS);
+    if (code < 0 || code == 6) {
+        metrics_add(METRIC_FAILURES);
     }
+    for (int i = 0; i < timing->stages_run; i++) {
+        metrics_observe(METRIC_HIST_MODEL_LOAD, timing->stage[i].model_load_us);
+        metrics_observe(METRIC_HIST_FEATURES, timing->stage[i].feature_us);
+        metrics_observe(i == 0 ? METRIC_HIST_INVOKE1 : METRIC_HIST_INVOKE2, timing->stage[i].invoke_us);
+    }
+    metrics_observe(METRIC_HIST_PIPELINE, timing->total_us);
+}
+
+// 다음 요청의 예산 판단용 단계 비용, 짧은 오디오로 잰 특징 시간은 전체 클립 기준으로 환산
+//   max_samples == 0: 미리 계산된 특징이라 이 요청에서 특징 비용이 없다
+static void observe_stage(const stage_timing_t* timing, budget_step_t features, budget_step_t model,
+                          size_t max_samples) {
+    if (max_samples) {
+        budget_observe(features, timing->feature_us * MAX_AUDIO_SIZE / max_samples);
+    }
+    budget_observe(model, timing->model_load_us + timing->invoke_us);
+}
+
+// 예산이 모자라 2단계를 건너뛴 "통증 아님"
+static const char* stage1_only_answer() {
+    ESP_LOGW(TAG, "model : no pain (stage 2 skipped)");
+    return "7";
+}
 
-    int pred = model_predict(audio_file, "/sdcard/converted_first_model.tflite", 120);
+// 1단계(통증 여부) 후 필요하면 2단계, 특징은 audio_file 또는 precomputed 에서 얻는다
+// store: 이후 저장이 남아 있으면 BUDGET_STORE (예산 계획에 포함)
+static const char* run_cascade(FILE* audio_file, const clip_features_t* precomputed, pipeline_result_t* out,
+                               request_budget_t* budget, uint32_t store) {
+    int64_t start_time = esp_timer_get_time();
+    memset(out, 0, sizeof(*out));
+
+    uint32_t features = precomputed ? 0 : BUDGET_FEATURES1 | BUDGET_FEATURES2;
+    uint32_t degraded = budget_plan(budget, features | BUDGET_MODEL1 | BUDGET_MODEL2 | store);
+    size_t max_samples = degraded & DEGRADE_SHORT_AUDIO ? SHORT_AUDIO_SIZE : MAX_AUDIO_SIZE;
+
+    int pred = Stage1::predict(audio_file, precomputed ? precomputed->stage1 : NULL, &out->timing.stage[0],
+                               out->features, out->scores[0], &out->score_count[0], max_samples);
+    out->timing.stages_run = 1;
+    if (precomputed) {
+        out->timing.stage[0].feature_us = precomputed->feature_us[0];
+    }
+    if (pred != -1) {
+        observe_stage(&out->timing.stage[0], BUDGET_FEATURES1, BUDGET_MODEL1,
+                      precomputed ? 0 : max_samples);
+    }
     const char* answer;
 
     if (pred == -1) {
@@ -199,38 +647,323 @@ const char* pipeline() {
         answer = "6";
     } else if (!pred) {
         ESP_LOGI(TAG, "model : no pain");
-        fseek(audio_file, 0, SEEK_SET);
-        pred = model_predict(audio_file, "/sdcard/converted_second_model.tflite", 240);
-        switch (pred) {
-            case 0:
-                ESP_LOGI(TAG, "model : Awake");
-                answer = "1";
-                break;
-            case 1:
-                ESP_LOGI(TAG, "model : Diaper");
-                answer = "2";
-                break;
-            case 2:
-                ESP_LOGI(TAG, "model : hug");
-                answer = "3";
-                break;
-            case 3:
-                ESP_LOGI(TAG, "model : Hungry");
-                answer = "4";
-                break;
-            case 4:
-                ESP_LOGI(TAG, "model : Sleepy");
-                answer = "5";
-                break;
-            default:
-                ESP_LOGI(TAG, "model : Wrong prediction");
-                answer = "6";
+        out->feature_count = STAGE1_FEATURES;
+        degraded = budget_plan(budget, (features & BUDGET_FEATURES2) | BUDGET_MODEL2 | store);
+        if (degraded & DEGRADE_STAGE1_ONLY) {
+            answer = stage1_only_answer();
+        } else {
+            max_samples = degraded & DEGRADE_SHORT_AUDIO ? SHORT_AUDIO_SIZE : MAX_AUDIO_SIZE;
+            if (audio_file) {
+                fseek(audio_file, 0, SEEK_SET);
+            }
+            pred = Stage2::predict(audio_file, precomputed ? precomputed->stage2 : NULL, &out->timing.stage[1],
+                                   out->features + STAGE1_FEATURES, out->scores[1], &out->score_count[1],
+                                   max_samples);
+            out->timing.stages_run = 2;
+            if (precomputed) {
+                out->timing.stage[1].feature_us = precomputed->feature_us[1];
+            }
+            if (pred != -1) {
+                out->feature_count = STAGE1_FEATURES + STAGE2_FEATURES;
+                observe_stage(&out->timing.stage[1], BUDGET_FEATURES2, BUDGET_MODEL2,
+                              precomputed ? 0 : max_samples);
+            }
+            answer = second_stage_answer(pred);
         }
     } else {
         ESP_LOGI(TAG, "model : pain");
+        out->feature_count = STAGE1_FEATURES;
         answer = "0";
     }
 
+    out->timing.total_us = esp_timer_get_time() - start_time;
+    out->answer = answer;
+    return answer;
+}
+
+esp_err_t enable_speculation(const stage_executor_t* executor) {
+    spec_executor = NULL;
+    mem_arena_deinit(&spec_internal);
+    mem_arena_deinit(&spec_psram);
+    if (!executor) {
+        return ESP_OK;
+    }
+
+    esp_err_t ret = mem_arena_init(&spec_internal, "spec_internal", INTERNAL_ARENA_SIZE,
+                                   mem_place_caps(MEM_FRAME_SCRATCH, INTERNAL_ARENA_SIZE));
+    if (ret == ESP_OK) {
+        ret = mem_arena_init(&spec_psram, "spec_psram", SPECULATIVE_PSRAM_ARENA_SIZE,
+                             mem_place_caps(MEM_REQUEST_BULK, SPECULATIVE_PSRAM_ARENA_SIZE));
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to allocate speculation arenas");
+        mem_arena_deinit(&spec_internal);
+        return ret;
+    }
+    spec_executor = executor;
+    return ESP_OK;
+}
+
+// 실행기 쪽에서 도는 2단계: 특징 추출 -> (취소되지 않았으면) 모델 로드 / 실행, 전용 아레나만 사용
+static void speculative_stage2(void* arg) {
+    speculative_job_t* job = (speculative_job_t*)arg;
+    bind_request_arenas(&spec_internal, &spec_psram);
+    job->pred = -1;
+
+    // 1단계가 2단계를 필요 없다고 판단하면 특징 추출 도중이라도 멈춰 요청의 wait() 가 바로 끝나게 한다
+    int64_t start_time = esp_timer_get_time();
+    esp_err_t ret = Stage2::Features::from_samples(job->samples, job->count, job->features, &spec_internal,
+                                                   &job->cancel);
+    if (__atomic_load_n(&job->cancel, __ATOMIC_ACQUIRE)) {
+        job->pred = -2;
+    } else if (ret == ESP_OK) {
+        int64_t feature_us = esp_timer_get_time() - start_time;
+        job->pred = Stage2::predict(NULL, job->features, &job->timing, NULL, job->scores, &job->score_count);
+        job->timing.feature_us = feature_us;
+    }
+
+    reset_request_arenas();
+    bind_request_arenas(NULL, NULL);
+}
+
+// 클립을 한 번 읽어 두고 2단계를 실행기에 넘긴 뒤 1단계를 이 태스크에서 실행
+// 2단계 시간은 실행기 쪽에서 잰 값이라 1단계와 겹친다 (total_us 가 실제 임계 경로)
+static const char* run_speculative(FILE* audio_file, pipeline_result_t* out, request_budget_t* budget,
+                                   uint32_t store) {
+    int64_t start_time = esp_timer_get_time();
+    ArenaBuffer<int16_t> audio_data(psram_arena(), MAX_AUDIO_SIZE);
+    size_t count = 0;
+    if (!audio_data || read_wav_clip(audio_file, audio_data.get(), MAX_AUDIO_SIZE, &count) != ESP_OK) {
+        fseek(audio_file, 0, SEEK_SET);
+        return run_cascade(audio_file, NULL, out, budget, store);
+    }
+    uint32_t all = BUDGET_FEATURES1 | BUDGET_FEATURES2 | BUDGET_MODEL1 | BUDGET_MODEL2;
+    uint32_t degraded = budget_plan(budget, all | store);
+    if (degraded & DEGRADE_STAGE1_ONLY) {
+        // 2단계를 돌릴 시간이 없으면 추측할 것도 없다
+        fseek(audio_file, 0, SEEK_SET);
+        return run_cascade(audio_file, NULL, out, budget, store);
+    }
+    size_t max_samples = MAX_AUDIO_SIZE;
+    if (degraded & DEGRADE_SHORT_AUDIO) {
+        max_samples = SHORT_AUDIO_SIZE;
+        count = std::min(count, max_samples);
+    }
+
+    speculative_job_t* job = &spec_job;
+    job->samples = audio_data.get();
+    job->count = count;
+    job->cancel = false;
+    if (spec_executor->start(speculative_stage2, job) != ESP_OK) {
+        fseek(audio_file, 0, SEEK_SET);
+        return run_cascade(audio_file, NULL, out, budget, store);
+    }
+
+    memset(out, 0, sizeof(*out));
+    int pred = Stage1::predict_samples(audio_data.get(), count, &out->timing.stage[0], out->features,
+                                       out->scores[0], &out->score_count[0]);
+    if (pred != -1) {
+        observe_stage(&out->timing.stage[0], BUDGET_FEATURES1, BUDGET_MODEL1, max_samples);
+    }
+    out->timing.stages_run = 1;
+    // 2단계 특징은 1단계와 겹쳐 돌았으므로 남은 비용은 모델 쪽만 본다, -3: 예산 부족으로 2단계 생략
+    if (pred == 0 && budget_plan(budget, BUDGET_MODEL2 | store) & DEGRADE_STAGE1_ONLY) {
+        pred = -3;
+    }
+    if (pred != 0) {
+        __atomic_store_n(&job->cancel, true, __ATOMIC_RELEASE);
+    }
+    spec_executor->wait();
+
+    const char* answer;
+    if (pred == -1) {
+        ESP_LOGE(TAG, "Error in prediction");
+        answer = "6";
+    } else if (pred == -3) {
+        out->feature_count = STAGE1_FEATURES;
+        answer = stage1_only_answer();
+    } else if (pred) {
+        ESP_LOGI(TAG, "model : pain");
+        out->feature_count = STAGE1_FEATURES;
+        answer = "0";
+    } else {
+        ESP_LOGI(TAG, "model : no pain");
+        out->feature_count = STAGE1_FEATURES;
+        out->timing.stages_run = 2;
+        pred = job->pred;
+        if (pred == -1 && budget_plan(budget, BUDGET_FEATURES2 | BUDGET_MODEL2 | store) & DEGRADE_STAGE1_ONLY) {
+            pred = -3;
+        } else if (pred == -1) {
+            // 전용 아레나 부족 등으로 추측이 실패하면 이 태스크에서 다시 실행
+            ESP_LOGW(TAG, "speculative stage 2 failed, running it inline");
+            pred = Stage2::predict_samples(audio_data.get(), count, &job->timing, job->features, job->scores,
+                                           &job->score_count);
+        }
+        if (pred >= 0) {
+            observe_stage(&job->timing, BUDGET_FEATURES2, BUDGET_MODEL2, max_samples);
+            out->timing.stage[1] = job->timing;
+            memcpy(out->features + STAGE1_FEATURES, job->features, sizeof(job->features));
+            memcpy(out->scores[1], job->scores, sizeof(job->scores));
+            out->score_count[1] = job->score_count;
+            out->feature_count = STAGE1_FEATURES + STAGE2_FEATURES;
+        }
+        if (pred == -3) {
+            out->timing.stages_run = 1;
+            answer = stage1_only_answer();
+        } else {
+            answer = second_stage_answer(pred);
+        }
+    }
+
+    fseek(audio_file, 0, SEEK_SET);
+    out->timing.total_us = esp_timer_get_time() - start_time;
+    out->answer = answer;
+    return answer;
+}
+
+// 6클래스 단일 모델: 0 은 통증, 1..5 는 2단계 모델과 같은 순서
+static const char* run_spectrogram(FILE* audio_file, const int16_t* samples, size_t count, pipeline_result_t* out) {
+    int64_t start_time = esp_timer_get_time();
+    memset(out, 0, sizeof(*out));
+
+    int pred = predict_spectrogram(audio_file, samples, count, &out->timing.stage[0], out->scores[0],
+                                   &out->score_count[0]);
+    out->timing.stages_run = 1;
+    const char* answer;
+    if (pred == -1) {
+        ESP_LOGE(TAG, "Error in prediction");
+        answer = "6";
+    } else if (pred == 0) {
+        ESP_LOGI(TAG, "model : pain");
+        answer = "0";
+    } else {
+        answer = second_stage_answer(pred - 1);
+    }
+
+    out->timing.total_us = esp_timer_get_time() - start_time;
+    out->answer = answer;
+    return answer;
+}
+
+// 스펙트로그램 모드는 오디오가 필요하므로 PCM 이 없는 미리 계산된 특징(연속 모드)은 캐스케이드로 처리
+// speculate: 실행기가 등록되어 있으면 2단계를 추측 실행 (파일 경로만, 호출은 한 번에 하나)
+// 예산은 캐스케이드 단계에만 적용 (스펙트로그램은 모델 하나라 저장 생략만)
+static const char* run_stages(FILE* audio_file, const clip_features_t* precomputed, const int16_t* samples,
+                              size_t count, pipeline_result_t* out, request_budget_t* budget, uint32_t store,
+                              bool speculate = false) {
+    if (pipeline_mode == PIPELINE_SPECTROGRAM && (audio_file || samples)) {
+        return run_spectrogram(audio_file, samples, count, out);
+    }
+    if (speculate && spec_executor && audio_file) {
+        return run_speculative(audio_file, out, budget, store);
+    }
+    return run_cascade(audio_file, precomputed, out, budget, store);
+}
+
+esp_err_t classify_file(FILE* audio_file, pipeline_result_t* out) {
+    // 일괄 분류는 정확한 결과가 목적이라 예산 없이
+    request_budget_t budget;
+    budget_start(&budget, 0);
+    run_stages(audio_file, NULL, NULL, 0, out, &budget, 0);
+    return out->score_count[0] > 0 ? ESP_OK : ESP_FAIL;
+}
+
+const char* pipeline() {
+    char audio_path[DATA_PATH_MAX];
+    return pipeline_file(data_path(audio_path, sizeof(audio_path), AUDIO_FILE_NAME));
+}
+
+// 저장이 남아 있고 예산이 허락하면 true
+static bool store_allowed(request_budget_t* budget, uint32_t store) {
+    return store && !(budget_plan(budget, store) & DEGRADE_SKIP_STORE);
+}
+
+// 요청 마무리: 예산 결과를 기록하고 마감 초과를 센다
+static void finish_budget(const request_budget_t* budget) {
+    last_result.degraded = budget->degraded;
+    budget_finish(budget);
+}
+
+const char* pipeline_file(const char* audio_path) {
+    int64_t start_time = esp_timer_get_time();
+    request_budget_t budget;
+    budget_start(&budget, request_budget_ms);
+
+    // WAV 전체를 한 번에 읽어 두고 특징 추출 / 저장은 메모리에서
+    FILE* audio_file = sd_open_buffered(audio_path, psram_arena());
+    if (!audio_file) {
+        ESP_LOGE(TAG, "Failed to open audio file");
+        reset_request_arenas();
+        memset(&last_result, 0, sizeof(last_result));
+        metrics_add(METRIC_FAILURES);
+        return "-1";
+    }
+
+    uint32_t store = record_store_is_open() ? BUDGET_STORE : 0;
+    const char* answer = run_stages(audio_file, NULL, NULL, 0, &last_result, &budget, store, true);
+
+    uint32_t seq = 0xffffffff;
+    if (store_allowed(&budget, store)) {
+        int64_t store_start = esp_timer_get_time();
+        if (record_store_append(audio_file, last_result.features, last_result.feature_count, (int8_t)atoi(answer),
+                                start_time, &seq) == ESP_OK) {
+            ESP_LOGI(TAG, "stored as record %u", (unsigned)seq);
+            budget_observe(BUDGET_STORE, esp_timer_get_time() - store_start);
+        }
+    }
+
     fclose(audio_file);
+    reset_request_arenas();
+
+    last_result.timing.total_us = esp_timer_get_time() - start_time;
+    finish_budget(&budget);
+    log_timing(&last_result.timing);
+    observe_metrics(&last_result.timing, answer);
+    notify_result(answer, seq);
     return answer;
+}
+
+const char* pipeline_clip(const clip_features_t* features, const int16_t* samples, size_t count,
+                          uint32_t* seq_out) {
+    int64_t start_time = esp_timer_get_time();
+    request_budget_t budget;
+    budget_start(&budget, request_budget_ms);
+
+    uint32_t store = samples && record_store_is_open() ? BUDGET_STORE : 0;
+    const char* answer = run_stages(NULL, features, samples, count, &last_result, &budget, store);
+
+    uint32_t seq = 0xffffffff;
+    if (store_allowed(&budget, store)) {
+        int64_t store_start = esp_timer_get_time();
+        if (record_store_append_pcm(samples, count, SAMPLE_RATE, last_result.features, last_result.feature_count,
+                                    (int8_t)atoi(answer), start_time, &seq) == ESP_OK) {
+            ESP_LOGI(TAG, "stored as record %u", (unsigned)seq);
+            budget_observe(BUDGET_STORE, esp_timer_get_time() - store_start);
+        }
+    }
+    if (seq_out) {
+        *seq_out = seq;
+    }
+
+    reset_request_arenas();
+
+    // 특징 추출은 다른 태스크에서 이미 끝났으므로 여기서는 모델 단계만 포함
+    last_result.timing.total_us = esp_timer_get_time() - start_time;
+    finish_budget(&budget);
+    log_timing(&last_result.timing);
+    observe_metrics(&last_result.timing, answer);
+    notify_result(answer, seq);
+    return answer;
+}
+
+const pipeline_timing_t* pipeline_last_timing() {
+    return &last_result.timing;
+}
+
+const pipeline_result_t* pipeline_last_result() {
+    return &last_result;
+}
+
+void set_request_budget(uint32_t budget_ms) {
+    request_budget_ms = budget_ms;
 }
\ No newline at end of file
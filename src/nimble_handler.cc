@@ -4,23 +4,33 @@
 #include "gap.h"
 #include "gatt_svc.h"
 
+#include "freertos/event_groups.h"
+
 #include <string.h>
 
+#define BLE_SYNCED_BIT BIT0
+
 static const char *TAG = "BLE";
+static EventGroupHandle_t ble_events;
 
 static void on_stack_reset(int reason) {
     ESP_LOGI(TAG, "nimble stack reset, reset reason: %d", reason);
 }
 
+// 호스트와 컨트롤러가 동기화되면 호출: 고정 대기 없이 바로 광고 시작
 static void on_stack_sync(void) {
-    vTaskDelay(pdMS_TO_TICKS(100));
     int rc = ble_gatts_start();
     if (rc != 0) {
         ESP_LOGE(TAG, "GATT 서비스 시작 실패: %d", rc);
         return;
     }
-    vTaskDelay(pdMS_TO_TICKS(100));
     adv_init();
+    xEventGroupSetBits(ble_events, BLE_SYNCED_BIT);
+}
+
+static void nimble_host_task(void *param) {
+    nimble_port_run();
+    nimble_port_freertos_deinit();
 }
 
 static void nimble_host_config_init(void) {
@@ -33,7 +43,13 @@ bool init_nimble() {
     esp_err_t ret;
     int rc;
 
-    vTaskDelay(pdMS_TO_TICKS(100));
+    if (!ble_events) {
+        ble_events = xEventGroupCreate();
+        if (!ble_events) {
+            return false;
+        }
+    }
+
     /* NimBLE stack initialization */
     ret = nimble_port_init();
     if (ret != ESP_OK) {
@@ -42,7 +58,6 @@ bool init_nimble() {
         return false;
     }
 
-    vTaskDelay(pdMS_TO_TICKS(100));
     /* GAP service initialization */
     rc = gap_init();
     if (rc != 0) {
@@ -50,7 +65,6 @@ bool init_nimble() {
         return false;
     }
 
-    vTaskDelay(pdMS_TO_TICKS(100));
     /* GATT server initialization */
     rc = gatt_svc_init();
     if (rc != 0) {
@@ -58,8 +72,14 @@ bool init_nimble() {
         return false;
     }
 
-    vTaskDelay(pdMS_TO_TICKS(100));
     nimble_host_config_init();
-    
+
+    /* 호스트 태스크 시작, 준비 완료는 nimble_wait_ready() 로 확인 */
+    nimble_port_freertos_init(nimble_host_task);
     return true;
 }
+
+bool nimble_wait_ready(uint32_t timeout_ms) {
+    EventBits_t bits = xEventGroupWaitBits(ble_events, BLE_SYNCED_BIT, pdFALSE, pdTRUE, pdMS_TO_TICKS(timeout_ms));
+    return bits & BLE_SYNCED_BIT;
+}
@@ -0,0 +1,129 @@
+#include "power_mgmt.h"
+#include "sdkconfig.h"
+
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#include <stdio.h>
+
+static const char* TAG = "POWER";
+
+#if POWER_MGMT_ENABLED && CONFIG_PM_ENABLE && CONFIG_BT_ENABLED && !CONFIG_BT_CTRL_MODEM_SLEEP
+// modem sleep 없이는 BLE 컨트롤러가 잠금을 계속 잡아 주파수만 내려가고 light sleep 은 하지 않는다
+#warning "light sleep with BLE needs CONFIG_BT_CTRL_MODEM_SLEEP"
+#endif
+
+static esp_pm_lock_handle_t max_freq_lock;
+static esp_pm_lock_handle_t awake_lock;
+static esp_timer_handle_t awake_timer;
+static bool awake_held;
+static portMUX_TYPE power_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 최대 클럭 구간 누적 (잠금이 없어도 같은 값, PM 이 꺼져 있으면 기본 클럭 구간)
+static int busy_depth;
+static int64_t busy_since;
+static int64_t busy_total;
+
+static void awake_expired(void* arg) {
+    taskENTER_CRITICAL(&power_lock);
+    bool release = awake_held;
+    awake_held = false;
+    taskEXIT_CRITICAL(&power_lock);
+    if (release && awake_lock) {
+        esp_pm_lock_release(awake_lock);
+    }
+}
+
+esp_err_t init_power_mgmt() {
+#if POWER_MGMT_ENABLED && CONFIG_PM_ENABLE
+    esp_pm_config_t config = {
+        .max_freq_mhz = PM_MAX_FREQ_MHZ,
+        .min_freq_mhz = PM_MIN_FREQ_MHZ,
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+        .light_sleep_enable = PM_LIGHT_SLEEP,
+#else
+        .light_sleep_enable = false,
+#endif
+    };
+    esp_err_t ret = esp_pm_configure(&config);
+    if (ret == ESP_OK) {
+        ret = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "pipeline", &max_freq_lock);
+    }
+    if (ret == ESP_OK) {
+        ret = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "uart_awake", &awake_lock);
+    }
+    if (ret == ESP_OK) {
+        esp_timer_create_args_t timer_args = {};
+        timer_args.callback = awake_expired;
+        timer_args.name = "pm_awake";
+        ret = esp_timer_create(&timer_args, &awake_timer);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure power management: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGI(TAG, "%d..%d MHz, light sleep %s", PM_MIN_FREQ_MHZ, PM_MAX_FREQ_MHZ,
+             config.light_sleep_enable ? "on" : "off");
+#else
+    ESP_LOGI(TAG, "power management disabled");
+#endif
+    return ESP_OK;
+}
+
+void power_busy_begin() {
+    taskENTER_CRITICAL(&power_lock);
+    if (busy_depth++ == 0) {
+        busy_since = esp_timer_get_time();
+    }
+    taskEXIT_CRITICAL(&power_lock);
+    if (max_freq_lock) {
+        esp_pm_lock_acquire(max_freq_lock);
+    }
+}
+
+void power_busy_end() {
+    if (max_freq_lock) {
+        esp_pm_lock_release(max_freq_lock);
+    }
+    taskENTER_CRITICAL(&power_lock);
+    if (busy_depth > 0 && --busy_depth == 0) {
+        busy_total += esp_timer_get_time() - busy_since;
+    }
+    taskEXIT_CRITICAL(&power_lock);
+}
+
+void power_stay_awake(uint32_t ms) {
+    if (!awake_lock) {
+        return;
+    }
+    esp_timer_stop(awake_timer);
+    taskENTER_CRITICAL(&power_lock);
+    bool acquire = !awake_held;
+    awake_held = true;
+    taskEXIT_CRITICAL(&power_lock);
+    if (acquire) {
+        esp_pm_lock_acquire(awake_lock);
+    }
+    esp_timer_start_once(awake_timer, (uint64_t)ms * 1000);
+}
+
+void power_times(uint32_t* max_freq_ms, uint32_t* low_ms) {
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&power_lock);
+    int64_t busy = busy_total + (busy_depth > 0 ? now - busy_since : 0);
+    taskEXIT_CRITICAL(&power_lock);
+    *max_freq_ms = (uint32_t)(busy / 1000);
+    *low_ms = (uint32_t)((now - busy) / 1000);
+}
+
+void power_report() {
+    uint32_t max_freq_ms, low_ms;
+    power_times(&max_freq_ms, &low_ms);
+    ESP_LOGI(TAG, "%d MHz: %u ms, below (min clock / light sleep): %u ms", PM_MAX_FREQ_MHZ, (unsigned)max_freq_ms,
+             (unsigned)low_ms);
+#if CONFIG_PM_PROFILING
+    esp_pm_dump_locks(stdout);
+#endif
+}
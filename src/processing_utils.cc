@@ -6,6 +6,7 @@ void create_mel_filterbank(float* fbank, int n_filters, int n_fft, float sample_
     float fmin_mel = hz_to_mel(0);
     float fmax_mel = hz_to_mel(sample_rate / 2);
     float mel_step = (fmax_mel - fmin_mel) / (n_filters + 1);
+    int n_bins = n_fft / 2 + 1;
 
     for (int i = 0; i < n_filters; i++) {
         float left_mel = fmin_mel + i * mel_step;
@@ -18,9 +19,9 @@ void create_mel_filterbank(float* fbank, int n_filters, int n_fft, float sample_
 
         for (int j = left_bin; j < right_bin; j++) {
             if (j < center_bin) {
-                fbank[i * n_fft + j] = (j - left_bin) / (float)(center_bin - left_bin);
+                fbank[i * n_bins + j] = (j - left_bin) / (float)(center_bin - left_bin);
             } else {
-                fbank[i * n_fft + j] = (right_bin - j) / (float)(right_bin - center_bin);
+                fbank[i * n_bins + j] = (right_bin - j) / (float)(right_bin - center_bin);
             }
         }
     }
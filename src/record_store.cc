@@ -0,0 +1,407 @@
+#include "record_store.h"
+#include "mem_arena.h"
+#include "wav_io.h"
+#include "esp_log.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <mutex>
+
+#define STORE_MAGIC 0x31535748      // "HWS1"
+#define RECORD_MAGIC 0x31525748     // "HWR1"
+#define STORE_VERSION 1
+#define STORE_INDEX_HEADER_SIZE 512
+#define STORE_COPY_CHUNK 4096
+
+static const char* TAG = "RECORD_STORE";
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t segment_count;
+    uint32_t segment_size;
+    uint32_t capacity;
+    uint32_t next_seq;
+    uint32_t oldest_seq;
+    uint32_t write_segment;
+    uint32_t write_offset;
+    uint32_t seg_first_seq[STORE_SEGMENT_COUNT];
+} store_header_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    int64_t timestamp_us;
+    uint32_t wav_size;
+    uint16_t feature_count;
+    int8_t result;
+    uint8_t reserved;
+} record_header_t;
+
+static_assert(sizeof(store_header_t) <= STORE_INDEX_HEADER_SIZE, "store header too large");
+static_assert(sizeof(store_entry_t) == 32, "store entry must stay 32 bytes");
+
+static char store_dir[128];
+static FILE* index_file = NULL;
+static store_header_t header;
+// index_file 의 seek + 읽기/쓰기와 header 는 저장(파이프라인)과 조회(bulk, STREAM_RESULTS) 태스크가 공유
+// 세그먼트 데이터는 잠금 밖에서 읽으므로 읽은 뒤 record_store_contains() 로 재사용 여부를 확인한다
+static std::mutex store_mutex;
+
+static const char* segment_path(char* buf, size_t len, uint32_t segment) {
+    snprintf(buf, len, "%s/seg%03u.dat", store_dir, (unsigned)segment);
+    return buf;
+}
+
+static esp_err_t write_header() {
+    fseek(index_file, 0, SEEK_SET);
+    if (fwrite(&header, sizeof(header), 1, index_file) != 1) {
+        return ESP_FAIL;
+    }
+    return fflush(index_file) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+// 파일 끝을 먼저 기록해 클러스터를 한 번에 확보
+static esp_err_t preallocate(const char* path, long size) {
+    FILE* f = fopen(path, "r+b");
+    if (f) {
+        fseek(f, 0, SEEK_END);
+        if (ftell(f) >= size) {
+            fclose(f);
+            return ESP_OK;
+        }
+    } else {
+        f = fopen(path, "wb");
+        if (!f) {
+            ESP_LOGE(TAG, "Failed to create %s", path);
+            return ESP_FAIL;
+        }
+    }
+
+    uint8_t zero = 0;
+    fseek(f, size - 1, SEEK_SET);
+    size_t written = fwrite(&zero, 1, 1, f);
+    fclose(f);
+    return written == 1 ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t record_store_open(const char* dir) {
+    char path[160];
+
+    std::lock_guard<std::mutex> lock(store_mutex);
+    if (index_file) {
+        return ESP_OK;
+    }
+
+    snprintf(store_dir, sizeof(store_dir), "%s", dir);
+    if (mkdir(store_dir, 0775) != 0 && errno != EEXIST) {
+        ESP_LOGE(TAG, "Failed to create %s", store_dir);
+        return ESP_FAIL;
+    }
+
+    snprintf(path, sizeof(path), "%s/index.bin", store_dir);
+    index_file = fopen(path, "r+b");
+    if (index_file && fread(&header, sizeof(header), 1, index_file) == 1 && header.magic == STORE_MAGIC &&
+        header.version == STORE_VERSION && header.segment_count == STORE_SEGMENT_COUNT &&
+        header.segment_size == STORE_SEGMENT_SIZE && header.capacity == STORE_INDEX_CAPACITY) {
+        ESP_LOGI(TAG, "store opened: seq %u..%u, segment %u @ %u", (unsigned)header.oldest_seq,
+                 (unsigned)header.next_seq, (unsigned)header.write_segment, (unsigned)header.write_offset);
+        return ESP_OK;
+    }
+
+    // 새로 만들거나 형식이 다르면 초기화
+    if (index_file) {
+        fclose(index_file);
+        ESP_LOGW(TAG, "store index incompatible, recreating");
+    }
+    if (preallocate(path, STORE_INDEX_HEADER_SIZE + STORE_INDEX_CAPACITY * sizeof(store_entry_t)) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    for (uint32_t i = 0; i < STORE_SEGMENT_COUNT; i++) {
+        char seg[160];
+        if (preallocate(segment_path(seg, sizeof(seg), i), STORE_SEGMENT_SIZE) != ESP_OK) {
+            return ESP_FAIL;
+        }
+    }
+
+    index_file = fopen(path, "r+b");
+    if (!index_file) {
+        return ESP_FAIL;
+    }
+    memset(&header, 0, sizeof(header));
+    header.magic = STORE_MAGIC;
+    header.version = STORE_VERSION;
+    header.segment_count = STORE_SEGMENT_COUNT;
+    header.segment_size = STORE_SEGMENT_SIZE;
+    header.capacity = STORE_INDEX_CAPACITY;
+
+    store_entry_t empty;
+    memset(&empty, 0xff, sizeof(empty));
+    fseek(index_file, STORE_INDEX_HEADER_SIZE, SEEK_SET);
+    for (int i = 0; i < STORE_INDEX_CAPACITY; i++) {
+        fwrite(&empty, sizeof(empty), 1, index_file);
+    }
+
+    ESP_LOGI(TAG, "store created: %d x %d bytes", STORE_SEGMENT_COUNT, STORE_SEGMENT_SIZE);
+    return write_header();
+}
+
+void record_store_close() {
+    std::lock_guard<std::mutex> lock(store_mutex);
+    if (index_file) {
+        fclose(index_file);
+        index_file = NULL;
+    }
+}
+
+bool record_store_is_open() {
+    std::lock_guard<std::mutex> lock(store_mutex);
+    return index_file != NULL;
+}
+
+// 다음 세그먼트로 넘어가며 그 안의 오래된 레코드를 폐기
+//   덮어쓰기 전에 oldest_seq 를 올리므로 그 세그먼트의 레코드는 이후 record_store_contains() 가 false
+static void advance_segment() {
+    header.write_segment = (header.write_segment + 1) % STORE_SEGMENT_COUNT;
+    header.write_offset = 0;
+    header.seg_first_seq[header.write_segment] = header.next_seq;
+
+    uint32_t next = (header.write_segment + 1) % STORE_SEGMENT_COUNT;
+    uint32_t oldest = header.seg_first_seq[next];
+    if (oldest > header.oldest_seq) {
+        header.oldest_seq = oldest;
+    }
+    if (header.oldest_seq > header.next_seq) {
+        header.oldest_seq = header.next_seq;
+    }
+}
+
+// WAV 파일 또는 메모리의 16-bit PCM 샘플
+typedef struct {
+    FILE* file;
+    const int16_t* samples;
+    uint32_t sample_count;
+    uint32_t sample_rate;
+} wav_source_t;
+
+static bool copy_wav(const wav_source_t* src, FILE* seg, long wav_size, uint8_t* chunk) {
+    if (!src->file) {
+        uint8_t header[WAV_PCM_HEADER_SIZE];
+        wav_pcm_header(header, src->sample_count * sizeof(int16_t), src->sample_rate);
+        return fwrite(header, 1, sizeof(header), seg) == sizeof(header) &&
+               fwrite(src->samples, sizeof(int16_t), src->sample_count, seg) == src->sample_count;
+    }
+
+    for (long copied = 0; copied < wav_size;) {
+        size_t n = fread(chunk, 1, STORE_COPY_CHUNK, src->file);
+        if (n == 0 || fwrite(chunk, 1, n, seg) != n) {
+            return false;
+        }
+        copied += n;
+    }
+    return true;
+}
+
+static esp_err_t append(const wav_source_t* src, const float* features, int feature_count, int8_t result,
+                        int64_t timestamp_us, uint32_t* seq_out) {
+    char path[160];
+    long wav_size;
+
+    // 레코드 하나를 쓰는 동안 잡고 있는다 (세그먼트 위치와 인덱스 엔트리가 같은 헤더 상태에서 나와야 한다)
+    std::lock_guard<std::mutex> lock(store_mutex);
+    if (!index_file) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (src->file) {
+        fseek(src->file, 0, SEEK_END);
+        wav_size = ftell(src->file);
+        fseek(src->file, 0, SEEK_SET);
+    } else {
+        wav_size = WAV_PCM_HEADER_SIZE + src->sample_count * sizeof(int16_t);
+    }
+
+    uint32_t length = sizeof(record_header_t) + wav_size + feature_count * sizeof(float);
+    length = (length + STORE_ALIGN - 1) & ~(STORE_ALIGN - 1);
+    if (wav_size < 0 || length > STORE_SEGMENT_SIZE) {
+        ESP_LOGE(TAG, "Record too large: %u bytes", (unsigned)length);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    if (header.write_offset + length > STORE_SEGMENT_SIZE) {
+        advance_segment();
+    }
+
+    ArenaBuffer<uint8_t> chunk(psram_arena(), src->file ? STORE_COPY_CHUNK : 0);
+    if (!chunk) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    FILE* seg = fopen(segment_path(path, sizeof(path), header.write_segment), "r+b");
+    if (!seg) {
+        ESP_LOGE(TAG, "Failed to open %s", path);
+        return ESP_FAIL;
+    }
+
+    record_header_t rec = {};
+    rec.magic = RECORD_MAGIC;
+    rec.seq = header.next_seq;
+    rec.timestamp_us = timestamp_us;
+    rec.wav_size = wav_size;
+    rec.feature_count = feature_count;
+    rec.result = result;
+
+    fseek(seg, header.write_offset, SEEK_SET);
+    bool ok = fwrite(&rec, sizeof(rec), 1, seg) == 1 && copy_wav(src, seg, wav_size, chunk.get());
+    if (ok && feature_count > 0) {
+        ok = fwrite(features, sizeof(float), feature_count, seg) == (size_t)feature_count;
+    }
+    fclose(seg);
+    if (!ok) {
+        ESP_LOGE(TAG, "Failed to write record %u", (unsigned)rec.seq);
+        return ESP_FAIL;
+    }
+
+    // 데이터 -> 엔트리 -> 헤더 순서로 기록해 중간에 끊겨도 인덱스가 깨지지 않게 한다
+    store_entry_t entry = {};
+    entry.seq = rec.seq;
+    entry.segment = header.write_segment;
+    entry.result = result;
+    entry.offset = header.write_offset;
+    entry.length = length;
+    entry.wav_size = wav_size;
+    entry.feature_count = feature_count;
+    entry.timestamp_us = timestamp_us;
+    fseek(index_file, STORE_INDEX_HEADER_SIZE + (rec.seq % STORE_INDEX_CAPACITY) * sizeof(entry), SEEK_SET);
+    if (fwrite(&entry, sizeof(entry), 1, index_file) != 1) {
+        return ESP_FAIL;
+    }
+
+    header.write_offset += length;
+    header.next_seq++;
+    if (header.next_seq - header.oldest_seq > STORE_INDEX_CAPACITY) {
+        header.oldest_seq = header.next_seq - STORE_INDEX_CAPACITY;
+    }
+    if (seq_out) {
+        *seq_out = rec.seq;
+    }
+    return write_header();
+}
+
+esp_err_t record_store_append(FILE* wav_file, const float* features, int feature_count, int8_t result,
+                              int64_t timestamp_us, uint32_t* seq_out) {
+    wav_source_t src = {wav_file, NULL, 0, 0};
+    return append(&src, features, feature_count, result, timestamp_us, seq_out);
+}
+
+esp_err_t record_store_append_pcm(const int16_t* samples, uint32_t sample_count, uint32_t sample_rate,
+                                  const float* features, int feature_count, int8_t result, int64_t timestamp_us,
+                                  uint32_t* seq_out) {
+    wav_source_t src = {NULL, samples, sample_count, sample_rate};
+    return append(&src, features, feature_count, result, timestamp_us, seq_out);
+}
+
+// store_mutex 안에서 호출
+static esp_err_t lookup_locked(uint32_t seq, store_entry_t* entry) {
+    if (!index_file) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (seq < header.oldest_seq || seq >= header.next_seq) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    fseek(index_file, STORE_INDEX_HEADER_SIZE + (seq % STORE_INDEX_CAPACITY) * sizeof(*entry), SEEK_SET);
+    if (fread(entry, sizeof(*entry), 1, index_file) != 1 || entry->seq != seq) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t record_store_lookup(uint32_t seq, store_entry_t* entry) {
+    std::lock_guard<std::mutex> lock(store_mutex);
+    return lookup_locked(seq, entry);
+}
+
+bool record_store_contains(uint32_t seq) {
+    std::lock_guard<std::mutex> lock(store_mutex);
+    return index_file && seq >= header.oldest_seq && seq < header.next_seq;
+}
+
+static FILE* open_record(uint32_t seq, store_entry_t* entry) {
+    char path[160];
+    std::lock_guard<std::mutex> lock(store_mutex);
+    if (lookup_locked(seq, entry) != ESP_OK) {
+        return NULL;
+    }
+
+    FILE* seg = fopen(segment_path(path, sizeof(path), entry->segment), "rb");
+    if (!seg) {
+        return NULL;
+    }
+    record_header_t rec;
+    fseek(seg, entry->offset, SEEK_SET);
+    if (fread(&rec, sizeof(rec), 1, seg) != 1 || rec.magic != RECORD_MAGIC || rec.seq != seq) {
+        fclose(seg);
+        return NULL;
+    }
+    return seg;
+}
+
+esp_err_t record_store_read_wav(uint32_t seq, FILE* out) {
+    store_entry_t entry;
+    FILE* seg = open_record(seq, &entry);
+    if (!seg) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    ArenaBuffer<uint8_t> chunk(psram_arena(), STORE_COPY_CHUNK);
+    esp_err_t ret = chunk ? ESP_OK : ESP_ERR_NO_MEM;
+    for (uint32_t left = entry.wav_size; ret == ESP_OK && left > 0;) {
+        size_t n = fread(chunk.get(), 1, left < STORE_COPY_CHUNK ? left : STORE_COPY_CHUNK, seg);
+        if (n == 0 || fwrite(chunk.get(), 1, n, out) != n) {
+            ret = ESP_FAIL;
+        }
+        left -= n;
+    }
+    fclose(seg);
+    // 복사하는 동안 세그먼트가 재사용되었으면 out 의 내용은 다른 레코드와 섞였을 수 있다
+    if (ret == ESP_OK && !record_store_contains(seq)) {
+        ret = ESP_ERR_NOT_FOUND;
+    }
+    return ret;
+}
+
+FILE* record_store_open_wav(uint32_t seq, long* offset, uint32_t* size) {
+    store_entry_t entry;
+    FILE* seg = open_record(seq, &entry);
+    if (seg) {
+        *offset = ftell(seg);
+        *size = entry.wav_size;
+    }
+    return seg;
+}
+
+int record_store_read_features(uint32_t seq, float* features, int max_count) {
+    store_entry_t entry;
+    FILE* seg = open_record(seq, &entry);
+    if (!seg) {
+        return -1;
+    }
+
+    int count = entry.feature_count < max_count ? entry.feature_count : max_count;
+    fseek(seg, entry.offset + sizeof(record_header_t) + entry.wav_size, SEEK_SET);
+    count = fread(features, sizeof(float), count, seg);
+    fclose(seg);
+    return record_store_contains(seq) ? count : -1;
+}
+
+uint32_t record_store_oldest_seq() {
+    std::lock_guard<std::mutex> lock(store_mutex);
+    return header.oldest_seq;
+}
+
+uint32_t record_store_next_seq() {
+    std::lock_guard<std::mutex> lock(store_mutex);
+    return header.next_seq;
+}
@@ -0,0 +1,110 @@
+#include "request_budget.h"
+#include "audio_config.h"
+#include "metrics.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char* TAG = "BUDGET";
+
+#define BUDGET_STEPS 5
+
+static uint32_t estimates[BUDGET_STEPS] = {
+    BUDGET_DEFAULT_FEATURES_US,
+    BUDGET_DEFAULT_MODEL_US,
+    BUDGET_DEFAULT_FEATURES_US,
+    BUDGET_DEFAULT_MODEL_US,
+    BUDGET_DEFAULT_STORE_US,
+};
+
+static int step_index(budget_step_t step) {
+    return __builtin_ctz((unsigned)step);
+}
+
+void budget_start(request_budget_t* budget, uint32_t budget_ms) {
+    budget->deadline_us = budget_ms ? esp_timer_get_time() + (int64_t)budget_ms * 1000 : 0;
+    budget->degraded = 0;
+}
+
+int64_t budget_remaining_us(const request_budget_t* budget) {
+    if (!budget->deadline_us) {
+        return INT64_MAX;
+    }
+    return budget->deadline_us - esp_timer_get_time();
+}
+
+int64_t budget_estimate(const request_budget_t* budget, uint32_t steps) {
+    int64_t total = 0;
+    for (int i = 0; i < BUDGET_STEPS; i++) {
+        if (!(steps & (1u << i))) {
+            continue;
+        }
+        int64_t cost = __atomic_load_n(&estimates[i], __ATOMIC_RELAXED);
+        if ((1u << i) & (BUDGET_FEATURES1 | BUDGET_FEATURES2) && budget->degraded & DEGRADE_SHORT_AUDIO) {
+            cost = cost * BUDGET_SHORT_AUDIO_MS / RECORD_TIME;
+        }
+        total += cost;
+    }
+    return total;
+}
+
+void budget_observe(budget_step_t step, int64_t us) {
+    uint32_t* estimate = &estimates[step_index(step)];
+    uint32_t value = us < 0 ? 0 : us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+    uint32_t seen = __atomic_load_n(estimate, __ATOMIC_RELAXED);
+    // 늦어지는 쪽은 바로 반영해야 다음 요청이 마감을 지킨다
+    uint32_t next = value > seen ? value : seen - (seen - value) / 8;
+    __atomic_store_n(estimate, next, __ATOMIC_RELAXED);
+}
+
+static bool over_budget(const request_budget_t* budget, uint32_t steps) {
+    return budget_estimate(budget, steps) > budget_remaining_us(budget);
+}
+
+// 건너뛴 단계는 관측되지 않으므로 추정을 조금씩 낮춰 언젠가 다시 실행해 보게 한다 (실행되면 바로 올라감)
+static void decay(uint32_t steps) {
+    for (int i = 0; i < BUDGET_STEPS; i++) {
+        if (steps & (1u << i)) {
+            uint32_t seen = __atomic_load_n(&estimates[i], __ATOMIC_RELAXED);
+            __atomic_store_n(&estimates[i], seen - seen / 8, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void degrade(request_budget_t* budget, degrade_t level, metric_counter_t counter, const char* what) {
+    budget->degraded |= level;
+    metrics_add(counter);
+    ESP_LOGW(TAG, "%lld us left, %s", (long long)budget_remaining_us(budget), what);
+}
+
+uint32_t budget_plan(request_budget_t* budget, uint32_t steps) {
+    if (!budget->deadline_us) {
+        return budget->degraded;
+    }
+    if (budget->degraded & DEGRADE_SKIP_STORE) {
+        steps &= ~BUDGET_STORE;
+    }
+    if (budget->degraded & DEGRADE_STAGE1_ONLY) {
+        steps &= ~(BUDGET_FEATURES2 | BUDGET_MODEL2);
+    }
+
+    if (steps & BUDGET_STORE && over_budget(budget, steps)) {
+        degrade(budget, DEGRADE_SKIP_STORE, METRIC_DEGRADE_SKIP_STORE, "skipping store");
+        decay(BUDGET_STORE);
+        steps &= ~BUDGET_STORE;
+    }
+    if (steps & (BUDGET_FEATURES1 | BUDGET_FEATURES2) && !(budget->degraded & DEGRADE_SHORT_AUDIO) &&
+        over_budget(budget, steps)) {
+        degrade(budget, DEGRADE_SHORT_AUDIO, METRIC_DEGRADE_SHORT_AUDIO, "using short audio");
+    }
+    if (steps & (BUDGET_FEATURES2 | BUDGET_MODEL2) && over_budget(budget, steps)) {
+        degrade(budget, DEGRADE_STAGE1_ONLY, METRIC_DEGRADE_STAGE1_ONLY, "answering from stage 1");
+        decay(steps & (BUDGET_FEATURES2 | BUDGET_MODEL2));
+    }
+    return budget->degraded;
+}
+
+void budget_finish(const request_budget_t* budget) {
+    if (budget->deadline_us && esp_timer_get_time() > budget->deadline_us) {
+        metrics_add(METRIC_DEADLINE_MISSED);
+    }
+}
@@ -0,0 +1,255 @@
+#include "request_scheduler.h"
+#include "audio_config.h"
+#include "audio_processing.h"
+#include "mem_arena.h"
+#include "mem_placement.h"
+#include "model_inference.h"
+#include "metrics.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define CAPTURE_TASK_STACK 3072
+#define FEATURE_TASK_STACK 8192
+#define INFERENCE_TASK_STACK 8192
+#define RESULT_QUEUE_LEN (2 * SCHED_CLIP_SLOTS)
+// 프레임 버퍼 + delta 링 + clip_logmel_t (약 12 KB)
+#define FEATURE_SCRATCH_SIZE (16 * 1024)
+#define NO_SEQ 0xffffffff
+
+static const char* TAG = "SCHEDULER";
+
+typedef struct {
+    int16_t* samples;
+    size_t count;
+    uint32_t clip;
+    int64_t captured_us;
+    bool ok;
+    clip_features_t features;
+} clip_slot_t;
+
+typedef struct {
+    uint32_t jobs;
+    int64_t busy_us;
+    uint8_t max_depth;
+} stage_counter_t;
+
+static clip_slot_t slots[SCHED_CLIP_SLOTS];
+static QueueHandle_t capture_queue;
+static QueueHandle_t free_queue;
+static QueueHandle_t feature_queue;
+static QueueHandle_t infer_queue;
+static QueueHandle_t result_queue;
+// 특징 추출 태스크 전용 scratch, 추론이 쓰는 요청 아레나와 겹치지 않게 분리
+static mem_arena_t feature_scratch;
+static sched_policy_t policy;
+static stage_counter_t counters[SCHED_STAGE_COUNT];
+static volatile uint32_t capture_pending;
+static uint32_t dropped;
+static uint32_t backpressure_waits;
+static uint32_t next_clip;
+static int64_t start_us;
+
+static void note_depth(sched_stage_t stage, QueueHandle_t queue) {
+    UBaseType_t depth = uxQueueMessagesWaiting(queue);
+    if (depth > counters[stage].max_depth) {
+        counters[stage].max_depth = depth;
+    }
+}
+
+static void post_result(const clip_slot_t* slot, int8_t result, uint32_t seq) {
+    sched_result_t out;
+    out.clip = slot->clip;
+    out.result = result;
+    out.seq = seq;
+    out.latency_us = esp_timer_get_time() - slot->captured_us;
+    xQueueSend(result_queue, &out, portMAX_DELAY);
+}
+
+// 빈 클립 버퍼를 얻는다, 없으면 정책에 따라 가장 오래된 대기 클립을 버리거나 기다린다
+static uint8_t acquire_slot() {
+    uint8_t index;
+    if (xQueueReceive(free_queue, &index, 0) == pdTRUE) {
+        return index;
+    }
+    if (policy == SCHED_DROP_OLDEST && xQueueReceive(feature_queue, &index, 0) == pdTRUE) {
+        dropped++;
+        metrics_add(METRIC_CLIPS_DROPPED);
+        ESP_LOGW(TAG, "dropping clip %u", (unsigned)slots[index].clip);
+        post_result(&slots[index], -1, NO_SEQ);
+        return index;
+    }
+    backpressure_waits++;
+    xQueueReceive(free_queue, &index, portMAX_DELAY);
+    return index;
+}
+
+static void capture_task(void* arg) {
+    uint16_t clips;
+
+    while (1) {
+        if (xQueueReceive(capture_queue, &clips, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        capture_pending = clips;
+        for (uint16_t i = 0; i < clips; i++) {
+            uint8_t index = acquire_slot();
+            clip_slot_t* slot = &slots[index];
+
+            int64_t begin = esp_timer_get_time();
+            slot->clip = next_clip++;
+            slot->count = record_clip(slot->samples, MAX_AUDIO_SIZE);
+            slot->captured_us = esp_timer_get_time();
+            counters[SCHED_STAGE_CAPTURE].busy_us += slot->captured_us - begin;
+            counters[SCHED_STAGE_CAPTURE].jobs++;
+            capture_pending--;
+
+            xQueueSend(feature_queue, &index, portMAX_DELAY);
+            note_depth(SCHED_STAGE_FEATURE, feature_queue);
+
+            // 녹음은 바쁜 대기이므로 클립 사이에 한 틱 양보해 idle 태스크(WDT)가 돌게 한다
+            vTaskDelay(1);
+        }
+    }
+}
+
+static void feature_task(void* arg) {
+    uint8_t index;
+
+    while (1) {
+        if (xQueueReceive(feature_queue, &index, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        clip_slot_t* slot = &slots[index];
+        int64_t begin = esp_timer_get_time();
+        slot->ok = clip_features(slot->samples, slot->count, &slot->features, &feature_scratch) == ESP_OK;
+        counters[SCHED_STAGE_FEATURE].busy_us += esp_timer_get_time() - begin;
+        counters[SCHED_STAGE_FEATURE].jobs++;
+
+        xQueueSend(infer_queue, &index, portMAX_DELAY);
+        note_depth(SCHED_STAGE_INFERENCE, infer_queue);
+    }
+}
+
+static void inference_task(void* arg) {
+    uint8_t index;
+
+    while (1) {
+        if (xQueueReceive(infer_queue, &index, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        clip_slot_t* slot = &slots[index];
+        int64_t begin = esp_timer_get_time();
+        int8_t result = -1;
+        uint32_t seq = NO_SEQ;
+        if (slot->ok) {
+            result = (int8_t)atoi(pipeline_clip(&slot->features, slot->samples, slot->count, &seq));
+        }
+        counters[SCHED_STAGE_INFERENCE].busy_us += esp_timer_get_time() - begin;
+        counters[SCHED_STAGE_INFERENCE].jobs++;
+
+        post_result(slot, result, seq);
+        xQueueSend(free_queue, &index, portMAX_DELAY);
+    }
+}
+
+esp_err_t init_scheduler(sched_policy_t sched_policy) {
+    if (capture_queue) {
+        return ESP_OK;
+    }
+
+    policy = sched_policy;
+    capture_queue = xQueueCreate(1, sizeof(uint16_t));
+    free_queue = xQueueCreate(SCHED_CLIP_SLOTS, sizeof(uint8_t));
+    feature_queue = xQueueCreate(SCHED_CLIP_SLOTS, sizeof(uint8_t));
+    infer_queue = xQueueCreate(SCHED_CLIP_SLOTS, sizeof(uint8_t));
+    result_queue = xQueueCreate(RESULT_QUEUE_LEN, sizeof(sched_result_t));
+    if (!capture_queue || !free_queue || !feature_queue || !infer_queue || !result_queue) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = mem_arena_init(&feature_scratch, "feature", FEATURE_SCRATCH_SIZE,
+                                   mem_place_caps(MEM_FRAME_SCRATCH, FEATURE_SCRATCH_SIZE));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    for (uint8_t i = 0; i < SCHED_CLIP_SLOTS; i++) {
+        slots[i].samples = (int16_t*)mem_place_alloc(MEM_AUDIO, MAX_AUDIO_SIZE * sizeof(int16_t));
+        if (!slots[i].samples) {
+            ESP_LOGE(TAG, "Failed to allocate clip slot %d", i);
+            return ESP_ERR_NO_MEM;
+        }
+        xQueueSend(free_queue, &i, 0);
+    }
+
+    // 녹음(바쁜 대기)은 코어 1, 특징 추출/추론은 코어 0
+    if (xTaskCreatePinnedToCore(capture_task, "sched_capture", CAPTURE_TASK_STACK, NULL, 6, NULL, 1) != pdPASS ||
+        xTaskCreatePinnedToCore(feature_task, "sched_feature", FEATURE_TASK_STACK, NULL, 5, NULL, 0) != pdPASS ||
+        xTaskCreatePinnedToCore(inference_task, "sched_infer", INFERENCE_TASK_STACK, NULL, 4, NULL, 0) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    start_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "scheduler ready: %d clip slots, policy %s", SCHED_CLIP_SLOTS,
+             policy == SCHED_DROP_OLDEST ? "drop-oldest" : "backpressure");
+    return ESP_OK;
+}
+
+bool scheduler_ready() {
+    return capture_queue != NULL;
+}
+
+esp_err_t scheduler_run(uint16_t clips, sched_result_fn on_result, void* ctx) {
+    if (!capture_queue) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (clips == 0) {
+        return ESP_OK;
+    }
+
+    xQueueSend(capture_queue, &clips, portMAX_DELAY);
+    for (uint16_t i = 0; i < clips; i++) {
+        sched_result_t result;
+        xQueueReceive(result_queue, &result, portMAX_DELAY);
+        on_result(ctx, &result);
+    }
+
+    sched_stats_t stats;
+    scheduler_get_stats(&stats);
+    ESP_LOGI(TAG, "run of %u clips done: utilization capture %u, feature %u, inference %u permille, dropped %u",
+             clips, stats.stage[SCHED_STAGE_CAPTURE].utilization_permille,
+             stats.stage[SCHED_STAGE_FEATURE].utilization_permille,
+             stats.stage[SCHED_STAGE_INFERENCE].utilization_permille, (unsigned)stats.dropped);
+    return ESP_OK;
+}
+
+void scheduler_get_stats(sched_stats_t* stats) {
+    int64_t uptime_us = esp_timer_get_time() - start_us;
+    memset(stats, 0, sizeof(*stats));
+    if (!capture_queue) {
+        return;
+    }
+
+    for (int i = 0; i < SCHED_STAGE_COUNT; i++) {
+        stats->stage[i].jobs = counters[i].jobs;
+        stats->stage[i].busy_ms = counters[i].busy_us / 1000;
+        stats->stage[i].utilization_permille = uptime_us > 0 ? counters[i].busy_us * 1000 / uptime_us : 0;
+        stats->stage[i].max_queue_depth = counters[i].max_depth;
+    }
+    stats->stage[SCHED_STAGE_CAPTURE].queue_depth = capture_pending;
+    stats->stage[SCHED_STAGE_FEATURE].queue_depth = uxQueueMessagesWaiting(feature_queue);
+    stats->stage[SCHED_STAGE_INFERENCE].queue_depth = uxQueueMessagesWaiting(infer_queue);
+    stats->dropped = dropped;
+    stats->backpressure_waits = backpressure_waits;
+    stats->uptime_ms = uptime_us / 1000;
+}
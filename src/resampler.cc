@@ -0,0 +1,139 @@
+#include "resampler.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_dsp.h"
+
+#include <math.h>
+#include <string.h>
+
+static const char* TAG = "RESAMPLER";
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// 0차 수정 베셀 함수 (Kaiser 창)
+static double bessel_i0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < 1e-12 * sum) {
+            break;
+        }
+    }
+    return sum;
+}
+
+// 프로토타입 h[n] (up * in_rate 레이트) 을 만들어 위상별로 나눠 저장
+static void design_filter(resampler_t* rs) {
+    int length = rs->up * rs->taps;
+    double center = (length - 1) / 2.0;
+    // 정규화 차단 주파수 (프로토타입 레이트의 나이퀴스트 = 1)
+    double cutoff = RESAMPLER_CUTOFF / (rs->up > rs->down ? rs->up : rs->down);
+    double i0_beta = bessel_i0(RESAMPLER_KAISER_BETA);
+
+    for (int n = 0; n < length; n++) {
+        double t = n - center;
+        double sinc = t == 0.0 ? cutoff : sin(M_PI * cutoff * t) / (M_PI * t);
+        double r = 2.0 * n / (length - 1) - 1.0;
+        double window = bessel_i0(RESAMPLER_KAISER_BETA * sqrt(1.0 - r * r)) / i0_beta;
+        // 0 삽입으로 줄어든 이득을 up 배로 보상
+        double h = sinc * window * rs->up;
+
+        int phase = n % rs->up;
+        int k = n / rs->up;
+        rs->coeffs[phase * rs->taps + (rs->taps - 1 - k)] = (float)h;
+    }
+}
+
+size_t resampler_footprint(uint32_t in_rate, uint32_t out_rate, int taps) {
+    uint32_t g = gcd(in_rate, out_rate);
+    return g ? ((size_t)(out_rate / g) + 2) * taps * sizeof(float) : 0;
+}
+
+esp_err_t resampler_init(resampler_t* rs, uint32_t in_rate, uint32_t out_rate, int taps, uint32_t caps) {
+    memset(rs, 0, sizeof(*rs));
+    if (in_rate == 0 || out_rate == 0 || taps <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t g = gcd(in_rate, out_rate);
+    rs->up = out_rate / g;
+    rs->down = in_rate / g;
+    rs->taps = taps;
+    rs->coeffs = (float*)heap_caps_malloc((size_t)rs->up * taps * sizeof(float), caps);
+    rs->history = (float*)heap_caps_calloc(2 * taps, sizeof(float), caps);
+    if (!rs->coeffs || !rs->history) {
+        ESP_LOGE(TAG, "Failed to allocate %u x %d taps", (unsigned)rs->up, taps);
+        resampler_deinit(rs);
+        return ESP_ERR_NO_MEM;
+    }
+
+    design_filter(rs);
+    ESP_LOGI(TAG, "%u -> %u Hz: up %u, down %u, %d taps/phase", (unsigned)in_rate, (unsigned)out_rate,
+             (unsigned)rs->up, (unsigned)rs->down, taps);
+    return ESP_OK;
+}
+
+void resampler_deinit(resampler_t* rs) {
+    heap_caps_free(rs->coeffs);
+    heap_caps_free(rs->history);
+    rs->coeffs = NULL;
+    rs->history = NULL;
+}
+
+void resampler_reset(resampler_t* rs) {
+    memset(rs->history, 0, 2 * rs->taps * sizeof(float));
+    rs->pos = 0;
+    rs->phase = 0;
+}
+
+size_t resampler_max_output(const resampler_t* rs, size_t count) {
+    return ((uint64_t)count * rs->up + rs->down - 1) / rs->down + 1;
+}
+
+static inline int16_t saturate(float value) {
+    if (value >= 32767.0f) {
+        return 32767;
+    }
+    if (value <= -32768.0f) {
+        return -32768;
+    }
+    return (int16_t)lrintf(value);
+}
+
+int resampler_push(resampler_t* rs, int16_t in, int16_t* out) {
+    // history[pos] 와 history[pos + taps] 에 같이 기록하면 [pos + 1, pos + taps] 가 오래된 순서의 창
+    float x = in;
+    rs->history[rs->pos] = x;
+    rs->history[rs->pos + rs->taps] = x;
+    const float* window = rs->history + rs->pos + 1;
+    if (++rs->pos == rs->taps) {
+        rs->pos = 0;
+    }
+
+    int produced = 0;
+    while (rs->phase < rs->up) {
+        float y;
+        dsps_dotprod_f32(rs->coeffs + rs->phase * rs->taps, window, &y, rs->taps);
+        out[produced++] = saturate(y);
+        rs->phase += rs->down;
+    }
+    rs->phase -= rs->up;
+    return produced;
+}
+
+size_t resampler_process(resampler_t* rs, const int16_t* in, size_t count, int16_t* out) {
+    size_t produced = 0;
+    for (size_t i = 0; i < count; i++) {
+        produced += resampler_push(rs, in[i], out + produced);
+    }
+    return produced;
+}
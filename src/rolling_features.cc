@@ -0,0 +1,184 @@
+#include "rolling_features.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+#include <string.h>
+
+// 누적 오차가 쌓이지 않도록 이만큼 프레임이 지날 때마다 합을 링에서 다시 계산
+#define RESUM_INTERVAL 4096
+
+static const char* TAG = "ROLLING";
+
+esp_err_t rolling_init(rolling_features_t* rolling, int window_frames, uint32_t caps) {
+    memset(rolling, 0, sizeof(*rolling));
+    esp_err_t ret = delta_kernel_init(&rolling->kernel, DELTA_WIDTH);
+    if (ret != ESP_OK || window_frames < rolling->kernel.width) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    rolling->frames = (float*)heap_caps_malloc((size_t)window_frames * NUM_MEL_FILTERS * sizeof(float), caps);
+    rolling->deltas = (delta_stats_t*)heap_caps_calloc(2, sizeof(delta_stats_t), caps);
+    if (!rolling->frames || !rolling->deltas) {
+        ESP_LOGE(TAG, "Failed to allocate %d frames", window_frames);
+        rolling_deinit(rolling);
+        return ESP_ERR_NO_MEM;
+    }
+    rolling->capacity = window_frames;
+    return ESP_OK;
+}
+
+void rolling_deinit(rolling_features_t* rolling) {
+    heap_caps_free(rolling->frames);
+    heap_caps_free(rolling->deltas);
+    rolling->frames = NULL;
+    rolling->deltas = NULL;
+    rolling->capacity = 0;
+}
+
+void rolling_reset(rolling_features_t* rolling) {
+    rolling->count = 0;
+    rolling->head = 0;
+    rolling->pending_count = 0;
+    memset(rolling->sum, 0, sizeof(rolling->sum));
+    delta_stats_reset(&rolling->deltas[0]);
+}
+
+// 창 안 i 번째 (0 = 가장 오래된) 프레임
+static const float* window_frame(const rolling_features_t* rolling, int i) {
+    return rolling->frames + (size_t)((rolling->head + i) % rolling->capacity) * NUM_MEL_FILTERS;
+}
+
+// 창 안 center 번째 프레임의 delta 를 stats 에 sign 으로 누적, 창 밖 문맥은 끝 프레임 복제
+static void update_delta(const rolling_features_t* rolling, delta_stats_t* stats, int center, float sign) {
+    const float* frames[DELTA_MAX_WIDTH];
+    float d1[NUM_MEL_FILTERS];
+    float d2[NUM_MEL_FILTERS];
+    for (int i = 0; i < rolling->kernel.width; i++) {
+        int t = center + i - rolling->kernel.half;
+        t = t < 0 ? 0 : t >= rolling->count ? rolling->count - 1 : t;
+        frames[i] = window_frame(rolling, t);
+    }
+    delta_frame(&rolling->kernel, frames, d1, d2);
+    delta_stats_update(stats, d1, d2, sign);
+}
+
+static void resum(rolling_features_t* rolling) {
+    memset(rolling->sum, 0, sizeof(rolling->sum));
+    for (int i = 0; i < rolling->count; i++) {
+        const float* frame = window_frame(rolling, i);
+        for (int j = 0; j < NUM_MEL_FILTERS; j++) {
+            rolling->sum[j] += frame[j];
+        }
+    }
+
+    int half = rolling->kernel.half;
+    delta_stats_reset(&rolling->deltas[0]);
+    for (int c = half; c < rolling->count - half; c++) {
+        update_delta(rolling, &rolling->deltas[0], c, 1.0f);
+    }
+}
+
+// 새 프레임을 링 끝에 넣고, 가득 찼으면 가장 오래된 프레임을 합에서 빼고 덮어쓴다
+// delta 는 내부 프레임 집합의 변화만 반영: 가장 오래된 프레임이 빠지면 half 번째가 가장자리가 되고,
+// 새 프레임이 들어오면 끝에서 half 번째가 내부가 된다
+static void add_frame(rolling_features_t* rolling, const float* mel) {
+    int half = rolling->kernel.half;
+    int slot;
+    if (rolling->count == rolling->capacity) {
+        update_delta(rolling, &rolling->deltas[0], half, -1.0f);
+        slot = rolling->head;
+        rolling->head = (rolling->head + 1) % rolling->capacity;
+        const float* oldest = rolling->frames + (size_t)slot * NUM_MEL_FILTERS;
+        for (int j = 0; j < NUM_MEL_FILTERS; j++) {
+            rolling->sum[j] -= oldest[j];
+        }
+    } else {
+        slot = (rolling->head + rolling->count) % rolling->capacity;
+        rolling->count++;
+    }
+
+    memcpy(rolling->frames + (size_t)slot * NUM_MEL_FILTERS, mel, NUM_MEL_FILTERS * sizeof(float));
+    for (int j = 0; j < NUM_MEL_FILTERS; j++) {
+        rolling->sum[j] += mel[j];
+    }
+    if (rolling->count >= rolling->kernel.width) {
+        update_delta(rolling, &rolling->deltas[0], rolling->count - 1 - half, 1.0f);
+    }
+
+    if (++rolling->total_frames % RESUM_INTERVAL == 0) {
+        resum(rolling);
+    }
+}
+
+int rolling_push(rolling_features_t* rolling, const int16_t* samples, size_t count, mem_arena_t* scratch) {
+    if (!scratch) {
+        scratch = internal_arena();
+    }
+    ArenaBuffer<float> frame_real(scratch, FRAME_LENGTH);
+    ArenaBuffer<float> frame_imag(scratch, FRAME_LENGTH);
+    ArenaBuffer<float> mel(scratch, MFCC_BUFFER_SIZE);
+    if (!frame_real || !frame_imag || !mel) {
+        ESP_LOGE(TAG, "Failed to allocate frame buffers");
+        return 0;
+    }
+
+    int added = 0;
+    while (count > 0) {
+        size_t take = FRAME_LENGTH - rolling->pending_count;
+        if (take > count) {
+            take = count;
+        }
+        memcpy(rolling->pending + rolling->pending_count, samples, take * sizeof(int16_t));
+        rolling->pending_count += take;
+        samples += take;
+        count -= take;
+
+        if (rolling->pending_count == FRAME_LENGTH) {
+            logmel_frame(rolling->pending, frame_real.get(), frame_imag.get(), mel.get());
+            add_frame(rolling, mel.get());
+            added++;
+            // 다음 프레임은 한 hop 뒤에서 시작
+            memmove(rolling->pending, rolling->pending + FRAME_STEP, (FRAME_LENGTH - FRAME_STEP) * sizeof(int16_t));
+            rolling->pending_count = FRAME_LENGTH - FRAME_STEP;
+        }
+    }
+    return added;
+}
+
+bool rolling_full(const rolling_features_t* rolling) {
+    return rolling->capacity > 0 && rolling->count == rolling->capacity;
+}
+
+esp_err_t rolling_mfcc(const rolling_features_t* rolling, feature_slice_t mfcc, int n_mfcc) {
+    if (n_mfcc > MAX_MFCC || n_mfcc < NUM_MEL_FILTERS || rolling->count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    float mel[MFCC_BUFFER_SIZE];
+    for (int j = 0; j < NUM_MEL_FILTERS; j++) {
+        mel[j] = (float)(rolling->sum[j] / rolling->count);
+    }
+    mfcc_from_logmel(mel, n_mfcc);
+    for (int j = 0; j < n_mfcc; j++) {
+        mfcc.data[j * mfcc.stride] = mel[j];
+    }
+    return ESP_OK;
+}
+
+esp_err_t rolling_deltas(rolling_features_t* rolling, int n_mfcc, feature_slice_t delta, feature_slice_t delta2) {
+    if (rolling->count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 내부 누적에 양쪽 가장자리 half 프레임씩 더한다
+    delta_stats_t* stats = &rolling->deltas[1];
+    memcpy(stats, &rolling->deltas[0], sizeof(*stats));
+    int half = rolling->kernel.half;
+    for (int c = 0; c < rolling->count; c++) {
+        if (c >= half && c < rolling->count - half) {
+            c = rolling->count - half - 1;
+            continue;
+        }
+        update_delta(rolling, stats, c, 1.0f);
+    }
+    return delta_stats_std(stats, n_mfcc, delta, delta2);
+}
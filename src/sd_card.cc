@@ -1,9 +1,12 @@
 #include "rel_common.h"
 #include "sd_card.h"
+#include "data_paths.h"
+#include "sd_reader.h"
 #include "esp_vfs_fat.h"
 #include "driver/sdspi_host.h"
 #include "driver/spi_common.h"
 #include "sdmmc_cmd.h"
+#include "diskio_sdmmc.h"
 #include "esp_log.h"
 
 #define SD_CLK GPIO_NUM_16
@@ -14,6 +17,19 @@
 static const char *TAG = "SD_CARD";
 sdmmc_card_t *card = NULL;
 
+static void self_test() {
+    char path[DATA_PATH_MAX];
+    sd_bench_t bench;
+    if (sd_read_benchmark(data_path(path, sizeof(path), FIRST_MODEL_FILE_NAME), &bench) != ESP_OK ||
+        bench.raw_us <= 0 || bench.stdio_us <= 0) {
+        ESP_LOGW(TAG, "Read self-test skipped");
+        return;
+    }
+    // 바이트 / us = MB/s
+    ESP_LOGI(TAG, "Read %u bytes: raw %.2f MB/s, stdio %.2f MB/s", (unsigned)bench.bytes,
+             (double)bench.bytes / bench.raw_us, (double)bench.bytes / bench.stdio_us);
+}
+
 esp_err_t init_sd_card() {
     esp_err_t ret;
     esp_vfs_fat_sdmmc_mount_config_t mount_config = {
@@ -23,7 +39,7 @@ esp_err_t init_sd_card() {
     };
 
     sdmmc_host_t host = SDSPI_HOST_DEFAULT();
-    host.max_freq_khz = 4000;
+    host.max_freq_khz = SD_FREQ_KHZ;
 
     spi_bus_config_t bus_cfg = {
         .mosi_io_num = SD_MOSI,
@@ -31,7 +47,7 @@ esp_err_t init_sd_card() {
         .sclk_io_num = SD_CLK,
         .quadwp_io_num = -1,
         .quadhd_io_num = -1,
-        .max_transfer_sz = 4000,
+        .max_transfer_sz = SD_MAX_TRANSFER,
     };
 
     ret = spi_bus_initialize(SPI3_HOST, &bus_cfg, SDSPI_DEFAULT_DMA);
@@ -44,7 +60,14 @@ esp_err_t init_sd_card() {
     slot_config.gpio_cs = SD_CS;
     slot_config.host_id = SPI3_HOST;
 
-    ret = esp_vfs_fat_sdspi_mount("/sdcard", &host, &slot_config, &mount_config, &card);
+    ret = esp_vfs_fat_sdspi_mount(DEFAULT_DATA_ROOT, &host, &slot_config, &mount_config, &card);
+    if (ret != ESP_OK && ret != ESP_FAIL && host.max_freq_khz > SD_FALLBACK_FREQ_KHZ) {
+        // 카드 초기화 단계의 실패는 배선/카드 속도 문제일 수 있어 낮은 클럭으로 한 번 더
+        ESP_LOGW(TAG, "Card init failed at %d kHz (%s), retrying at %d kHz", host.max_freq_khz,
+                 esp_err_to_name(ret), SD_FALLBACK_FREQ_KHZ);
+        host.max_freq_khz = SD_FALLBACK_FREQ_KHZ;
+        ret = esp_vfs_fat_sdspi_mount(DEFAULT_DATA_ROOT, &host, &slot_config, &mount_config, &card);
+    }
 
     if (ret != ESP_OK) {
         if (ret == ESP_FAIL) {
@@ -55,11 +78,15 @@ esp_err_t init_sd_card() {
         return ret;
     }
 
-    ESP_LOGI(TAG, "SD card mounted successfully");
+    sd_reader_set_drive(DEFAULT_DATA_ROOT, ff_diskio_get_pdrv_card(card));
+    ESP_LOGI(TAG, "SD card mounted successfully (%d kHz)", card->real_freq_khz);
+#if SD_SELF_TEST
+    self_test();
+#endif
     return ESP_OK;
 }
 
 void cleanup_sd_card() {
-    esp_vfs_fat_sdcard_unmount("/sdcard", card);
+    esp_vfs_fat_sdcard_unmount(DEFAULT_DATA_ROOT, card);
     ESP_LOGI(TAG, "Card unmounted");
 }
@@ -0,0 +1,147 @@
+#include "sd_reader.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "ff.h"
+
+#include <string.h>
+
+static const char* TAG = "SD_READER";
+
+static char mount_prefix[16];
+static int drive = -1;
+
+void sd_reader_set_drive(const char* mount_point, int pdrv) {
+    strncpy(mount_prefix, mount_point, sizeof(mount_prefix) - 1);
+    drive = pdrv;
+}
+
+// "/sdcard/x.tflite" -> "0:/x.tflite"
+static const char* fatfs_path(const char* path, char* out, size_t size) {
+    size_t len = strlen(mount_prefix);
+    if (drive < 0 || strncmp(path, mount_prefix, len) != 0) {
+        return path;
+    }
+    snprintf(out, size, "%d:%s", drive, path + len);
+    return out;
+}
+
+static esp_err_t open_file(const char* path, FIL* file) {
+    char buf[128];
+    FRESULT res = f_open(file, fatfs_path(path, buf, sizeof(buf)), FA_READ);
+    if (res != FR_OK) {
+        ESP_LOGE(TAG, "Failed to open %s (%d)", path, (int)res);
+        return res == FR_NO_FILE || res == FR_NO_PATH ? ESP_ERR_NOT_FOUND : ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t sd_file_size(const char* path, size_t* size) {
+    FIL file;
+    esp_err_t ret = open_file(path, &file);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    *size = f_size(&file);
+    f_close(&file);
+    return ESP_OK;
+}
+
+// 내부 RAM 이 모자라면 절반씩 줄여 재시도 (최소 8 섹터)
+static uint8_t* alloc_chunk(size_t* size) {
+    for (size_t n = SD_READ_CHUNK; n >= 8 * SD_SECTOR_SIZE; n /= 2) {
+        uint8_t* chunk = (uint8_t*)heap_caps_aligned_alloc(SD_DMA_ALIGN, n, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (chunk) {
+            *size = n;
+            return chunk;
+        }
+    }
+    return NULL;
+}
+
+esp_err_t sd_read_file(const char* path, void* dst, size_t size, size_t* read) {
+    *read = 0;
+    FIL file;
+    esp_err_t ret = open_file(path, &file);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    size_t chunk_size;
+    uint8_t* chunk = alloc_chunk(&chunk_size);
+    if (!chunk) {
+        ESP_LOGE(TAG, "Failed to allocate DMA buffer");
+        f_close(&file);
+        return ESP_ERR_NO_MEM;
+    }
+
+    size_t total = f_size(&file) < size ? f_size(&file) : size;
+    uint8_t* out = (uint8_t*)dst;
+    while (*read < total) {
+        UINT n = total - *read < chunk_size ? total - *read : chunk_size;
+        UINT got = 0;
+        FRESULT res = f_read(&file, chunk, n, &got);
+        if (res != FR_OK) {
+            ESP_LOGE(TAG, "Read error %d in %s at %u", (int)res, path, (unsigned)*read);
+            ret = ESP_FAIL;
+            break;
+        }
+        memcpy(out + *read, chunk, got);
+        *read += got;
+        if (got < n) {
+            break;
+        }
+    }
+
+    heap_caps_free(chunk);
+    f_close(&file);
+    return ret;
+}
+
+FILE* sd_open_buffered(const char* path, mem_arena_t* arena) {
+    size_t size;
+    if (sd_file_size(path, &size) != ESP_OK || size == 0) {
+        return NULL;
+    }
+    void* data = mem_arena_alloc(arena, size);
+    if (!data) {
+        ESP_LOGE(TAG, "No arena space for %s (%u bytes)", path, (unsigned)size);
+        return NULL;
+    }
+    size_t read;
+    if (sd_read_file(path, data, size, &read) != ESP_OK || read != size) {
+        return NULL;
+    }
+    return fmemopen(data, size, "rb");
+}
+
+esp_err_t sd_read_benchmark(const char* path, sd_bench_t* out) {
+    memset(out, 0, sizeof(*out));
+    size_t size;
+    esp_err_t ret = sd_file_size(path, &size);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    uint8_t* data = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (!data) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    int64_t start = esp_timer_get_time();
+    size_t read = 0;
+    ret = sd_read_file(path, data, size, &read);
+    out->raw_us = esp_timer_get_time() - start;
+
+    if (ret == ESP_OK) {
+        start = esp_timer_get_time();
+        FILE* f = fopen(path, "rb");
+        if (f) {
+            read = fread(data, 1, size, f);
+            fclose(f);
+        }
+        out->stdio_us = esp_timer_get_time() - start;
+        ret = f && read == size ? ESP_OK : ESP_FAIL;
+    }
+    out->bytes = size;
+    heap_caps_free(data);
+    return ret;
+}
@@ -0,0 +1,59 @@
+#include "stage_executor.h"
+#include "model_inference.h"
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#define EXECUTOR_TASK_STACK 8192
+
+static const char* TAG = "STAGE_EXECUTOR";
+
+static TaskHandle_t executor_task_handle;
+static SemaphoreHandle_t job_done;
+static void (*pending_job)(void*);
+static void* pending_ctx;
+
+static void executor_task(void* arg) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        pending_job(pending_ctx);
+        xSemaphoreGive(job_done);
+    }
+}
+
+static esp_err_t executor_start(void (*job)(void*), void* ctx) {
+    pending_job = job;
+    pending_ctx = ctx;
+    xTaskNotifyGive(executor_task_handle);
+    return ESP_OK;
+}
+
+static void executor_wait() {
+    xSemaphoreTake(job_done, portMAX_DELAY);
+}
+
+static const stage_executor_t executor = {executor_start, executor_wait};
+
+esp_err_t init_stage_executor() {
+    if (executor_task_handle) {
+        return ESP_OK;
+    }
+
+    job_done = xSemaphoreCreateBinary();
+    if (!job_done) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreatePinnedToCore(executor_task, "stage_exec", EXECUTOR_TASK_STACK, NULL, 5, &executor_task_handle,
+                                STAGE_EXECUTOR_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start executor task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = enable_speculation(&executor);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "stage 2 speculation on core %d", STAGE_EXECUTOR_CORE);
+    }
+    return ret;
+}
@@ -1,31 +1,170 @@
 #include "rel_common.h"
 #include "driver/uart.h"
-#include "audio_processing.h"
-#include "model_inference.h"
+#include "uart_handler.h"
+#include "command_dispatch.h"
+#include "power_mgmt.h"
+#include "esp_sleep.h"
+#include "freertos/queue.h"
 
-#define UART_NUM UART_NUM_0
+#define UART_RX_BUFFER_SIZE 4096
+#define UART_TX_BUFFER_SIZE 2048
+#define UART_EVENT_QUEUE_LEN 20
+#define UART_READ_CHUNK 256
+#define UART_EVENT_TASK_STACK 3072
+#define UART_WORKER_STACK 8192
+#define UART_COMMAND_QUEUE_LEN 4
+
+static const char* TAG = "UART";
+
+// 수신 이벤트 태스크는 프레임만 조립하고, 녹음 / 추론은 워커 태스크가 처리
+typedef struct {
+    uint8_t cmd;
+    uint16_t len;
+    bool legacy;            // 1바이트 'r' 명령: 결과를 텍스트 한 줄로 응답
+    uint8_t payload[CMD_MAX_PAYLOAD];
+} uart_cmd_t;
+
+static QueueHandle_t uart_queue;
+static QueueHandle_t command_queue;
+static cmd_parser_t parser;
+
+static void uart_reply(void* ctx, uint8_t cmd, uint8_t status, const uint8_t* frame, size_t len) {
+    uart_write_bytes(UART_CMD_NUM, frame, len);
+}
+
+static void uart_legacy_reply(void* ctx, uint8_t cmd, uint8_t status, const uint8_t* frame, size_t len) {
+    if (status == CMD_STATUS_PENDING) {
+        return;
+    }
+    char text[24];
+    int n = snprintf(text, sizeof(text), "result: %d\r\n", cmd_legacy_result(status, frame, len));
+    uart_write_bytes(UART_CMD_NUM, text, n);
+}
+
+// 워커가 바쁜 동안 대기열이 차면 거절 응답만 보낸다
+static void queue_command(uint8_t cmd, const uint8_t* payload, uint16_t len, bool legacy = false) {
+    uart_cmd_t item;
+    item.cmd = cmd;
+    item.len = len;
+    item.legacy = legacy;
+    if (len > 0) {
+        memcpy(item.payload, payload, len);
+    }
+    if (xQueueSend(command_queue, &item, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "command queue full, rejecting 0x%02x", cmd);
+        uint8_t reply[CMD_FRAME_OVERHEAD + 1];
+        size_t n = cmd_encode_reply(reply, sizeof(reply), cmd, CMD_STATUS_FAILED, NULL, 0);
+        (legacy ? uart_legacy_reply : uart_reply)(NULL, cmd, CMD_STATUS_FAILED, reply, n);
+    }
+}
+
+static void handle_bytes(const uint8_t* data, int len) {
+    cmd_frame_t frame;
+
+    for (int i = 0; i < len; i++) {
+        // 모니터에서 'r' 만 입력하던 기존 방식도 유지
+        if (cmd_parser_idle(&parser) && data[i] == 'r') {
+            queue_command(CMD_RECORD, NULL, 0, true);
+            continue;
+        }
+        if (cmd_parser_push(&parser, data[i], &frame)) {
+            do {
+                queue_command(frame.cmd, frame.payload, frame.len);
+            } while (cmd_parser_poll(&parser, &frame));
+        }
+    }
+}
+
+static void uart_worker_task(void* arg) {
+    uart_cmd_t item;
+
+    while (1) {
+        if (xQueueReceive(command_queue, &item, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        cmd_frame_t frame = {item.cmd, item.len, item.payload};
+        command_dispatch(&frame, item.legacy ? uart_legacy_reply : uart_reply, NULL);
+    }
+}
+
+// 폴링 대신 UART 드라이버 이벤트 큐에서 수신 이벤트를 받아 처리
+static void uart_event_task(void* arg) {
+    uart_event_t event;
+    static uint8_t data[UART_READ_CHUNK];
+
+    while (1) {
+        // 프레임 도중이면 CMD_FRAME_TIMEOUT_MS 안에 다음 바이트가 와야 한다
+        TickType_t wait = cmd_parser_idle(&parser) ? portMAX_DELAY : pdMS_TO_TICKS(CMD_FRAME_TIMEOUT_MS);
+        if (xQueueReceive(uart_queue, &event, wait) != pdTRUE) {
+            ESP_LOGW(TAG, "frame timeout, dropping %d bytes", parser.count - parser.consumed);
+            cmd_parser_reset(&parser);
+            continue;
+        }
+
+        // light sleep 에서 깨운 바이트는 잃으므로 이어지는 (재전송) 프레임은 깬 상태로 받는다
+        power_stay_awake(PM_UART_AWAKE_MS);
+
+        switch (event.type) {
+            case UART_DATA:
+                for (size_t left = event.size; left > 0;) {
+                    int n = uart_read_bytes(UART_CMD_NUM, data, left < sizeof(data) ? left : sizeof(data), 0);
+                    if (n <= 0) {
+                        break;
+                    }
+                    handle_bytes(data, n);
+                    left -= n;
+                }
+                break;
+
+            case UART_FIFO_OVF:
+            case UART_BUFFER_FULL:
+                ESP_LOGW(TAG, "rx overflow (%d), flushing", event.type);
+                uart_flush_input(UART_CMD_NUM);
+                xQueueReset(uart_queue);
+                cmd_parser_reset(&parser);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
 
 void init_uart() {
     uart_config_t uart_config = {
-        .baud_rate = 115200,
+        .baud_rate = UART_BAUD_RATE,
         .data_bits = UART_DATA_8_BITS,
         .parity = UART_PARITY_DISABLE,
         .stop_bits = UART_STOP_BITS_1,
-        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .rx_flow_ctrl_thresh = 0,
+        // APB 가 동적 주파수로 바뀌어도 보레이트가 유지되도록 XTAL 클럭
+        .source_clk = UART_SCLK_XTAL,
     };
 
-    ESP_ERROR_CHECK(uart_param_config(UART_NUM, &uart_config));
-    ESP_ERROR_CHECK(uart_driver_install(UART_NUM, 1024 * 2, 0, 0, NULL, 0));
-}
-
-void uart_read() {
-    uint8_t data[1024];
+    ESP_ERROR_CHECK(uart_param_config(UART_CMD_NUM, &uart_config));
+#if UART_CMD_NUM != UART_NUM_0
+    ESP_ERROR_CHECK(uart_set_pin(UART_CMD_NUM, UART_CMD_TX_PIN, UART_CMD_RX_PIN, UART_PIN_NO_CHANGE,
+                                 UART_PIN_NO_CHANGE));
+#endif
+#if defined(CONFIG_ESP_CONSOLE_UART_NUM) && UART_CMD_NUM == CONFIG_ESP_CONSOLE_UART_NUM && CONFIG_LOG_DEFAULT_LEVEL > 0
+    // 로그 텍스트가 응답 프레임 사이에 섞인다, 클라이언트는 0xA5 와 CRC 로 프레임만 골라내야 한다
+    ESP_LOGW(TAG, "command port shares the console: disable logging or set UART_CMD_NUM");
+#endif
+    ESP_ERROR_CHECK(uart_driver_install(UART_CMD_NUM, UART_RX_BUFFER_SIZE, UART_TX_BUFFER_SIZE, UART_EVENT_QUEUE_LEN,
+                                        &uart_queue, 0));
+    ESP_ERROR_CHECK(init_command_dispatch());
 
-    int len = uart_read_bytes(UART_NUM, data, 1024, 20 / portTICK_PERIOD_MS);
+#if POWER_MGMT_ENABLED && CONFIG_PM_ENABLE
+    ESP_ERROR_CHECK(uart_set_wakeup_threshold(UART_CMD_NUM, PM_UART_WAKE_THRESHOLD));
+    ESP_ERROR_CHECK(esp_sleep_enable_uart_wakeup(UART_CMD_NUM));
+#endif
 
-    if (len > 0 && data[0] == 'r') {
-        recordAudio();
-        const char* result = pipeline();
-        ESP_LOGI("AI", "result: %s", result);
+    cmd_parser_reset(&parser);
+    command_queue = xQueueCreate(UART_COMMAND_QUEUE_LEN, sizeof(uart_cmd_t));
+    if (!command_queue ||
+        xTaskCreate(uart_worker_task, "uart_worker", UART_WORKER_STACK, NULL, 5, NULL) != pdPASS ||
+        xTaskCreate(uart_event_task, "uart_event", UART_EVENT_TASK_STACK, NULL, 6, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create uart tasks");
     }
 }
@@ -0,0 +1,218 @@
+#include "wav_io.h"
+#include "adpcm.h"
+#include "esp_log.h"
+
+#include <string.h>
+
+static const char* TAG = "WAV_IO";
+
+static uint16_t read_u16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t read_u32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+esp_err_t wav_read_header(FILE* file, wav_info_t* info) {
+    uint8_t buf[24];
+    memset(info, 0, sizeof(*info));
+
+    fseek(file, 0, SEEK_SET);
+    if (fread(buf, 1, 12, file) != 12 || memcmp(buf, "RIFF", 4) != 0 || memcmp(buf + 8, "WAVE", 4) != 0) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    bool have_fmt = false;
+    while (fread(buf, 1, 8, file) == 8) {
+        uint32_t chunk_size = read_u32(buf + 4);
+        long chunk_start = ftell(file);
+
+        if (memcmp(buf, "fmt ", 4) == 0) {
+            size_t len = chunk_size < sizeof(buf) ? chunk_size : sizeof(buf);
+            if (len < 16 || fread(buf, 1, len, file) != len) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            info->format = read_u16(buf);
+            info->channels = read_u16(buf + 2);
+            info->sample_rate = read_u32(buf + 4);
+            info->block_align = read_u16(buf + 12);
+            info->bits_per_sample = read_u16(buf + 14);
+            if (len >= 20) {
+                info->samples_per_block = read_u16(buf + 18);
+            }
+            have_fmt = true;
+        } else if (memcmp(buf, "fact", 4) == 0 && chunk_size >= 4) {
+            if (fread(buf, 1, 4, file) != 4) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            info->num_samples = read_u32(buf);
+        } else if (memcmp(buf, "data", 4) == 0) {
+            if (!have_fmt) {
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            info->data_size = chunk_size;
+            info->data_offset = chunk_start;
+            if (info->format == WAV_FORMAT_PCM) {
+                info->num_samples = chunk_size / 2;
+            } else if (info->num_samples == 0 && info->block_align > 4) {
+                info->num_samples = chunk_size / info->block_align * info->samples_per_block;
+            }
+            return ESP_OK;
+        }
+
+        fseek(file, chunk_start + chunk_size + (chunk_size & 1), SEEK_SET);
+    }
+
+    return ESP_ERR_NOT_FOUND;
+}
+
+static void put_u16(FILE* file, uint16_t v) {
+    fwrite(&v, 1, 2, file);
+}
+
+static void put_u32(FILE* file, uint32_t v) {
+    fwrite(&v, 1, 4, file);
+}
+
+static void store_u16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xff;
+    p[1] = v >> 8;
+}
+
+static void store_u32(uint8_t* p, uint32_t v) {
+    store_u16(p, v & 0xffff);
+    store_u16(p + 2, v >> 16);
+}
+
+void wav_pcm_header(uint8_t* out, uint32_t data_size, uint32_t sample_rate) {
+    memcpy(out, "RIFF", 4);
+    store_u32(out + 4, data_size + 36);
+    memcpy(out + 8, "WAVEfmt ", 8);
+    store_u32(out + 16, 16);
+    store_u16(out + 20, WAV_FORMAT_PCM);
+    store_u16(out + 22, 1);
+    store_u32(out + 24, sample_rate);
+    store_u32(out + 28, sample_rate * 2);
+    store_u16(out + 32, 2);
+    store_u16(out + 34, 16);
+    memcpy(out + 36, "data", 4);
+    store_u32(out + 40, data_size);
+}
+
+esp_err_t wav_write_pcm_header(FILE* file, uint32_t data_size, uint32_t sample_rate) {
+    uint8_t header[WAV_PCM_HEADER_SIZE];
+    wav_pcm_header(header, data_size, sample_rate);
+    fseek(file, 0, SEEK_SET);
+    fwrite(header, 1, sizeof(header), file);
+    return ferror(file) ? ESP_FAIL : ESP_OK;
+}
+
+esp_err_t wav_write_adpcm_header(FILE* file, uint32_t data_size, uint32_t num_samples, uint32_t sample_rate) {
+    fseek(file, 0, SEEK_SET);
+
+    fwrite("RIFF", 1, 4, file);
+    put_u32(file, data_size + WAV_ADPCM_HEADER_SIZE - 8);
+    fwrite("WAVE", 1, 4, file);
+    fwrite("fmt ", 1, 4, file);
+    put_u32(file, 20);
+    put_u16(file, WAV_FORMAT_IMA_ADPCM);
+    put_u16(file, 1);
+    put_u32(file, sample_rate);
+    put_u32(file, (uint32_t)((uint64_t)sample_rate * ADPCM_BLOCK_ALIGN / ADPCM_SAMPLES_PER_BLOCK));
+    put_u16(file, ADPCM_BLOCK_ALIGN);
+    put_u16(file, 4);
+    put_u16(file, 2);
+    put_u16(file, ADPCM_SAMPLES_PER_BLOCK);
+    fwrite("fact", 1, 4, file);
+    put_u32(file, 4);
+    put_u32(file, num_samples);
+    fwrite("data", 1, 4, file);
+    put_u32(file, data_size);
+    return ferror(file) ? ESP_FAIL : ESP_OK;
+}
+
+esp_err_t wav_reader_open(wav_reader_t* reader, FILE* file) {
+    reader->pending_pos = 0;
+    reader->pending_len = 0;
+
+    esp_err_t ret = wav_read_header(file, &reader->info);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "No valid WAV header, reading raw PCM");
+        memset(&reader->info, 0, sizeof(reader->info));
+        reader->info.format = WAV_FORMAT_PCM;
+        reader->info.channels = 1;
+        reader->info.bits_per_sample = 16;
+        reader->info.data_offset = WAV_PCM_HEADER_SIZE;
+        reader->info.num_samples = UINT32_MAX;
+    }
+
+    const wav_info_t* info = &reader->info;
+    if (info->channels != 1) {
+        ESP_LOGE(TAG, "Unsupported channel count: %d", info->channels);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (info->format == WAV_FORMAT_PCM) {
+        if (info->bits_per_sample != 16) {
+            ESP_LOGE(TAG, "Unsupported PCM width: %d", info->bits_per_sample);
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+    } else if (info->format == WAV_FORMAT_IMA_ADPCM) {
+        if (info->block_align <= 4 || info->block_align > WAV_MAX_BLOCK_ALIGN ||
+            info->samples_per_block != (info->block_align - 4) * 2 + 1) {
+            ESP_LOGE(TAG, "Unsupported ADPCM block size: %d", info->block_align);
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+    } else {
+        ESP_LOGE(TAG, "Unsupported WAV format: 0x%x", info->format);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    reader->samples_left = info->num_samples;
+    fseek(file, info->data_offset, SEEK_SET);
+    return ESP_OK;
+}
+
+size_t wav_reader_read(wav_reader_t* reader, FILE* file, int16_t* out, size_t max_samples) {
+    if (max_samples > reader->samples_left) {
+        max_samples = reader->samples_left;
+    }
+
+    if (reader->info.format == WAV_FORMAT_PCM) {
+        size_t n = fread(out, sizeof(int16_t), max_samples, file);
+        reader->samples_left -= n;
+        return n;
+    }
+
+    size_t n = 0;
+    while (n < max_samples) {
+        if (reader->pending_pos < reader->pending_len) {
+            size_t take = reader->pending_len - reader->pending_pos;
+            if (take > max_samples - n) {
+                take = max_samples - n;
+            }
+            memcpy(out + n, reader->pending + reader->pending_pos, take * sizeof(int16_t));
+            reader->pending_pos += take;
+            n += take;
+            continue;
+        }
+
+        size_t len = fread(reader->block, 1, reader->info.block_align, file);
+        if (len < 4) {
+            break;
+        }
+        // 블록 전체가 들어가면 출력 버퍼에 바로 디코딩
+        if (max_samples - n >= (size_t)reader->info.samples_per_block) {
+            n += adpcm_decode_block(reader->block, len, out + n);
+        } else {
+            reader->pending_len = adpcm_decode_block(reader->block, len, reader->pending);
+            reader->pending_pos = 0;
+        }
+    }
+
+    if (n > max_samples) {
+        n = max_samples;
+    }
+    reader->samples_left -= n;
+    return n;
+}